@@ -0,0 +1,116 @@
+//
+//  ATLMediaInputStreamThroughputBenchmark.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import <ImageIO/ImageIO.h>
+#import <MobileCoreServices/MobileCoreServices.h>
+#import "ATLMediaInputStream.h"
+
+static NSUInteger const ATLBenchmarkImageDimension = 4096;
+static NSUInteger const ATLBenchmarkReadLength = 64 * 1024;
+static NSUInteger const ATLBenchmarkIterations = 5;
+
+/**
+ @abstract Measures how fast a large photo streams through `ATLMediaInputStream`.
+ @discussion The photo is streamed losslessly from a PNG file, so the Image I/O consumer callback hands every byte to
+   `read:maxLength:` through the transfer buffer. Each capacity is timed separately; a capacity of one read length keeps a
+   single chunk in flight, which is what the semaphore handoff used to do. To compare against the handoff itself, run
+   `testStreamingThroughput` on the commit before the ring buffer, where `transferBufferCapacity` doesn't exist and the
+   capacities are skipped.
+ */
+@interface ATLMediaInputStreamThroughputBenchmark : XCTestCase
+
+@property (nonatomic) NSURL *imageFileURL;
+@property (nonatomic) unsigned long long imageFileSize;
+
+@end
+
+@implementation ATLMediaInputStreamThroughputBenchmark
+
+- (void)setUp
+{
+    [super setUp];
+    self.imageFileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"ATLMediaInputStreamThroughputBenchmark.png"]];
+    if (![[NSFileManager defaultManager] fileExistsAtPath:self.imageFileURL.path]) {
+        [self writeNoiseImageToURL:self.imageFileURL];
+    }
+    self.imageFileSize = [[[NSFileManager defaultManager] attributesOfItemAtPath:self.imageFileURL.path error:nil] fileSize];
+}
+
+- (void)testStreamingThroughput
+{
+    NSArray *capacities = @[ @(ATLBenchmarkReadLength), @(512 * 1024), @(4 * 1024 * 1024) ];
+    if (![ATLMediaInputStream instancesRespondToSelector:@selector(setTransferBufferCapacity:)]) {
+        capacities = @[ @0 ];
+    }
+    for (NSNumber *capacity in capacities) {
+        CFTimeInterval totalDuration = 0;
+        for (NSUInteger iteration = 0; iteration < ATLBenchmarkIterations; iteration++) {
+            CFTimeInterval start = CACurrentMediaTime();
+            unsigned long long bytesRead = [self streamImageWithTransferBufferCapacity:capacity.unsignedIntegerValue];
+            totalDuration += CACurrentMediaTime() - start;
+            XCTAssertGreaterThan(bytesRead, 0ull);
+        }
+        double megabytesPerSecond = (self.imageFileSize * ATLBenchmarkIterations) / totalDuration / (1024 * 1024);
+        NSLog(@"Transfer buffer capacity %lu bytes: %.1f MB/s over %lu runs of a %llu byte PNG", (unsigned long)capacity.unsignedIntegerValue, megabytesPerSecond, (unsigned long)ATLBenchmarkIterations, self.imageFileSize);
+    }
+}
+
+#pragma mark - Helpers
+
+- (unsigned long long)streamImageWithTransferBufferCapacity:(NSUInteger)capacity
+{
+    ATLMediaInputStream *stream = [ATLMediaInputStream mediaInputStreamWithFileURL:self.imageFileURL];
+    if (capacity > 0) {
+        // Set through KVC, so the file also compiles against the commit before the property existed.
+        [stream setValue:@(capacity) forKey:@"transferBufferCapacity"];
+    }
+    [stream open];
+    uint8_t *buffer = malloc(ATLBenchmarkReadLength);
+    unsigned long long totalBytesRead = 0;
+    NSInteger bytesRead;
+    while ((bytesRead = [stream read:buffer maxLength:ATLBenchmarkReadLength]) > 0) {
+        totalBytesRead += bytesRead;
+    }
+    free(buffer);
+    XCTAssertNil(stream.streamError);
+    [stream close];
+    return totalBytesRead;
+}
+
+- (void)writeNoiseImageToURL:(NSURL *)URL
+{
+    // Noise doesn't compress, so the PNG is about as large as its pixels.
+    size_t bytesPerRow = ATLBenchmarkImageDimension * 4;
+    NSMutableData *pixels = [NSMutableData dataWithLength:bytesPerRow * ATLBenchmarkImageDimension];
+    arc4random_buf(pixels.mutableBytes, pixels.length);
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(pixels.mutableBytes, ATLBenchmarkImageDimension, ATLBenchmarkImageDimension, 8, bytesPerRow, colorSpace, (CGBitmapInfo)kCGImageAlphaNoneSkipLast);
+    CGImageRef image = CGBitmapContextCreateImage(context);
+    CGImageDestinationRef destination = CGImageDestinationCreateWithURL((__bridge CFURLRef)URL, kUTTypePNG, 1, NULL);
+    CGImageDestinationAddImage(destination, image, NULL);
+    CGImageDestinationFinalize(destination);
+    CFRelease(destination);
+    CGImageRelease(image);
+    CGContextRelease(context);
+    CGColorSpaceRelease(colorSpace);
+}
+
+@end
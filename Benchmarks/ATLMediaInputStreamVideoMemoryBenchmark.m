@@ -0,0 +1,93 @@
+//
+//  ATLMediaInputStreamVideoMemoryBenchmark.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <XCTest/XCTest.h>
+#import <mach/mach.h>
+#import "ATLMediaInputStream.h"
+
+static NSUInteger const ATLBenchmarkReadLength = 64 * 1024;
+static NSUInteger const ATLBenchmarkSampleInterval = 64;
+
+/**
+ @abstract The memory the process may gain while a video is read, whatever its size. The mapped window is 4MB, and
+   the rest leaves room for the allocator and Foundation.
+ */
+static unsigned long long const ATLBenchmarkMaximumFootprintGrowth = 16 * 1024 * 1024;
+
+/**
+ @abstract Returns the physical footprint of the process, which is what jetsam looks at, or 0 if it can't be read.
+ */
+static unsigned long long ATLBenchmarkPhysicalFootprint(void)
+{
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    kern_return_t result = task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count);
+    return result == KERN_SUCCESS ? info.phys_footprint : 0;
+}
+
+/**
+ @abstract Checks that reading an exported video from `ATLMediaInputStream` doesn't grow the memory of the process
+   with the size of the video.
+ @discussion The video is read from the path in the `ATL_BENCHMARK_VIDEO_PATH` environment variable of the test scheme.
+   Use a video of a couple hundred megabytes; the case is skipped without one. The export itself happens while the
+   stream opens, so the footprint is measured from the first read on.
+ */
+@interface ATLMediaInputStreamVideoMemoryBenchmark : XCTestCase
+
+@end
+
+@implementation ATLMediaInputStreamVideoMemoryBenchmark
+
+- (void)testReadingVideoKeepsFootprintFlat
+{
+    NSString *videoPath = [[NSProcessInfo processInfo] environment][@"ATL_BENCHMARK_VIDEO_PATH"];
+    if (!videoPath || ![[NSFileManager defaultManager] fileExistsAtPath:videoPath]) {
+        NSLog(@"Skipping, ATL_BENCHMARK_VIDEO_PATH doesn't point to a video");
+        return;
+    }
+
+    ATLMediaInputStream *stream = [ATLMediaInputStream mediaInputStreamWithFileURL:[NSURL fileURLWithPath:videoPath]];
+    [stream open];
+    uint8_t *buffer = malloc(ATLBenchmarkReadLength);
+    NSInteger bytesRead = [stream read:buffer maxLength:ATLBenchmarkReadLength];
+    XCTAssertGreaterThan(bytesRead, 0);
+
+    unsigned long long initialFootprint = ATLBenchmarkPhysicalFootprint();
+    unsigned long long peakFootprint = initialFootprint;
+    unsigned long long totalBytesRead = MAX(bytesRead, 0);
+    NSUInteger numberOfReads = 0;
+    while ((bytesRead = [stream read:buffer maxLength:ATLBenchmarkReadLength]) > 0) {
+        totalBytesRead += bytesRead;
+        if (++numberOfReads % ATLBenchmarkSampleInterval == 0) {
+            peakFootprint = MAX(peakFootprint, ATLBenchmarkPhysicalFootprint());
+        }
+    }
+    peakFootprint = MAX(peakFootprint, ATLBenchmarkPhysicalFootprint());
+    free(buffer);
+    XCTAssertNil(stream.streamError);
+    [stream close];
+
+    unsigned long long growth = peakFootprint - initialFootprint;
+    NSLog(@"Read %llu bytes of exported video, footprint grew by %llu bytes", totalBytesRead, growth);
+    XCTAssertGreaterThan(initialFootprint, 0ull, @"The footprint couldn't be read");
+    XCTAssertLessThan(growth, ATLBenchmarkMaximumFootprintGrowth);
+}
+
+@end
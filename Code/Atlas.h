@@ -42,7 +42,9 @@
 ///-------------
 
 #import "ATLConversationDataSource.h"
+#import "ATLConversationSectionMetadata.h"
 #import "ATLDataSourceChange.h"
+#import "ATLDataSourceChangeSet.h"
 #import "ATLMediaAttachment.h"
 #import "ATLParticipantTableDataSet.h"
 #import "ATLMediaAttachment.h"
@@ -66,6 +68,11 @@
 #import "ATLMessagingUtilities.h"
 #import "ATLLocationManager.h"
 #import "ATLMediaInputStream.h"
+#import "ATLImageCache.h"
+#import "ATLImagePipeline.h"
+#import "ATLAnimatedImage.h"
+#import "ATLMessageLayoutCache.h"
+#import "ATLMessageSearchIndex.h"
 
 ///------------
 /// @name Views
@@ -73,10 +80,12 @@
 
 #import "ATLAddressBarContainerView.h"
 #import "ATLAddressBarView.h"
+#import "ATLAnimatedImageView.h"
 #import "ATLAvatarImageView.h"
 #import "ATLConversationCollectionView.h"
 #import "ATLConversationCollectionViewFooter.h"
 #import "ATLConversationCollectionViewHeader.h"
+#import "ATLConversationCollectionViewLayout.h"
 #import "ATLConversationCollectionViewMoreMessagesHeader.h"
 #import "ATLConversationTableViewCell.h"
 #import "ATLConversationView.h"
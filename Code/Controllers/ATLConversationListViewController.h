@@ -23,6 +23,7 @@
 #import "ATLConversationTableViewCell.h"
 #import "ATLAvatarItem.h"
 #import "ATLParticipant.h"
+#import "ATLMessageSearchIndex.h"
 
 @class ATLConversationListViewController;
 
@@ -67,6 +68,15 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)conversationListViewController:(ATLConversationListViewController *)conversationListViewController didSearchForText:(NSString *)searchText completion:(void (^)(NSSet <id<ATLParticipant>>*filteredParticipants))completion;
 
+/**
+ @abstract Informs the delegate that a page of conversations was loaded.
+ @param conversationListViewController The `ATLConversationListViewController` that loaded the conversations.
+ @param numberOfLoadedConversations The number of conversations loaded so far.
+ @param totalNumberOfConversations The number of conversations the query matches.
+ @discussion Only called when `conversationPageSize` is set.
+ */
+- (void)conversationListViewController:(ATLConversationListViewController *)conversationListViewController didLoadNumberOfConversations:(NSUInteger)numberOfLoadedConversations totalNumberOfConversations:(NSUInteger)totalNumberOfConversations;
+
 @end
 
 ///---------------------------------------
@@ -253,6 +263,29 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, assign) CGFloat rowHeight;
 
+///-----------------
+/// @name Pagination
+///-----------------
+
+/**
+ @abstract The number of conversations loaded at once.
+ @discussion When set, only the most recent page of conversations is loaded when the list opens, and the next page
+ is loaded as the user scrolls towards the bottom of the list, so opening a very large inbox doesn't load every conversation.
+ @default `0`, meaning all conversations are loaded at once.
+ @raises NSInternalInconsistencyException Raised if the value is mutated after the receiver has been presented.
+ */
+@property (nonatomic, assign) NSUInteger conversationPageSize;
+
+/**
+ @abstract The number of conversations currently loaded.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfLoadedConversations;
+
+/**
+ @abstract The number of conversations the query matches, whether or not they are loaded.
+ */
+@property (nonatomic, readonly) NSUInteger totalNumberOfConversations;
+
 ///-------------
 /// @name Search
 ///-------------
@@ -273,6 +306,26 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, assign) BOOL shouldDisplaySearchController;
 
+/**
+ @abstract An on-device index searched for the text of messages.
+ @discussion When set, the last messages of the conversations loaded by the controller are added to the index as
+ they change, the messages of deleted conversations are removed from it, and the search bar lists the conversations
+ with messages matching the search text instead of asking the delegate to filter participants. Share the index with
+ `ATLConversationViewController` to index every message displayed, not only the last ones.
+ @default `nil`.
+ */
+@property (nonatomic, nullable) ATLMessageSearchIndex *messageSearchIndex;
+
+/**
+ @abstract Returns the search result listing the matching messages of a conversation displayed in the search results.
+ @discussion The conversations found in the `messageSearchIndex` are listed best match first. When one is selected, pass
+ the message with the first of its `messageIdentifiers` to `setConversation:anchoredAtMessage:` of
+ `ATLConversationViewController` to open the conversation at the match.
+ @param conversation A conversation displayed in the search results.
+ @return The search result of the conversation, or `nil` if the search results don't come from the `messageSearchIndex`.
+ */
+- (nullable ATLMessageSearchResult *)messageSearchResultForConversation:(LYRConversation *)conversation;
+
 ///------------------------------
 /// @name Reloading Conversations
 ///------------------------------
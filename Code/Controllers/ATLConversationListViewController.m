@@ -22,20 +22,47 @@
 #import "ATLConversationListViewController.h"
 #import "ATLMessagingUtilities.h"
 
+static NSUInteger const ATLConversationListViewControllerSearchResultLimit = 100;
+
 static NSString *const ATLConversationCellReuseIdentifier = @"ATLConversationCellReuseIdentifier";
 static NSString *const ATLImageMIMETypePlaceholderText = @"Attachment: Image";
 static NSString *const ATLVideoMIMETypePlaceholderText = @"Attachment: Video";
 static NSString *const ATLLocationMIMETypePlaceholderText = @"Attachment: Location";
 static NSString *const ATLGIFMIMETypePlaceholderText = @"Attachment: GIF";
+static char const ATLConversationListPreviewQueueName[] = "com.layer.Atlas.ATLConversationListViewController.previewQueue";
+static NSUInteger const ATLConversationListRowViewModelCountLimit = 1000;
+static NSUInteger const ATLConversationListPreviewPrefetchCount = 50;
+
+/**
+ @abstract The labels of a conversation row, built once and kept until the conversation changes.
+ */
+@interface ATLConversationRowViewModel : NSObject
+
+@property (nonatomic) NSURL *lastMessageIdentifier;
+@property (nonatomic, copy) NSString *title;
+@property (nonatomic) id<ATLAvatarItem> avatarItem;
+@property (nonatomic, copy) NSString *lastMessageText;
+
+@end
+
+@implementation ATLConversationRowViewModel
+
+@end
 
 @interface ATLConversationListViewController () <UIActionSheetDelegate, LYRQueryControllerDelegate, UISearchBarDelegate, UISearchControllerDelegate, UISearchDisplayDelegate>
 
 @property (nonatomic) LYRQueryController *queryController;
 @property (nonatomic) LYRQueryController *searchQueryController;
+@property (nonatomic) NSArray <LYRConversation *> *messageSearchResultConversations;
+@property (nonatomic) NSDictionary <NSURL *, ATLMessageSearchResult *> *messageSearchResultsByConversationIdentifier;
 @property (nonatomic) LYRConversation *conversationToDelete;
 @property (nonatomic) LYRConversation *conversationSelectedBeforeContentChange;
 @property (nonatomic) UISearchBar *searchBar;
 @property (nonatomic) BOOL hasAppeared;
+@property (nonatomic) NSCache <NSURL *, ATLConversationRowViewModel *> *rowViewModels;
+@property (nonatomic) NSCache <NSURL *, NSString *> *lastMessageTexts;
+@property (nonatomic) dispatch_queue_t previewQueue;
+@property (nonatomic) NSUInteger numberOfPreparedRows;
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -87,6 +114,11 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
     _rowHeight = 76.0f;
     _shouldDisplaySearchController = YES;
     _hasAppeared = NO;
+    _rowViewModels = [NSCache new];
+    _rowViewModels.countLimit = ATLConversationListRowViewModelCountLimit;
+    _lastMessageTexts = [NSCache new];
+    _lastMessageTexts.countLimit = ATLConversationListRowViewModelCountLimit;
+    _previewQueue = dispatch_queue_create(ATLConversationListPreviewQueueName, DISPATCH_QUEUE_SERIAL);
 }
 
 - (id)init
@@ -103,6 +135,13 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
     _layerClient = layerClient;
 }
 
+- (void)setDataSource:(id<ATLConversationListViewControllerDataSource>)dataSource
+{
+    _dataSource = dataSource;
+    // The cached titles, avatars and previews were provided by the previous data source.
+    [self.rowViewModels removeAllObjects];
+}
+
 #pragma mark - Lifecycle
 
 - (void)viewDidLoad
@@ -214,6 +253,14 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
     _rowHeight = rowHeight;
 }
 
+- (void)setConversationPageSize:(NSUInteger)conversationPageSize
+{
+    if (self.hasAppeared) {
+        @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:@"Cannot change conversation page size after the view has been presented" userInfo:nil];
+    }
+    _conversationPageSize = conversationPageSize;
+}
+
 #pragma mark - Set Up
 
 - (void)addEditButton
@@ -249,6 +296,10 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
         return;
     }
     self.queryController.delegate = self;
+    if (self.conversationPageSize > 0) {
+        // The query is sorted newest first, so a positive window holds the most recent conversations.
+        self.queryController.paginationWindow = self.conversationPageSize;
+    }
     // We need to tell tableView to refresh data before executing the new query
     // controller. That because the new query controller starts with a
     // different number of row/sections than the previous one that
@@ -259,20 +310,58 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
         NSLog(@"LayerKit failed to execute query with error: %@", error);
         return;
     }
+    self.numberOfPreparedRows = 0;
+    [self prepareRowsUpToRow:ATLConversationListPreviewPrefetchCount];
     [self.tableView reloadData];
+    [self notifyDelegateOfLoadedConversations];
+}
+
+#pragma mark - Pagination
+
+- (NSUInteger)numberOfLoadedConversations
+{
+    return [_queryController numberOfObjectsInSection:0];
+}
+
+- (NSUInteger)totalNumberOfConversations
+{
+    return _queryController.totalNumberOfObjects;
+}
+
+- (void)loadNextPageOfConversationsIfNeeded
+{
+    if (self.conversationPageSize == 0 || !_queryController || self.searchController.isActive) return;
+    NSUInteger numberOfLoadedConversations = self.numberOfLoadedConversations;
+    if (numberOfLoadedConversations >= self.totalNumberOfConversations) return;
+    // Load the next page once the last loaded row is within half a page of the screen.
+    NSIndexPath *lastVisibleIndexPath = [self.tableView indexPathsForVisibleRows].lastObject;
+    if (!lastVisibleIndexPath || lastVisibleIndexPath.row + self.conversationPageSize / 2 < numberOfLoadedConversations) return;
+    
+    // The added conversations arrive as insertions through the query controller delegate.
+    _queryController.paginationWindow += self.conversationPageSize;
+    [self notifyDelegateOfLoadedConversations];
+}
+
+- (void)notifyDelegateOfLoadedConversations
+{
+    if (self.conversationPageSize == 0) return;
+    if ([self.delegate respondsToSelector:@selector(conversationListViewController:didLoadNumberOfConversations:totalNumberOfConversations:)]) {
+        [self.delegate conversationListViewController:self didLoadNumberOfConversations:self.numberOfLoadedConversations totalNumberOfConversations:self.totalNumberOfConversations];
+    }
 }
 
 #pragma mark - UITableViewDataSource
 
 - (NSInteger)tableView:(UITableView *)tableView numberOfRowsInSection:(NSInteger)section
 {
+    if (self.searchController.isActive && self.messageSearchResultConversations) {
+        return self.messageSearchResultConversations.count;
+    }
     return [self.queryController numberOfObjectsInSection:section];
 }
 
 - (UITableViewCell *)tableView:(UITableView *)tableView cellForRowAtIndexPath:(NSIndexPath *)indexPath
 {
-    NSLog(@"%d", indexPath.row);
-    
     NSString *reuseIdentifier = [self reuseIdentifierForConversation:nil atIndexPath:indexPath];
     
     UITableViewCell<ATLConversationPresenting> *conversationCell = [tableView dequeueReusableCellWithIdentifier:reuseIdentifier forIndexPath:indexPath];
@@ -289,21 +378,37 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
 
 - (void)configureCell:(UITableViewCell<ATLConversationPresenting> *)conversationCell atIndexPath:(NSIndexPath *)indexPath
 {
-    LYRConversation *conversation = [self.queryController objectAtIndexPath:indexPath];
+    LYRConversation *conversation = [self conversationAtIndexPath:indexPath];
     [conversationCell presentConversation:conversation];
     
+    ATLConversationRowViewModel *viewModel = [self rowViewModelForConversation:conversation];
+    if (self.displaysAvatarItem) {
+        [conversationCell updateWithAvatarItem:viewModel.avatarItem];
+    }
+    [conversationCell updateWithConversationTitle:viewModel.title];
+    [conversationCell updateWithLastMessageText:viewModel.lastMessageText];
+}
+
+- (ATLConversationRowViewModel *)rowViewModelForConversation:(LYRConversation *)conversation
+{
+    NSURL *lastMessageIdentifier = conversation.lastMessage.identifier;
+    ATLConversationRowViewModel *viewModel = [self.rowViewModels objectForKey:conversation.identifier];
+    if (viewModel && (viewModel.lastMessageIdentifier == lastMessageIdentifier || [viewModel.lastMessageIdentifier isEqual:lastMessageIdentifier])) {
+        return viewModel;
+    }
+    
+    viewModel = [ATLConversationRowViewModel new];
+    viewModel.lastMessageIdentifier = lastMessageIdentifier;
     if (self.displaysAvatarItem) {
         if ([self.dataSource respondsToSelector:@selector(conversationListViewController:avatarItemForConversation:)]) {
-            id<ATLAvatarItem> avatarItem = [self.dataSource conversationListViewController:self avatarItemForConversation:conversation];
-            [conversationCell updateWithAvatarItem:avatarItem];
+            viewModel.avatarItem = [self.dataSource conversationListViewController:self avatarItemForConversation:conversation];
         } else {
            @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:@"Conversation View Delegate must return an object conforming to the `ATLAvatarItem` protocol." userInfo:nil];
         }
     }
     
     if ([self.dataSource respondsToSelector:@selector(conversationListViewController:titleForConversation:)]) {
-        NSString *conversationTitle = [self.dataSource conversationListViewController:self titleForConversation:conversation];
-        [conversationCell updateWithConversationTitle:conversationTitle];
+        viewModel.title = [self.dataSource conversationListViewController:self titleForConversation:conversation];
     } else {
         @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:@"Conversation View Delegate must return a conversation label" userInfo:nil];
     }
@@ -315,7 +420,52 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
     if (!lastMessageText) {
         lastMessageText = [self defaultLastMessageTextForConversation:conversation];
     }
-    [conversationCell updateWithLastMessageText:lastMessageText];
+    viewModel.lastMessageText = lastMessageText;
+    
+    if (conversation.identifier) {
+        [self.rowViewModels setObject:viewModel forKey:conversation.identifier];
+    }
+    return viewModel;
+}
+
+#pragma mark - Preparing Rows
+
+- (void)prepareRowsUpToRow:(NSUInteger)row
+{
+    NSUInteger numberOfRows = [_queryController numberOfObjectsInSection:0];
+    NSUInteger endRow = MIN(row, numberOfRows);
+    if (endRow <= self.numberOfPreparedRows) return;
+    NSMutableArray *conversations = [NSMutableArray arrayWithCapacity:endRow - self.numberOfPreparedRows];
+    for (NSUInteger preparedRow = self.numberOfPreparedRows; preparedRow < endRow; preparedRow++) {
+        LYRConversation *conversation = [_queryController objectAtIndexPath:[NSIndexPath indexPathForRow:preparedRow inSection:0]];
+        if (conversation) [conversations addObject:conversation];
+    }
+    self.numberOfPreparedRows = endRow;
+    [self prepareLastMessageTextsForConversations:conversations];
+}
+
+- (void)prepareLastMessageTextsForConversations:(NSArray <LYRConversation *> *)conversations
+{
+    NSMutableArray *lastMessages = [NSMutableArray arrayWithCapacity:conversations.count];
+    for (LYRConversation *conversation in conversations) {
+        LYRMessage *lastMessage = conversation.lastMessage;
+        if (lastMessage.identifier && ![self.lastMessageTexts objectForKey:lastMessage.identifier]) {
+            [lastMessages addObject:lastMessage];
+        }
+    }
+    if (lastMessages.count == 0) return;
+    [self.messageSearchIndex indexMessages:lastMessages];
+    
+    // Decoding text previews reads message part data, which is kept off the main thread.
+    NSCache *lastMessageTexts = self.lastMessageTexts;
+    dispatch_async(self.previewQueue, ^{
+        for (LYRMessage *lastMessage in lastMessages) {
+            NSString *lastMessageText = [[self class] defaultLastMessageTextForMessage:lastMessage];
+            if (lastMessageText) {
+                [lastMessageTexts setObject:lastMessageText forKey:lastMessage.identifier];
+            }
+        }
+    });
 }
 
 #pragma mark - Reloading Conversations
@@ -325,10 +475,11 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
     if (!conversation) {
         @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"`conversation` cannot be nil." userInfo:nil];
     }
-    if (!self.queryController) {
+    if (!self.queryController && !self.messageSearchResultConversations) {
         return;
     }
-    NSIndexPath *indexPath = [self.queryController indexPathForObject:conversation];
+    [self.rowViewModels removeObjectForKey:conversation.identifier];
+    NSIndexPath *indexPath = [self indexPathForConversation:conversation];
     if (indexPath) {
         [self.tableView reloadRowsAtIndexPaths:@[ indexPath ] withRowAnimation:UITableViewRowAnimationAutomatic];
     }
@@ -391,7 +542,7 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
 
 - (void)tableView:(UITableView *)tableView commitEditingStyle:(UITableViewCellEditingStyle)editingStyle forRowAtIndexPath:(NSIndexPath *)indexPath
 {
-    self.conversationToDelete = [self.queryController objectAtIndexPath:indexPath];
+    self.conversationToDelete = [self conversationAtIndexPath:indexPath];
     UIActionSheet *actionSheet = [[UIActionSheet alloc] initWithTitle:nil delegate:self cancelButtonTitle:@"Cancel" destructiveButtonTitle:ATLConversationListViewControllerDeletionModeEveryone otherButtonTitles:ATLConversationListViewControllerDeletionModeMyDevices, nil];
     [actionSheet showInView:self.view];
 }
@@ -399,11 +550,25 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
 - (void)tableView:(UITableView *)tableView didSelectRowAtIndexPath:(NSIndexPath *)indexPath
 {
     if ([self.delegate respondsToSelector:@selector(conversationListViewController:didSelectConversation:)]){
-        LYRConversation *conversation = [self.queryController objectAtIndexPath:indexPath];
+        LYRConversation *conversation = [self conversationAtIndexPath:indexPath];
         [self.delegate conversationListViewController:self didSelectConversation:conversation];
     }
 }
 
+#pragma mark - UIScrollViewDelegate
+
+- (void)scrollViewDidScroll:(UIScrollView *)scrollView
+{
+    if (scrollView != self.tableView) return;
+    [self loadNextPageOfConversationsIfNeeded];
+    
+    // Keep the previews of the next couple of screens decoded ahead of the scroll position.
+    NSIndexPath *lastVisibleIndexPath = [self.tableView indexPathsForVisibleRows].lastObject;
+    if (lastVisibleIndexPath.row + ATLConversationListPreviewPrefetchCount / 2 >= self.numberOfPreparedRows) {
+        [self prepareRowsUpToRow:lastVisibleIndexPath.row + ATLConversationListPreviewPrefetchCount];
+    }
+}
+
 #pragma mark - UIActionSheetDelegate
 
 - (void)actionSheet:(UIActionSheet *)actionSheet clickedButtonAtIndex:(NSInteger)buttonIndex
@@ -451,6 +616,17 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
           forChangeType:(LYRQueryControllerChangeType)type
            newIndexPath:(NSIndexPath *)newIndexPath
 {
+    // Only the conversations named in the changes have their rows rebuilt.
+    if (type == LYRQueryControllerChangeTypeUpdate || type == LYRQueryControllerChangeTypeDelete) {
+        [self.rowViewModels removeObjectForKey:[object identifier]];
+    }
+    if (type == LYRQueryControllerChangeTypeInsert || type == LYRQueryControllerChangeTypeUpdate) {
+        [self prepareLastMessageTextsForConversations:@[ object ]];
+    }
+    // Conversations also leave the query controller by sliding out of the pagination window, but only deleted ones leave the index.
+    if (type == LYRQueryControllerChangeTypeDelete && controller == _queryController && [object isDeleted]) {
+        [self.messageSearchIndex removeMessagesInConversationWithIdentifier:[object identifier]];
+    }
     switch (type) {
         case LYRQueryControllerChangeTypeInsert:
             [self.tableView insertRowsAtIndexPaths:@[newIndexPath]
@@ -500,7 +676,12 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
 
 - (BOOL)searchDisplayController:(UISearchDisplayController *)controller shouldReloadTableForSearchString:(NSString *)searchString
 {
-    if ([self.delegate respondsToSelector:@selector(conversationListViewController:didSearchForText:completion:)]) {
+    if (self.messageSearchIndex) {
+        [self.messageSearchIndex searchForText:searchString limit:ATLConversationListViewControllerSearchResultLimit completion:^(NSArray<ATLMessageSearchResult *> *results) {
+            if (![searchString isEqualToString:controller.searchBar.text]) return;
+            [self updateSearchResultsWithMessageSearchResults:results];
+        }];
+    } else if ([self.delegate respondsToSelector:@selector(conversationListViewController:didSearchForText:completion:)]) {
         [self.delegate conversationListViewController:self didSearchForText:searchString completion:^(NSSet *filteredParticipants) {
             if (![searchString isEqualToString:controller.searchBar.text]) return;
             NSSet *participantIdentifiers = [filteredParticipants valueForKey:@"userID"];
@@ -508,21 +689,58 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
             LYRQuery *query = [LYRQuery queryWithQueryableClass:[LYRConversation class]];
             query.predicate = [LYRPredicate predicateWithProperty:@"participants" predicateOperator:LYRPredicateOperatorIsIn value:participantIdentifiers];
             query.sortDescriptors = @[[NSSortDescriptor sortDescriptorWithKey:@"lastMessage.receivedAt" ascending:NO]];
-            
-            NSError *error;
-            self.searchQueryController = [self.layerClient queryControllerWithQuery:query error:&error];
-            if (!self.queryController) {
-                NSLog(@"LayerKit failed to create a query controller with error: %@", error);
-                return;
-            }
-
-            [self.searchQueryController execute:&error];
-            [self.searchController.searchResultsTableView reloadData];
+            [self updateSearchQueryControllerWithQuery:query];
         }];
     }
     return NO;
 }
 
+- (void)updateSearchResultsWithMessageSearchResults:(NSArray<ATLMessageSearchResult *> *)results
+{
+    NSArray *conversationIdentifiers = [results valueForKey:@"conversationIdentifier"];
+    LYRQuery *query = [LYRQuery queryWithQueryableClass:[LYRConversation class]];
+    query.predicate = [LYRPredicate predicateWithProperty:@"identifier" predicateOperator:LYRPredicateOperatorIsIn value:[NSSet setWithArray:conversationIdentifiers]];
+    NSError *error;
+    NSOrderedSet *conversations = [self.layerClient executeQuery:query error:&error];
+    if (!conversations) {
+        NSLog(@"LayerKit failed to execute query with error: %@", error);
+        return;
+    }
+    
+    // The rows follow the ranking of the index, best match first, rather than the recency of the conversations.
+    NSMutableDictionary *conversationsByIdentifier = [NSMutableDictionary dictionaryWithCapacity:conversations.count];
+    for (LYRConversation *conversation in conversations) {
+        conversationsByIdentifier[conversation.identifier] = conversation;
+    }
+    NSMutableArray *orderedConversations = [NSMutableArray arrayWithCapacity:results.count];
+    NSMutableDictionary *resultsByConversationIdentifier = [NSMutableDictionary dictionaryWithCapacity:results.count];
+    for (ATLMessageSearchResult *result in results) {
+        LYRConversation *conversation = conversationsByIdentifier[result.conversationIdentifier];
+        if (!conversation) continue;
+        [orderedConversations addObject:conversation];
+        resultsByConversationIdentifier[result.conversationIdentifier] = result;
+    }
+    self.searchQueryController = nil;
+    self.messageSearchResultConversations = orderedConversations;
+    self.messageSearchResultsByConversationIdentifier = resultsByConversationIdentifier;
+    [self.searchController.searchResultsTableView reloadData];
+}
+
+- (void)updateSearchQueryControllerWithQuery:(LYRQuery *)query
+{
+    self.messageSearchResultConversations = nil;
+    self.messageSearchResultsByConversationIdentifier = nil;
+    NSError *error;
+    self.searchQueryController = [self.layerClient queryControllerWithQuery:query error:&error];
+    if (!self.searchQueryController) {
+        NSLog(@"LayerKit failed to create a query controller with error: %@", error);
+        return;
+    }
+    
+    [self.searchQueryController execute:&error];
+    [self.searchController.searchResultsTableView reloadData];
+}
+
 #pragma GCC diagnostic pop
 
 - (LYRQueryController *)queryController
@@ -534,34 +752,69 @@ NSString *const ATLConversationListViewControllerDeletionModeEveryone = @"Everyo
     }
 }
 
+- (ATLMessageSearchResult *)messageSearchResultForConversation:(LYRConversation *)conversation
+{
+    if (!conversation.identifier) return nil;
+    return self.messageSearchResultsByConversationIdentifier[conversation.identifier];
+}
+
 #pragma mark - Helpers
 
+- (LYRConversation *)conversationAtIndexPath:(NSIndexPath *)indexPath
+{
+    if (self.searchController.isActive && self.messageSearchResultConversations) {
+        return indexPath.row < (NSInteger)self.messageSearchResultConversations.count ? self.messageSearchResultConversations[indexPath.row] : nil;
+    }
+    return [self.queryController objectAtIndexPath:indexPath];
+}
+
+- (NSIndexPath *)indexPathForConversation:(LYRConversation *)conversation
+{
+    if (self.searchController.isActive && self.messageSearchResultConversations) {
+        NSUInteger row = [self.messageSearchResultConversations indexOfObject:conversation];
+        return row == NSNotFound ? nil : [NSIndexPath indexPathForRow:row inSection:0];
+    }
+    return [self.queryController indexPathForObject:conversation];
+}
+
 - (NSString *)defaultLastMessageTextForConversation:(LYRConversation *)conversation
 {
-    NSString *lastMessageText;
     LYRMessage *lastMessage = conversation.lastMessage;
-    LYRMessagePart *messagePart = lastMessage.parts[0];
-        if ([messagePart.MIMEType isEqualToString:ATLMIMETypeTextPlain]) {
-            lastMessageText = [[NSString alloc] initWithData:messagePart.data encoding:NSUTF8StringEncoding];
-        } else if ([messagePart.MIMEType isEqualToString:ATLMIMETypeImageJPEG]) {
-            lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.text.key", ATLImageMIMETypePlaceholderText, nil);
-        } else if ([messagePart.MIMEType isEqualToString:ATLMIMETypeImagePNG]) {
-            lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.png.key", ATLImageMIMETypePlaceholderText, nil);
-        } else if ([messagePart.MIMEType isEqualToString:ATLMIMETypeImageGIF]) {
-            lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.gif.key", ATLGIFMIMETypePlaceholderText, nil);
-        } else if ([messagePart.MIMEType isEqualToString:ATLMIMETypeLocation]) {
-            lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.location.key", ATLLocationMIMETypePlaceholderText, nil);
-        } else if ([messagePart.MIMEType isEqualToString:ATLMIMETypeVideoMP4]) {
-            lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.video.key", ATLVideoMIMETypePlaceholderText, nil);
-        } else {
-            lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.default.key", ATLImageMIMETypePlaceholderText, nil);
+    NSString *lastMessageText = lastMessage.identifier ? [self.lastMessageTexts objectForKey:lastMessage.identifier] : nil;
+    if (!lastMessageText) {
+        lastMessageText = [[self class] defaultLastMessageTextForMessage:lastMessage];
+        if (lastMessageText && lastMessage.identifier) {
+            [self.lastMessageTexts setObject:lastMessageText forKey:lastMessage.identifier];
         }
+    }
+    return lastMessageText;
+}
+
++ (NSString *)defaultLastMessageTextForMessage:(LYRMessage *)lastMessage
+{
+    NSString *lastMessageText;
+    LYRMessagePart *messagePart = lastMessage.parts.firstObject;
+    if ([messagePart.MIMEType isEqualToString:ATLMIMETypeTextPlain]) {
+        lastMessageText = [[NSString alloc] initWithData:messagePart.data encoding:NSUTF8StringEncoding];
+    } else if ([messagePart.MIMEType isEqualToString:ATLMIMETypeImageJPEG]) {
+        lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.text.key", ATLImageMIMETypePlaceholderText, nil);
+    } else if ([messagePart.MIMEType isEqualToString:ATLMIMETypeImagePNG]) {
+        lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.png.key", ATLImageMIMETypePlaceholderText, nil);
+    } else if ([messagePart.MIMEType isEqualToString:ATLMIMETypeImageGIF]) {
+        lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.gif.key", ATLGIFMIMETypePlaceholderText, nil);
+    } else if ([messagePart.MIMEType isEqualToString:ATLMIMETypeLocation]) {
+        lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.location.key", ATLLocationMIMETypePlaceholderText, nil);
+    } else if ([messagePart.MIMEType isEqualToString:ATLMIMETypeVideoMP4]) {
+        lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.video.key", ATLVideoMIMETypePlaceholderText, nil);
+    } else {
+        lastMessageText = ATLLocalizedString(@"atl.conversationlist.lastMessage.text.default.key", ATLImageMIMETypePlaceholderText, nil);
+    }
     return lastMessageText;
 }
 
 - (void)deleteConversationAtIndexPath:(NSIndexPath *)indexPath withDeletionMode:(LYRDeletionMode)deletionMode
 {
-    LYRConversation *conversation = [self.queryController objectAtIndexPath:indexPath];
+    LYRConversation *conversation = [self conversationAtIndexPath:indexPath];
     [self deleteConversation:conversation withDeletionMode:deletionMode];
 }
 
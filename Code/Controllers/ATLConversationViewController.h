@@ -23,6 +23,7 @@
 #import <MapKit/MapKit.h>
 #import "ATLParticipant.h"
 #import "ATLBaseConversationViewController.h"
+#import "ATLMessageSearchIndex.h"
 
 typedef NS_ENUM(NSUInteger, ATLAvatarItemDisplayFrequency) {
     ATLAvatarItemDisplayFrequencySection,
@@ -99,6 +100,15 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSOrderedSet <LYRMessage*> *)conversationViewController:(ATLConversationViewController *)viewController messagesForMediaAttachments:(NSArray <ATLMediaAttachment*> *)mediaAttachments;
 
+/**
+ @abstract Informs the delegate that the messages of a conversation were loaded and displayed.
+ @param viewController The `ATLConversationViewController` that loaded the messages.
+ @param conversation The conversation whose messages were loaded.
+ @param latency The time in seconds from the conversation being set to its messages being displayed.
+ @discussion Useful for tracking how long conversations take to open.
+ */
+- (void)conversationViewController:(ATLConversationViewController *)viewController didLoadMessagesInConversation:(LYRConversation *)conversation latency:(NSTimeInterval)latency;
+
 @end
 
 ///---------------------------------------
@@ -214,6 +224,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic) LYRConversation *conversation;
 
+/**
+ @abstract Displays a conversation scrolled to one of its messages rather than to the bottom.
+ @discussion Use to open a conversation at its first unread message or at a search result. Only a page of messages on each
+ side of the anchor is loaded, however far back it is; the rest are loaded as the user scrolls in either direction.
+ Sending a message moves back to the newest messages.
+ @param conversation The conversation to display.
+ @param message The message to center on screen. Pass `nil` to scroll to the bottom, as when setting `conversation`.
+ */
+- (void)setConversation:(nullable LYRConversation *)conversation anchoredAtMessage:(nullable LYRMessage *)message;
+
 /**
  @abstract The `LYRQueryController` object managing data displayed in the controller.
  */
@@ -244,7 +264,8 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  @abstract Reloads the cells for all messages sent by the participant with the given identifier.
- @discussion This method is useful after the completion of asynchronous user resolution activities.
+ @discussion This method is useful after the completion of asynchronous user resolution activities. Only the messages
+ on screen are reconfigured; the others pick up the change when they are displayed. May be called from any thread.
  @param participantIdentifier The identifier of the participant whose messages are to be reloaded.
  */
 - (void)reloadCellsForMessagesSentByParticipantWithIdentifier:(NSString *)participantIdentifier;
@@ -298,5 +319,29 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic) ATLAvatarItemDisplayFrequency avatarItemDisplayFrequency;
 
+/**
+ @abstract The maximum number of messages kept loaded while scrolling through the conversation history.
+ @discussion Once the user scrolls further, the messages furthest from the screen are dropped, and loaded again when the
+ user scrolls back towards them. This keeps memory use flat in very long conversations.
+ @default `0`, meaning messages are never dropped.
+ Should be set before the conversation is set.
+ */
+@property (nonatomic) NSUInteger maximumNumberOfLoadedMessages;
+
+/**
+ @abstract A Boolean value that determines whether messages are loaded off the main thread when a conversation is set.
+ @discussion If `YES`, the controller shows an activity indicator until the messages are loaded, then displays them all at
+ once. Avoids blocking the main thread when opening large conversations.
+ @default `NO`.
+ */
+@property (nonatomic) BOOL loadsMessagesAsynchronously;
+
+/**
+ @abstract An on-device index the messages loaded by the controller are added to, so they can be searched for later.
+ @discussion Deleted messages are removed from it. Usually shared with the `ATLConversationListViewController` searching it.
+ @default `nil`.
+ */
+@property (nonatomic, nullable) ATLMessageSearchIndex *messageSearchIndex;
+
 @end
 NS_ASSUME_NONNULL_END
@@ -23,26 +23,33 @@
 #import <MediaPlayer/MediaPlayer.h>
 #import "ATLConversationViewController.h"
 #import "ATLConversationCollectionView.h"
+#import "ATLConversationCollectionViewLayout.h"
 #import "ATLConstants.h"
 #import "ATLDataSourceChange.h"
+#import "ATLDataSourceChangeSet.h"
+#import "ATLConversationSectionMetadata.h"
 #import "ATLMessagingUtilities.h"
 #import "ATLConversationView.h"
 #import "ATLConversationDataSource.h"
 #import "ATLMediaAttachment.h"
 #import "ATLLocationManager.h"
 #import "LYRIdentity+ATLParticipant.h"
+#import "ATLMessageLayoutCache.h"
+#import "ATLMessageLabelCache.h"
+#import "ATLImageCache.h"
 
 @import AVFoundation;
 
-@interface ATLConversationViewController () <UICollectionViewDataSource, UICollectionViewDelegate, CLLocationManagerDelegate>
+@interface ATLConversationViewController () <UICollectionViewDataSource, UICollectionViewDelegate, CLLocationManagerDelegate, ATLConversationDataSourceDelegate>
 
 @property (nonatomic) ATLConversationDataSource *conversationDataSource;
 @property (nonatomic, readwrite) LYRQueryController *queryController;
 @property (nonatomic) BOOL shouldDisplayAvatarItem;
 @property (nonatomic) NSMutableOrderedSet *typingParticipantIDs;
 @property (nonatomic) NSMutableArray *objectChanges;
-@property (nonatomic) NSHashTable *sectionHeaders;
-@property (nonatomic) NSHashTable *sectionFooters;
+@property (nonatomic) NSMutableArray *changedMessages;
+@property (nonatomic) NSMapTable <NSURL *, ATLConversationCollectionViewHeader *> *sectionHeadersByMessageIdentifier;
+@property (nonatomic) NSMapTable <NSURL *, ATLConversationCollectionViewFooter *> *sectionFootersByMessageIdentifier;
 
 @property (nonatomic) BOOL showingMoreMessagesIndicator;
 @property (nonatomic) BOOL hasAppeared;
@@ -51,7 +58,16 @@
 @property (nonatomic) BOOL shouldShareLocation;
 @property (nonatomic) BOOL canDisableAddressBar;
 @property (nonatomic) dispatch_queue_t animationQueue;
-@property (nonatomic) BOOL expandingPaginationWindow;
+@property (nonatomic) CGFloat paginationScrollVelocity;
+@property (nonatomic) CGFloat lastScrollContentOffset;
+@property (nonatomic) CFTimeInterval lastScrollTimestamp;
+@property (nonatomic) LYRMessage *paginationAnchorMessage;
+@property (nonatomic) ATLConversationSectionMetadata *sectionMetadata;
+@property (nonatomic) BOOL sectionMetadataNeedsReload;
+@property (nonatomic) LYRMessage *pendingAnchorMessage;
+@property (nonatomic) ATLMessageLabelCache *labelCache;
+@property (nonatomic) NSUInteger conversationLoadCount;
+@property (nonatomic) UIActivityIndicatorView *loadingIndicatorView;
 
 @end
 
@@ -115,9 +131,13 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     _shouldDisplayAvatarItemForAuthenticatedUser = NO;
     _avatarItemDisplayFrequency = ATLAvatarItemDisplayFrequencySection;
     _typingParticipantIDs = [NSMutableOrderedSet new];
-    _sectionHeaders = [NSHashTable weakObjectsHashTable];
-    _sectionFooters = [NSHashTable weakObjectsHashTable];
+    _sectionHeadersByMessageIdentifier = [NSMapTable strongToWeakObjectsMapTable];
+    _sectionFootersByMessageIdentifier = [NSMapTable strongToWeakObjectsMapTable];
     _objectChanges = [NSMutableArray new];
+    _changedMessages = [NSMutableArray new];
+    _labelCache = [ATLMessageLabelCache new];
+    _sectionMetadata = [[ATLConversationSectionMetadata alloc] initWithNumberOfLeadingSections:ATLNumberOfSectionsBeforeFirstMessageSection];
+    _sectionMetadataNeedsReload = YES;
     _animationQueue = dispatch_queue_create("com.atlas.animationQueue", DISPATCH_QUEUE_SERIAL);
 }
 
@@ -126,7 +146,7 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     [super loadView];
     // Collection View Setup
     self.collectionView = [[ATLConversationCollectionView alloc] initWithFrame:CGRectZero
-                                                          collectionViewLayout:[[UICollectionViewFlowLayout alloc] init]];
+                                                          collectionViewLayout:[[ATLConversationCollectionViewLayout alloc] init]];
     self.collectionView.delegate = self;
     self.collectionView.dataSource = self;
 }
@@ -139,6 +159,13 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     _layerClient = layerClient;
 }
 
+- (void)setDataSource:(id<ATLConversationViewControllerDataSource>)dataSource
+{
+    _dataSource = dataSource;
+    // The cached labels were built by the previous data source.
+    [self.labelCache removeAllLabels];
+}
+
 #pragma mark - Lifecycle
 
 - (void)viewDidLoad
@@ -173,6 +200,13 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     }
 }
 
+- (void)viewDidLayoutSubviews
+{
+    [super viewDidLayoutSubviews];
+    // The first layout scrolls to the bottom; an anchored conversation is scrolled back to its anchor once that's done.
+    [self scrollToPendingAnchorMessage];
+}
+
 - (void)viewDidAppear:(BOOL)animated
 {
     [super viewDidAppear:animated];
@@ -212,6 +246,10 @@ static NSInteger const ATLPhotoActionSheet = 1000;
 
 - (void)setConversation:(LYRConversation *)conversation
 {
+    // An anchor left over from `setConversation:anchoredAtMessage:` only applies to the conversation it belongs to.
+    if (self.pendingAnchorMessage && ![self.pendingAnchorMessage.conversation isEqual:conversation]) {
+        self.pendingAnchorMessage = nil;
+    }
     if (!conversation && !_conversation) return;
     if ([conversation isEqual:_conversation]) return;
     
@@ -228,11 +266,33 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     if (conversation) {
         [self fetchLayerMessages];
     } else {
+        // Discards any data source still loading for the previous conversation.
+        self.conversationLoadCount++;
+        [self hideLoadingIndicator];
         self.conversationDataSource = nil;
+        self.sectionMetadataNeedsReload = YES;
         [self.collectionView reloadData];
     }
-    CGSize contentSize = self.collectionView.collectionViewLayout.collectionViewContentSize;
-    [self.collectionView setContentOffset:[self bottomOffsetForContentSize:contentSize] animated:NO];
+    if (self.pendingAnchorMessage) {
+        [self scrollToPendingAnchorMessage];
+    } else {
+        CGSize contentSize = self.collectionView.collectionViewLayout.collectionViewContentSize;
+        [self.collectionView setContentOffset:[self bottomOffsetForContentSize:contentSize] animated:NO];
+    }
+}
+
+- (void)setConversation:(LYRConversation *)conversation anchoredAtMessage:(LYRMessage *)message
+{
+    self.pendingAnchorMessage = message;
+    if (conversation && [conversation isEqual:_conversation]) {
+        // Already displayed; only reload if the anchor fell outside the loaded messages.
+        if (message && ![self.queryController indexPathForObject:message]) {
+            [self fetchLayerMessages];
+        }
+        [self scrollToPendingAnchorMessage];
+        return;
+    }
+    self.conversation = conversation;
 }
 
 - (void)fetchLayerMessages
@@ -250,14 +310,84 @@ static NSInteger const ATLPhotoActionSheet = 1000;
         }
     }
     
-    self.conversationDataSource = [ATLConversationDataSource dataSourceWithLayerClient:self.layerClient query:query];
-    if (!self.conversationDataSource) {
+    CFTimeInterval loadStartTime = CACurrentMediaTime();
+    NSUInteger loadCount = ++self.conversationLoadCount;
+    if (self.loadsMessagesAsynchronously) {
+        // Show an empty conversation until the query controller has executed off the main thread.
+        self.conversationDataSource = nil;
+        self.queryController = self.conversationDataSource.queryController;
+        self.sectionMetadataNeedsReload = YES;
+        [self.collectionView reloadData];
+        [self showLoadingIndicator];
+        __weak typeof(self) weakSelf = self;
+        [ATLConversationDataSource loadDataSourceWithLayerClient:self.layerClient query:query anchorMessage:self.pendingAnchorMessage completion:^(ATLConversationDataSource *dataSource) {
+            // A conversation set while this one was loading takes precedence.
+            if (loadCount != weakSelf.conversationLoadCount) return;
+            [weakSelf hideLoadingIndicator];
+            if (![weakSelf configureWithConversationDataSource:dataSource loadStartTime:loadStartTime]) return;
+            if (weakSelf.pendingAnchorMessage) {
+                [weakSelf scrollToPendingAnchorMessage];
+            } else {
+                [weakSelf scrollToBottomAnimated:NO];
+            }
+        }];
         return;
     }
+    
+    ATLConversationDataSource *dataSource;
+    if (self.pendingAnchorMessage) {
+        dataSource = [ATLConversationDataSource dataSourceWithLayerClient:self.layerClient query:query anchorMessage:self.pendingAnchorMessage];
+    } else {
+        dataSource = [ATLConversationDataSource dataSourceWithLayerClient:self.layerClient query:query];
+    }
+    [self configureWithConversationDataSource:dataSource loadStartTime:loadStartTime];
+}
+
+- (BOOL)configureWithConversationDataSource:(ATLConversationDataSource *)dataSource loadStartTime:(CFTimeInterval)loadStartTime
+{
+    if (!dataSource) return NO;
+    self.conversationDataSource = dataSource;
     self.conversationDataSource.queryController.delegate = self;
+    self.conversationDataSource.delegate = self;
+    self.conversationDataSource.maximumNumberOfMessagesInPaginationWindow = self.maximumNumberOfLoadedMessages;
     self.queryController = self.conversationDataSource.queryController;
     self.showingMoreMessagesIndicator = NO;
+    self.sectionMetadataNeedsReload = YES;
     [self.collectionView reloadData];
+    [self indexLoadedMessages];
+    [self notifyDelegateOfConversationLoadWithLatency:CACurrentMediaTime() - loadStartTime];
+    return YES;
+}
+
+- (void)indexLoadedMessages
+{
+    if (!self.messageSearchIndex) return;
+    NSUInteger numberOfMessages = [self.queryController numberOfObjectsInSection:0];
+    NSMutableArray *messages = [NSMutableArray arrayWithCapacity:numberOfMessages];
+    for (NSUInteger row = 0; row < numberOfMessages; row++) {
+        LYRMessage *message = [self.queryController objectAtIndexPath:[NSIndexPath indexPathForRow:row inSection:0]];
+        if (message) [messages addObject:message];
+    }
+    [self.messageSearchIndex indexMessages:messages];
+}
+
+- (void)showLoadingIndicator
+{
+    if (!self.loadingIndicatorView) {
+        self.loadingIndicatorView = [[UIActivityIndicatorView alloc] initWithActivityIndicatorStyle:UIActivityIndicatorViewStyleGray];
+        self.loadingIndicatorView.hidesWhenStopped = YES;
+    }
+    self.collectionView.backgroundView = self.loadingIndicatorView;
+    [self.loadingIndicatorView startAnimating];
+}
+
+- (void)hideLoadingIndicator
+{
+    if (!self.loadingIndicatorView) return;
+    [self.loadingIndicatorView stopAnimating];
+    if (self.collectionView.backgroundView == self.loadingIndicatorView) {
+        self.collectionView.backgroundView = nil;
+    }
 }
 
 #pragma mark - Conntroller Setup
@@ -335,6 +465,29 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     [self notifyDelegateOfMessageSelection:[self.conversationDataSource messageAtCollectionViewIndexPath:indexPath]];
 }
 
+- (void)collectionView:(UICollectionView *)collectionView willDisplayCell:(UICollectionViewCell *)cell forItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    if ([cell isKindOfClass:[ATLMessageCollectionViewCell class]]) {
+        [(ATLMessageCollectionViewCell *)cell updateImageLoadingPriorityForVisibility:YES];
+    }
+}
+
+- (void)collectionView:(UICollectionView *)collectionView didEndDisplayingCell:(UICollectionViewCell *)cell forItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    if ([cell isKindOfClass:[ATLMessageCollectionViewCell class]]) {
+        [(ATLMessageCollectionViewCell *)cell updateImageLoadingPriorityForVisibility:NO];
+    }
+}
+
+- (void)collectionView:(UICollectionView *)collectionView didEndDisplayingSupplementaryView:(UICollectionReusableView *)view forElementOfKind:(NSString *)elementKind atIndexPath:(NSIndexPath *)indexPath
+{
+    if ([view isKindOfClass:[ATLConversationCollectionViewHeader class]]) {
+        [self removeView:view forMessage:[(ATLConversationCollectionViewHeader *)view message] fromMapTable:self.sectionHeadersByMessageIdentifier];
+    } else if ([view isKindOfClass:[ATLConversationCollectionViewFooter class]]) {
+        [self removeView:view forMessage:[(ATLConversationCollectionViewFooter *)view message] fromMapTable:self.sectionFootersByMessageIdentifier];
+    }
+}
+
 #pragma mark - UICollectionViewDelegateFlowLayout
 
 - (CGSize)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewLayout *)collectionViewLayout sizeForItemAtIndexPath:(NSIndexPath *)indexPath
@@ -350,13 +503,19 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     }
     if (kind == UICollectionElementKindSectionHeader) {
         ATLConversationCollectionViewHeader *header = [self.collectionView dequeueReusableSupplementaryViewOfKind:kind withReuseIdentifier:ATLConversationViewHeaderIdentifier forIndexPath:indexPath];
+        [self removeView:header forMessage:header.message fromMapTable:self.sectionHeadersByMessageIdentifier];
         [self configureHeader:header atIndexPath:indexPath];
-        [self.sectionHeaders addObject:header];
+        if (header.message.identifier) {
+            [self.sectionHeadersByMessageIdentifier setObject:header forKey:header.message.identifier];
+        }
         return header;
     } else {
         ATLConversationCollectionViewFooter *footer = [self.collectionView dequeueReusableSupplementaryViewOfKind:kind withReuseIdentifier:ATLConversationViewFooterIdentifier forIndexPath:indexPath];
+        [self removeView:footer forMessage:footer.message fromMapTable:self.sectionFootersByMessageIdentifier];
         [self configureFooter:footer atIndexPath:indexPath];
-        [self.sectionFooters addObject:footer];
+        if (footer.message.identifier) {
+            [self.sectionFootersByMessageIdentifier setObject:footer forKey:footer.message.identifier];
+        }
         return footer;
     }
 }
@@ -366,27 +525,44 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     if (section == ATLMoreMessagesSection) {
         return self.showingMoreMessagesIndicator ? CGSizeMake(0, 30) : CGSizeZero;
     }
-    NSAttributedString *dateString;
+    LYRMessage *message = [self.conversationDataSource messageAtCollectionViewSection:section];
+    ATLConversationSectionFlags flags = 0;
     NSString *participantName;
     if ([self shouldDisplayDateLabelForSection:section]) {
-        dateString = [self attributedStringForMessageDate:[self.conversationDataSource messageAtCollectionViewSection:section]];
+        flags |= ATLConversationSectionFlagDateLabel;
     }
     if ([self shouldDisplaySenderLabelForSection:section]) {
-        participantName = [self participantNameForMessage:[self.conversationDataSource messageAtCollectionViewSection:section]];
+        flags |= ATLConversationSectionFlagSenderLabel;
+        participantName = [self participantNameForMessage:message];
+    }
+    NSNumber *cachedHeight = [self.labelCache headerHeightForMessage:message flags:flags participantName:participantName];
+    if (cachedHeight) {
+        return CGSizeMake(0, cachedHeight.doubleValue);
     }
+    NSAttributedString *dateString = (flags & ATLConversationSectionFlagDateLabel) ? [self attributedStringForMessageDate:message] : nil;
     CGFloat height = [ATLConversationCollectionViewHeader headerHeightWithDateString:dateString participantName:participantName inView:self.collectionView];
+    [self.labelCache setHeaderHeight:height forMessage:message flags:flags participantName:participantName];
     return CGSizeMake(0, height);
 }
 
 - (CGSize)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewLayout *)collectionViewLayout referenceSizeForFooterInSection:(NSInteger)section
 {
     if (section == ATLMoreMessagesSection) return CGSizeZero;
-    NSAttributedString *readReceipt;
+    LYRMessage *message = [self.conversationDataSource messageAtCollectionViewSection:section];
+    ATLConversationSectionFlags flags = 0;
     if ([self shouldDisplayReadReceiptForSection:section]) {
-        readReceipt = [self attributedStringForRecipientStatusOfMessage:[self.conversationDataSource messageAtCollectionViewSection:section]];
+        flags |= ATLConversationSectionFlagReadReceipt;
     }
-    BOOL shouldClusterMessage = [self shouldClusterMessageAtSection:section];
-    CGFloat height = [ATLConversationCollectionViewFooter footerHeightWithRecipientStatus:readReceipt clustered:shouldClusterMessage];
+    if ([self shouldClusterMessageAtSection:section]) {
+        flags |= ATLConversationSectionFlagClustered;
+    }
+    NSNumber *cachedHeight = [self.labelCache footerHeightForMessage:message flags:flags];
+    if (cachedHeight) {
+        return CGSizeMake(0, cachedHeight.doubleValue);
+    }
+    NSAttributedString *readReceipt = (flags & ATLConversationSectionFlagReadReceipt) ? [self attributedStringForRecipientStatusOfMessage:message] : nil;
+    CGFloat height = [ATLConversationCollectionViewFooter footerHeightWithRecipientStatus:readReceipt clustered:(flags & ATLConversationSectionFlagClustered) != 0];
+    [self.labelCache setFooterHeight:height forMessage:message flags:flags];
     return CGSizeMake(0, height);
 }
 
@@ -396,6 +572,31 @@ static NSInteger const ATLPhotoActionSheet = 1000;
 {
     // When the keyboard is being dragged, we need to update the position of the typing indicator.
     [self.view setNeedsUpdateConstraints];
+    
+    // Track how fast the user scrolls towards older messages, so the next page can be loaded ahead of time while decelerating.
+    CFTimeInterval timestamp = CACurrentMediaTime();
+    CFTimeInterval elapsedTime = timestamp - self.lastScrollTimestamp;
+    if (elapsedTime > 0 && elapsedTime < 0.1) {
+        self.paginationScrollVelocity = MAX(0, (self.lastScrollContentOffset - scrollView.contentOffset.y) / elapsedTime);
+    } else {
+        self.paginationScrollVelocity = 0;
+    }
+    self.lastScrollContentOffset = scrollView.contentOffset.y;
+    self.lastScrollTimestamp = timestamp;
+    if (scrollView.isDecelerating) {
+        [self configurePaginationWindow];
+    }
+}
+
+- (void)scrollViewWillEndDragging:(UIScrollView *)scrollView withVelocity:(CGPoint)velocity targetContentOffset:(inout CGPoint *)targetContentOffset
+{
+    // The velocity is in points per millisecond; if the fling ends near the top, the next page starts loading right away.
+    // The expansion waits for the deceleration to begin, since the target offset can't follow the content being inserted above it.
+    CGFloat upwardVelocity = MAX(0, -velocity.y * 1000);
+    CGFloat targetOffset = targetContentOffset->y;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self expandPaginationWindowIfNeededForContentOffset:targetOffset velocity:upwardVelocity];
+    });
 }
 
 - (void)scrollViewDidEndDragging:(UIScrollView *)scrollView willDecelerate:(BOOL)decelerate
@@ -472,11 +673,12 @@ static NSInteger const ATLPhotoActionSheet = 1000;
 
 - (BOOL)shouldDisplayDateLabelForSection:(NSUInteger)section
 {
-    if (section < ATLNumberOfSectionsBeforeFirstMessageSection) return NO;
-    if (section == ATLNumberOfSectionsBeforeFirstMessageSection) return YES;
-    
-    LYRMessage *message = [self.conversationDataSource messageAtCollectionViewSection:section];
-    LYRMessage *previousMessage = [self.conversationDataSource messageAtCollectionViewSection:section - 1];
+    return ([self displayFlagsForSection:section] & ATLConversationSectionFlagDateLabel) != 0;
+}
+
+- (BOOL)shouldDisplayDateLabelForMessage:(LYRMessage *)message previousMessage:(LYRMessage *)previousMessage
+{
+    if (!previousMessage) return YES;
     if (!previousMessage.sentAt) return NO;
     
     NSDate *date = message.sentAt ?: [NSDate date];
@@ -488,16 +690,16 @@ static NSInteger const ATLPhotoActionSheet = 1000;
 }
 
 - (BOOL)shouldDisplaySenderLabelForSection:(NSUInteger)section
+{
+    return ([self displayFlagsForSection:section] & ATLConversationSectionFlagSenderLabel) != 0;
+}
+
+- (BOOL)shouldDisplaySenderLabelForMessage:(LYRMessage *)message previousMessage:(LYRMessage *)previousMessage
 {
     if (self.conversation.participants.count <= 2) return NO;
-    
-    LYRMessage *message = [self.conversationDataSource messageAtCollectionViewSection:section];
     if ([message.sender.userID isEqualToString:self.layerClient.authenticatedUser.userID]) return NO;
-    if (section > ATLNumberOfSectionsBeforeFirstMessageSection) {
-        LYRMessage *previousMessage = [self.conversationDataSource messageAtCollectionViewSection:section - 1];
-        if ([previousMessage.sender.userID isEqualToString:message.sender.userID]) {
-            return NO;
-        }
+    if (previousMessage && [previousMessage.sender.userID isEqualToString:message.sender.userID]) {
+        return NO;
     }
     return YES;
 }
@@ -505,54 +707,64 @@ static NSInteger const ATLPhotoActionSheet = 1000;
 - (BOOL)shouldDisplayReadReceiptForSection:(NSUInteger)section
 {
     // Only show read receipt if last message was sent by currently authenticated user
-    NSInteger lastQueryControllerRow = [self.conversationDataSource.queryController numberOfObjectsInSection:0] - 1;
-    NSInteger lastSection = [self.conversationDataSource collectionViewSectionForQueryControllerRow:lastQueryControllerRow];
-    if (section != lastSection) return NO;
-    LYRMessage *message = [self.conversationDataSource messageAtCollectionViewSection:section];
-    if (![message.sender.userID isEqualToString:self.layerClient.authenticatedUser.userID]) return NO;
-    
-    return YES;
+    return ([self displayFlagsForSection:section] & ATLConversationSectionFlagReadReceipt) != 0;
 }
 
 - (BOOL)shouldClusterMessageAtSection:(NSUInteger)section
 {
-    if (section == self.collectionView.numberOfSections - 1) {
-        return NO;
-    }
-    LYRMessage *message = [self.conversationDataSource messageAtCollectionViewSection:section];
-    LYRMessage *nextMessage = [self.conversationDataSource messageAtCollectionViewSection:section + 1];
-    if (!nextMessage.receivedAt) {
-        return NO;
-    }
-    NSDate *date = message.receivedAt ?: [NSDate date];
-    NSTimeInterval interval = [nextMessage.receivedAt timeIntervalSinceDate:date];
-    return (interval < 60);
+    return ([self displayFlagsForSection:section] & ATLConversationSectionFlagClustered) != 0;
 }
 
 - (BOOL)shouldDisplayAvatarItemAtIndexPath:(NSIndexPath *)indexPath
 {
-    if (!self.shouldDisplayAvatarItem) return NO;
-    LYRMessage *message = [self.conversationDataSource messageAtCollectionViewIndexPath:indexPath];
-    if (message.sender.userID == nil) {
-        return NO;
-    }
-    
-    if ([message.sender.userID isEqualToString:self.layerClient.authenticatedUser.userID] && !self.shouldDisplayAvatarItemForAuthenticatedUser) {
-        return NO;
-    }
-    if (![self shouldClusterMessageAtSection:indexPath.section] && self.avatarItemDisplayFrequency == ATLAvatarItemDisplayFrequencyCluster) {
-        return YES;
+    return ([self displayFlagsForSection:indexPath.section] & ATLConversationSectionFlagAvatarItem) != 0;
+}
+
+#pragma mark - Section Metadata
+
+- (ATLConversationSectionFlags)displayFlagsForSection:(NSUInteger)section
+{
+    if (self.sectionMetadataNeedsReload) {
+        [self reloadSectionMetadata];
     }
-    NSInteger lastQueryControllerRow = [self.conversationDataSource.queryController numberOfObjectsInSection:0] - 1;
-    NSInteger lastSection = [self.conversationDataSource collectionViewSectionForQueryControllerRow:lastQueryControllerRow];
-    if (indexPath.section < lastSection) {
-        LYRMessage *nextMessage = [self.conversationDataSource messageAtCollectionViewSection:indexPath.section + 1];
-        // If the next message is sent by the same user, no
-        if ([nextMessage.sender.userID isEqualToString:message.sender.userID] && self.avatarItemDisplayFrequency != ATLAvatarItemDisplayFrequencyAll) {
-            return NO;
-        }
+    return [self.sectionMetadata flagsForSection:section];
+}
+
+- (void)reloadSectionMetadata
+{
+    self.sectionMetadataNeedsReload = NO;
+    [self configureSectionMetadata];
+    LYRQueryController *queryController = self.conversationDataSource.queryController;
+    NSUInteger numberOfMessages = [queryController numberOfObjectsInSection:0];
+    NSMutableArray *messages = [NSMutableArray arrayWithCapacity:numberOfMessages];
+    for (NSUInteger row = 0; row < numberOfMessages; row++) {
+        LYRMessage *message = [queryController objectAtIndexPath:[NSIndexPath indexPathForRow:row inSection:0]];
+        if (message) [messages addObject:message];
     }
-    return YES;
+    [self.sectionMetadata reloadWithMessages:messages];
+}
+
+- (void)configureSectionMetadata
+{
+    self.sectionMetadata.authenticatedUserID = self.layerClient.authenticatedUser.userID;
+    self.sectionMetadata.dateDisplayTimeInterval = self.dateDisplayTimeInterval;
+    self.sectionMetadata.displaysSenderLabels = self.conversation.participants.count > 2;
+    self.sectionMetadata.displaysAvatarItems = self.shouldDisplayAvatarItem;
+    self.sectionMetadata.displaysAvatarItemsForAuthenticatedUser = self.shouldDisplayAvatarItemForAuthenticatedUser;
+    self.sectionMetadata.avatarItemDisplayFrequency = self.avatarItemDisplayFrequency;
+    self.sectionMetadata.newerMessagesAvailable = self.conversationDataSource.newerMessagesAvailable;
+}
+
+/**
+ Atlas - Applies a batch of changes to the section metadata. Returns the sections whose flags changed, or `nil` if the table will be rebuilt anyway.
+ */
+- (NSIndexSet *)applyChangeSetToSectionMetadata:(ATLDataSourceChangeSet *)changeSet
+{
+    if (self.sectionMetadataNeedsReload) return nil;
+    [self configureSectionMetadata];
+    return [self.sectionMetadata applyChangeSet:changeSet messageAtSection:^LYRMessage *(NSUInteger section) {
+        return [self.conversationDataSource messageAtCollectionViewSection:section];
+    }];
 }
 
 #pragma mark - ATLMessageInputToolbarDelegate
@@ -641,6 +853,12 @@ static NSInteger const ATLPhotoActionSheet = 1000;
 
 - (void)sendMessage:(LYRMessage *)message
 {
+    // The sent message goes at the bottom, so a window opened further back jumps to the newest messages first.
+    if (self.conversationDataSource.newerMessagesAvailable) {
+        self.pendingAnchorMessage = nil;
+        [self.conversationDataSource movePaginationWindowToNewestMessages];
+        [self scrollToBottomAnimated:NO];
+    }
     NSError *error;
     BOOL success = [self.conversation sendMessage:message error:&error];
     if (success) {
@@ -857,6 +1075,7 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     }
     [self configureAddressBarForChangedParticipants];
     [self configureControllerForConversation];
+    self.sectionMetadataNeedsReload = YES;
     [self.collectionView reloadData];
 }
 
@@ -893,20 +1112,71 @@ static NSInteger const ATLPhotoActionSheet = 1000;
 
 #pragma mark - Pagination
 
+- (void)scrollToPendingAnchorMessage
+{
+    if (!self.pendingAnchorMessage || !self.isViewLoaded || !self.queryController) return;
+    if (CGRectEqualToRect(self.collectionView.bounds, CGRectZero)) return;
+    NSIndexPath *queryControllerIndexPath = [self.queryController indexPathForObject:self.pendingAnchorMessage];
+    self.pendingAnchorMessage = nil;
+    if (!queryControllerIndexPath) return;
+    
+    NSIndexPath *indexPath = [self.conversationDataSource collectionViewIndexPathForQueryControllerIndexPath:queryControllerIndexPath];
+    [self.collectionView layoutIfNeeded];
+    [self.collectionView scrollToItemAtIndexPath:indexPath atScrollPosition:UICollectionViewScrollPositionCenteredVertically animated:NO];
+}
+
 - (void)configurePaginationWindow
+{
+    if (self.collectionView.isDragging && !self.collectionView.isDecelerating) return;
+    CGFloat velocity = self.collectionView.isDecelerating ? self.paginationScrollVelocity : 0;
+    [self expandPaginationWindowIfNeededForContentOffset:self.collectionView.contentOffset.y velocity:velocity];
+    if (!self.collectionView.isDecelerating) {
+        [self trimPaginationWindow];
+    }
+}
+
+- (void)expandPaginationWindowIfNeededForContentOffset:(CGFloat)contentOffset velocity:(CGFloat)velocity
 {
     if (CGRectEqualToRect(self.collectionView.frame, CGRectZero)) return;
-    if (self.collectionView.isDragging) return;
-    if (self.collectionView.isDecelerating) return;
+    if (self.conversationDataSource.expandingPaginationWindow) return;
     
+    // Newer messages are only missing if they were dropped from a bounded window; bring them back when nearing the bottom.
+    if (self.conversationDataSource.newerMessagesAvailable) {
+        CGFloat distanceFromBottom = [self bottomOffsetForContentSize:self.collectionView.contentSize].y - contentOffset;
+        if (distanceFromBottom <= self.conversationDataSource.minimumPaginationTriggerDistance) {
+            [self.conversationDataSource expandPaginationWindowTowardsNewerMessages];
+            return;
+        }
+    }
+    if (![self.conversationDataSource moreMessagesAvailable]) return;
+    
+    // The faster the user scrolls towards older messages, the further ahead the next page is loaded.
     CGFloat topOffset = -self.collectionView.contentInset.top;
-    CGFloat distanceFromTop = self.collectionView.contentOffset.y - topOffset;
-    CGFloat minimumDistanceFromTopToTriggerLoadingMore = 200;
-    BOOL nearTop = distanceFromTop <= minimumDistanceFromTopToTriggerLoadingMore;
+    CGFloat distanceFromTop = contentOffset - topOffset;
+    BOOL nearTop = distanceFromTop <= [self.conversationDataSource paginationTriggerDistanceForScrollVelocity:velocity];
     if (!nearTop) return;
     
-    self.expandingPaginationWindow = YES;
-    [self.conversationDataSource expandPaginationWindow];
+    self.paginationAnchorMessage = [self.conversationDataSource messageAtCollectionViewSection:ATLNumberOfSectionsBeforeFirstMessageSection];
+    [self.conversationDataSource expandPaginationWindowWithScrollVelocity:velocity averageMessageHeight:[self averageMessageHeight]];
+}
+
+- (void)trimPaginationWindow
+{
+    if (self.conversationDataSource.maximumNumberOfMessagesInPaginationWindow == 0) return;
+    NSArray *visibleIndexPaths = [self.collectionView indexPathsForVisibleItems];
+    if (visibleIndexPaths.count == 0) return;
+    NSInteger firstSection = [[visibleIndexPaths valueForKeyPath:@"@min.section"] integerValue];
+    NSInteger lastSection = [[visibleIndexPaths valueForKeyPath:@"@max.section"] integerValue];
+    NSIndexPath *middleIndexPath = [NSIndexPath indexPathForItem:0 inSection:(firstSection + lastSection) / 2];
+    NSInteger row = [self.conversationDataSource queryControllerIndexPathForCollectionViewIndexPath:middleIndexPath].row;
+    [self.conversationDataSource trimPaginationWindowAroundQueryControllerRow:MAX(row, 0)];
+}
+
+- (CGFloat)averageMessageHeight
+{
+    NSInteger numberOfMessages = [self.collectionView numberOfSections] - ATLNumberOfSectionsBeforeFirstMessageSection;
+    if (numberOfMessages <= 0) return 0;
+    return self.collectionView.collectionViewLayout.collectionViewContentSize.height / numberOfMessages;
 }
 
 - (void)configureMoreMessagesIndicatorVisibility
@@ -922,6 +1192,7 @@ static NSInteger const ATLPhotoActionSheet = 1000;
 - (void)reloadCollectionViewAdjustingForContentHeightChange
 {
     CGFloat priorContentHeight = self.collectionView.contentSize.height;
+    self.sectionMetadataNeedsReload = YES;
     [self.collectionView reloadData];
     CGFloat contentHeightDifference = self.collectionView.collectionViewLayout.collectionViewContentSize.height - priorContentHeight;
     CGFloat adjustment = contentHeightDifference;
@@ -929,6 +1200,108 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     [self.collectionView flashScrollIndicators];
 }
 
+- (void)insertSectionsForExpandedPaginationWindow
+{
+    LYRMessage *anchorMessage = self.paginationAnchorMessage;
+    self.paginationAnchorMessage = nil;
+    self.showingMoreMessagesIndicator = [self.conversationDataSource moreMessagesAvailable];
+    
+    // The new page is only inserted in place if it landed right above the message that was at the top; anything else falls back to a reload.
+    NSInteger insertedSectionCount = [self numberOfSectionsInCollectionView:self.collectionView] - [self.collectionView numberOfSections];
+    NSInteger anchorSection = ATLNumberOfSectionsBeforeFirstMessageSection + insertedSectionCount;
+    LYRMessage *message = insertedSectionCount > 0 ? [self.conversationDataSource messageAtCollectionViewSection:anchorSection] : nil;
+    if (!anchorMessage || ![message.identifier isEqual:anchorMessage.identifier]) {
+        [self reloadCollectionViewAdjustingForContentHeightChange];
+        return;
+    }
+    
+    NSMutableArray *insertions = [NSMutableArray arrayWithCapacity:insertedSectionCount];
+    for (NSInteger section = ATLNumberOfSectionsBeforeFirstMessageSection; section < anchorSection; section++) {
+        [insertions addObject:[ATLDataSourceChange changeObjectWithType:LYRQueryControllerChangeTypeInsert newIndex:section currentIndex:NSNotFound]];
+    }
+    ATLDataSourceChangeSet *changeSet = [ATLDataSourceChangeSet changeSetWithChanges:insertions];
+    NSIndexSet *sectionsWithChangedFlags = [self applyChangeSetToSectionMetadata:changeSet];
+    
+    // The layout measures only the new sections and their neighbours, and keeps the messages on screen in place.
+    [UIView performWithoutAnimation:^{
+        [self.collectionView performBatchUpdates:^{
+            [self.collectionView insertSections:changeSet.insertedSections];
+        } completion:nil];
+    }];
+    
+    // The former first message now has a predecessor, which may change its date and sender labels.
+    [self configureCollectionViewElementsInSections:sectionsWithChangedFlags ?: changeSet.neighbouringSections];
+    [self.collectionView flashScrollIndicators];
+}
+
+- (void)reloadCollectionViewKeepingMessageInPlaceFromQueryController:(LYRQueryController *)previousQueryController
+{
+    // Remember the topmost visible message and where it sits on screen, so the reload doesn't move it.
+    NSIndexPath *anchorIndexPath = [[self.collectionView indexPathsForVisibleItems] sortedArrayUsingSelector:@selector(compare:)].firstObject;
+    LYRMessage *anchorMessage;
+    CGFloat anchorDistance = 0;
+    if (anchorIndexPath) {
+        NSIndexPath *queryControllerIndexPath = [self.conversationDataSource queryControllerIndexPathForCollectionViewIndexPath:anchorIndexPath];
+        anchorMessage = [previousQueryController objectAtIndexPath:queryControllerIndexPath];
+        anchorDistance = CGRectGetMinY([self.collectionView layoutAttributesForItemAtIndexPath:anchorIndexPath].frame) - self.collectionView.contentOffset.y;
+    }
+    
+    self.showingMoreMessagesIndicator = [self.conversationDataSource moreMessagesAvailable];
+    self.sectionMetadataNeedsReload = YES;
+    [self.collectionView reloadData];
+    [self.collectionView layoutIfNeeded];
+    
+    NSIndexPath *queryControllerIndexPath = anchorMessage ? [self.conversationDataSource.queryController indexPathForObject:anchorMessage] : nil;
+    if (!queryControllerIndexPath) return;
+    NSIndexPath *collectionViewIndexPath = [self.conversationDataSource collectionViewIndexPathForQueryControllerIndexPath:queryControllerIndexPath];
+    CGFloat anchorOffset = CGRectGetMinY([self.collectionView layoutAttributesForItemAtIndexPath:collectionViewIndexPath].frame);
+    self.collectionView.contentOffset = CGPointMake(self.collectionView.contentOffset.x, anchorOffset - anchorDistance);
+}
+
+#pragma mark - ATLConversationDataSourceDelegate
+
+- (void)conversationDataSource:(ATLConversationDataSource *)dataSource didReplaceQueryController:(LYRQueryController *)previousQueryController
+{
+    self.queryController = dataSource.queryController;
+    [self reloadCollectionViewKeepingMessageInPlaceFromQueryController:previousQueryController];
+}
+
+- (void)conversationDataSource:(ATLConversationDataSource *)dataSource willExpandPaginationWindowWithMessages:(NSArray *)messages completion:(void (^)(void))completion
+{
+    // The first message on screen gets a new predecessor, so its header is measured along with the new page.
+    LYRMessage *firstDisplayedMessage = [self.conversationDataSource messageAtCollectionViewSection:ATLNumberOfSectionsBeforeFirstMessageSection];
+    NSArray *messagesToMeasure = firstDisplayedMessage ? [messages arrayByAddingObject:firstDisplayedMessage] : messages;
+    [self.messageSearchIndex indexMessages:messages];
+    
+    // Building the header strings involves the data source, so it stays on the main thread; measuring them doesn't.
+    NSMutableArray *dateStrings = [NSMutableArray new];
+    NSMutableArray *participantNames = [NSMutableArray new];
+    LYRMessage *previousMessage;
+    for (LYRMessage *message in messagesToMeasure) {
+        if ([self shouldDisplayDateLabelForMessage:message previousMessage:previousMessage]) {
+            NSAttributedString *dateString = [self attributedStringForMessageDate:message];
+            if (dateString) [dateStrings addObject:dateString];
+        }
+        if ([self shouldDisplaySenderLabelForMessage:message previousMessage:previousMessage]) {
+            NSString *participantName = [self participantNameForMessage:message];
+            if (participantName) [participantNames addObject:participantName];
+        }
+        previousMessage = message;
+    }
+    
+    // Footers of older messages never show a read receipt, so their height doesn't involve any text.
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_group_enter(group);
+    [self prepareLayoutsForMessages:messages completion:^{
+        dispatch_group_leave(group);
+    }];
+    dispatch_group_enter(group);
+    [ATLConversationCollectionViewHeader prepareHeightsForDateStrings:dateStrings participantNames:participantNames inView:self.collectionView completion:^{
+        dispatch_group_leave(group);
+    }];
+    dispatch_group_notify(group, dispatch_get_main_queue(), completion);
+}
+
 #pragma mark - Conversation Configuration
 
 - (void)configureConversationForAddressBar
@@ -1003,47 +1376,23 @@ static NSInteger const ATLPhotoActionSheet = 1000;
 
 - (void)reloadCellsForMessagesSentByParticipantWithIdentifier:(NSString *)participantIdentifier
 {
-    if (self.conversationDataSource.queryController.query == nil) {
+    if (![NSThread isMainThread]) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self reloadCellsForMessagesSentByParticipantWithIdentifier:participantIdentifier];
+        });
         return;
     }
+    if (!participantIdentifier || !self.conversationDataSource) return;
+    [self.labelCache removeParticipantNameForUserID:participantIdentifier];
     
-    dispatch_async(self.animationQueue, ^{
-        // Query for all of the message identifiers in the conversation
-        LYRQuery *messageIdentifiersQuery = [self.conversationDataSource.queryController.query copy];
-        if (messageIdentifiersQuery == nil) {
-            return;
-        }
-        messageIdentifiersQuery.resultType = LYRQueryResultTypeIdentifiers;
-        NSError *error = nil;
-        NSOrderedSet *messageIdentifiers = [self.layerClient executeQuery:messageIdentifiersQuery error:&error];
-        if (!messageIdentifiers) {
-            NSLog(@"LayerKit failed to execute query with error: %@", error);
-            return;
-        }
-        
-        // Query for the all of the message identifiers in the above set where user == participantIdentifier
-        LYRQuery *query = [LYRQuery queryWithQueryableClass:[LYRMessage class]];
-        LYRPredicate *senderPredicate = [LYRPredicate predicateWithProperty:@"sender.userID" predicateOperator:LYRPredicateOperatorIsEqualTo value:participantIdentifier];
-        LYRPredicate *objectIdentifiersPredicate = [LYRPredicate predicateWithProperty:@"identifier" predicateOperator:LYRPredicateOperatorIsIn value:messageIdentifiers];
-        query.predicate = [LYRCompoundPredicate compoundPredicateWithType:LYRCompoundPredicateTypeAnd subpredicates:@[ senderPredicate, objectIdentifiersPredicate ]];
-        query.resultType = LYRQueryResultTypeIdentifiers;
-        NSOrderedSet *messageIdentifiersToReload = [self.layerClient executeQuery:query error:&error];
-        if (!messageIdentifiers) {
-            NSLog(@"LayerKit failed to execute query with error: %@", error);
-            return;
-        }
-        
-        // Convert query controller index paths to collection view index paths
-        NSDictionary *objectIdentifiersToIndexPaths = [self.conversationDataSource.queryController indexPathsForObjectsWithIdentifiers:messageIdentifiersToReload.set];
-        NSArray *queryControllerIndexPaths = [objectIdentifiersToIndexPaths allValues];
-        for (NSIndexPath *indexPath in queryControllerIndexPaths) {
-            NSIndexPath *collectionViewIndexPath = [self.conversationDataSource collectionViewIndexPathForQueryControllerIndexPath:indexPath];
-            // Configure the cell, the header, and the footer
-            dispatch_async(dispatch_get_main_queue(), ^{
-                [self configureCollectionViewElementsAtCollectionViewIndexPath:collectionViewIndexPath];
-            });
-        }
-    });
+    // Sections which aren't on screen pick up the change when they are dequeued, so only the visible ones are looked up.
+    NSRange visibleSections = [self visibleSectionRange];
+    if (visibleSections.length == 0) return;
+    if (self.sectionMetadataNeedsReload) {
+        [self reloadSectionMetadata];
+    }
+    NSIndexSet *sections = [self.sectionMetadata sectionsWithSenderID:participantIdentifier inRange:visibleSections];
+    [self configureCollectionViewElementsInSections:sections];
 }
 
 #pragma mark - Delegate
@@ -1069,6 +1418,13 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     }
 }
 
+- (void)notifyDelegateOfConversationLoadWithLatency:(NSTimeInterval)latency
+{
+    if ([self.delegate respondsToSelector:@selector(conversationViewController:didLoadMessagesInConversation:latency:)]) {
+        [self.delegate conversationViewController:self didLoadMessagesInConversation:self.conversation latency:latency];
+    }
+}
+
 - (CGSize)heightForMessageAtIndexPath:(NSIndexPath *)indexPath
 {
     CGFloat width = self.collectionView.bounds.size.width;
@@ -1109,7 +1465,8 @@ static NSInteger const ATLPhotoActionSheet = 1000;
 
 - (NSAttributedString *)attributedStringForMessageDate:(LYRMessage *)message
 {
-    NSAttributedString *dateString;
+    NSAttributedString *dateString = [self.labelCache dateStringForMessage:message];
+    if (dateString) return dateString;
     if ([self.dataSource respondsToSelector:@selector(conversationViewController:attributedStringForDisplayOfDate:)]) {
         NSDate *date = message.sentAt ?: [NSDate date];
         dateString = [self.dataSource conversationViewController:self attributedStringForDisplayOfDate:date];
@@ -1117,18 +1474,21 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     } else {
         @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:@"ATLConversationViewControllerDataSource must return an attributed string for Date" userInfo:nil];
     }
+    [self.labelCache setDateString:dateString forMessage:message];
     return dateString;
 }
 
 - (NSAttributedString *)attributedStringForRecipientStatusOfMessage:(LYRMessage *)message
 {
-    NSAttributedString *recipientStatusString;
+    NSAttributedString *recipientStatusString = [self.labelCache recipientStatusStringForMessage:message];
+    if (recipientStatusString) return recipientStatusString;
     if ([self.dataSource respondsToSelector:@selector(conversationViewController:attributedStringForDisplayOfRecipientStatus:)]) {
         recipientStatusString = [self.dataSource conversationViewController:self attributedStringForDisplayOfRecipientStatus:message.recipientStatusByUserID];
         NSAssert([recipientStatusString isKindOfClass:[NSAttributedString class]], @"Recipient String must be an attributed string");
     } else {
         @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:@"ATLConversationViewControllerDataSource must return an attributed string for recipient status" userInfo:nil];
     }
+    [self.labelCache setRecipientStatusString:recipientStatusString forMessage:message];
     return recipientStatusString;
 }
 
@@ -1175,7 +1535,26 @@ static NSInteger const ATLPhotoActionSheet = 1000;
           forChangeType:(LYRQueryControllerChangeType)type
            newIndexPath:(NSIndexPath *)newIndexPath
 {
-    if (self.expandingPaginationWindow) return;
+    if (type == LYRQueryControllerChangeTypeUpdate) {
+        // A finished content transfer can change the size of an image message, so its layout has to be measured again.
+        [[ATLMessageLayoutCache sharedLayoutCache] invalidateLayoutForMessage:object];
+    }
+    if (type == LYRQueryControllerChangeTypeUpdate || type == LYRQueryControllerChangeTypeDelete) {
+        // Updates are limited to the `updatableProperties`, which include the date and recipient status the labels show.
+        [self.labelCache removeLabelsForMessage:object];
+    }
+    if (type == LYRQueryControllerChangeTypeInsert || type == LYRQueryControllerChangeTypeUpdate) {
+        [self.changedMessages addObject:object];
+    }
+    // Messages sliding out of the pagination window are deleted from the query controller too, but stay searchable and keep their images.
+    if (type == LYRQueryControllerChangeTypeDelete && [object isDeleted] && [object identifier]) {
+        [self.messageSearchIndex removeMessagesWithIdentifiers:@[ [object identifier] ]];
+        for (LYRMessagePart *messagePart in [object parts]) {
+            [[ATLImageCache sharedImageCache] removeImagesForMessagePart:messagePart];
+        }
+    }
+    // The new page of an expansion is inserted as a whole once the query controller is done reporting it.
+    if (self.conversationDataSource.reportingExpandedPaginationWindow) return;
     NSInteger currentIndex = indexPath ? [self.conversationDataSource collectionViewSectionForQueryControllerRow:indexPath.row] : NSNotFound;
     NSInteger newIndex = newIndexPath ? [self.conversationDataSource collectionViewSectionForQueryControllerRow:newIndexPath.row] : NSNotFound;
     [self.objectChanges addObject:[ATLDataSourceChange changeObjectWithType:type newIndex:newIndex currentIndex:currentIndex]];
@@ -1191,10 +1570,14 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     NSArray *objectChanges = [self.objectChanges copy];
     [self.objectChanges removeAllObjects];
     
-    if (self.expandingPaginationWindow) {
-        self.expandingPaginationWindow = NO;
-        self.showingMoreMessagesIndicator = [self.conversationDataSource moreMessagesAvailable];
-        [self reloadCollectionViewAdjustingForContentHeightChange];
+    // Start measuring the new messages in the background while the collection view gets updated.
+    [self prepareLayoutsForMessages:[self.changedMessages copy] completion:nil];
+    [self.messageSearchIndex indexMessages:[self.changedMessages copy]];
+    [self.changedMessages removeAllObjects];
+    
+    if (self.conversationDataSource.reportingExpandedPaginationWindow) {
+        [self insertSectionsForExpandedPaginationWindow];
+        [self.conversationDataSource didFinishExpandingPaginationWindow];
         return;
     }
     
@@ -1207,37 +1590,37 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     // Prevent scrolling if user has scrolled up into the conversation history.
     BOOL shouldScrollToBottom = [self shouldScrollToBottom];
     
+    // Merge the changes into a single compact batch; a burst of incoming messages becomes one insertion.
+    ATLDataSourceChangeSet *changeSet = [ATLDataSourceChangeSet changeSetWithChanges:objectChanges];
+    NSIndexSet *sectionsWithChangedFlags = [self applyChangeSetToSectionMetadata:changeSet];
+    
+    // Besides the updated messages, only the sections whose date, sender, cluster, avatar or read receipt state changed need to be reconfigured.
+    NSMutableIndexSet *sectionsToConfigure = [changeSet.updatedSections mutableCopy];
+    [sectionsToConfigure addIndexes:sectionsWithChangedFlags ?: changeSet.neighbouringSections];
+    
     // ensure the animation's queue will resume
     if (self.collectionView) {
         dispatch_suspend(self.animationQueue);
         [self.collectionView performBatchUpdates:^{
-            for (ATLDataSourceChange *change in objectChanges) {
-                switch (change.type) {
-                    case LYRQueryControllerChangeTypeInsert:
-                        [self.collectionView insertSections:[NSIndexSet indexSetWithIndex:change.newIndex]];
-                        break;
-                        
-                    case LYRQueryControllerChangeTypeMove:
-                        [self.collectionView moveSection:change.currentIndex toSection:change.newIndex];
-                        break;
-                        
-                    case LYRQueryControllerChangeTypeDelete:
-                        [self.collectionView deleteSections:[NSIndexSet indexSetWithIndex:change.currentIndex]];
-                        break;
-                        
-                    case LYRQueryControllerChangeTypeUpdate:
-                        // If we call reloadSections: for a section that is already being animated due to another move (e.g. moving section 17 to 16 causes section 16 to be moved/animated to 17 and then we also reload section 16), UICollectionView will throw an exception. But since all onscreen sections will be reconfigured (see below) we don't need to reload the sections here anyway.
-                        break;
-                        
-                    default:
-                        break;
-                }
+            if (changeSet.deletedSections.count) {
+                [self.collectionView deleteSections:changeSet.deletedSections];
+            }
+            if (changeSet.insertedSections.count) {
+                [self.collectionView insertSections:changeSet.insertedSections];
+            }
+            for (ATLDataSourceChange *move in changeSet.moves) {
+                [self.collectionView moveSection:move.currentIndex toSection:move.newIndex];
+            }
+            // Updated sections aren't reloaded, since UICollectionView throws when a section is both moved and reloaded. They are only measured again and reconfigured below,
+            // along with the sections whose headers and footers gained or lost a label.
+            if ([self.collectionView.collectionViewLayout isKindOfClass:[ATLConversationCollectionViewLayout class]]) {
+                [(ATLConversationCollectionViewLayout *)self.collectionView.collectionViewLayout invalidateLayoutForSections:sectionsToConfigure];
             }
         } completion:^(BOOL finished) {
             dispatch_resume(self.animationQueue);
         }];
     }
-    [self configureCollectionViewElements];
+    [self configureCollectionViewElementsInSections:sectionsToConfigure];
     
     if (shouldScrollToBottom)  {
         // We can't get the content size from the collection view because it will be out-of-date due to the above updates, but we can get the update-to-date size from the layout.
@@ -1249,28 +1632,39 @@ static NSInteger const ATLPhotoActionSheet = 1000;
     }
 }
 
-- (void)configureCollectionViewElements
+- (void)removeView:(UICollectionReusableView *)view forMessage:(LYRMessage *)message fromMapTable:(NSMapTable *)mapTable
 {
-    // Since each section's content depends on other messages, we need to update each visible section even when a section's corresponding message has not changed. This also solves the issue with LYRQueryControllerChangeTypeUpdate (see above).
-    for (UICollectionViewCell<ATLMessagePresenting> *cell in [self.collectionView visibleCells]) {
-        NSIndexPath *indexPath = [self.collectionView indexPathForCell:cell];
-        LYRMessage *message = [self.conversationDataSource messageAtCollectionViewIndexPath:indexPath];
-        [self configureCell:cell forMessage:message indexPath:indexPath];
+    // The view may already have been registered again under the message by a newer dequeue.
+    if (message.identifier && [mapTable objectForKey:message.identifier] == view) {
+        [mapTable removeObjectForKey:message.identifier];
     }
-    
-    for (ATLConversationCollectionViewHeader *header in self.sectionHeaders) {
-        NSIndexPath *queryControllerIndexPath = [self.conversationDataSource.queryController indexPathForObject:header.message];
-        if (!queryControllerIndexPath) continue;
-        NSIndexPath *collectionViewIndexPath = [self.conversationDataSource collectionViewIndexPathForQueryControllerIndexPath:queryControllerIndexPath];
-        [self configureHeader:header atIndexPath:collectionViewIndexPath];
-    }
-    
-    for (ATLConversationCollectionViewFooter *footer in self.sectionFooters) {
-        NSIndexPath *queryControllerIndexPath = [self.conversationDataSource.queryController indexPathForObject:footer.message];
-        if (!queryControllerIndexPath) continue;
-        NSIndexPath *collectionViewIndexPath = [self.conversationDataSource collectionViewIndexPathForQueryControllerIndexPath:queryControllerIndexPath];
-        [self configureFooter:footer atIndexPath:collectionViewIndexPath];
+}
+
+- (NSRange)visibleSectionRange
+{
+    NSArray *layoutAttributes = [self.collectionView.collectionViewLayout layoutAttributesForElementsInRect:self.collectionView.bounds];
+    NSInteger firstSection = NSIntegerMax;
+    NSInteger lastSection = -1;
+    for (UICollectionViewLayoutAttributes *attributes in layoutAttributes) {
+        firstSection = MIN(firstSection, attributes.indexPath.section);
+        lastSection = MAX(lastSection, attributes.indexPath.section);
     }
+    if (lastSection < 0) return NSMakeRange(0, 0);
+    return NSMakeRange(firstSection, lastSection - firstSection + 1);
+}
+
+- (void)configureCollectionViewElementsInSections:(NSIndexSet *)sections
+{
+    // Each section's content depends on its neighbours, so the change set also lists the sections next to the changed ones. Sections which aren't on screen are configured when they are dequeued.
+    NSInteger numberOfSections = [self.collectionView numberOfSections];
+    [sections enumerateIndexesUsingBlock:^(NSUInteger section, BOOL *stop) {
+        if ((NSInteger)section < ATLNumberOfSectionsBeforeFirstMessageSection) return;
+        if ((NSInteger)section >= numberOfSections) {
+            *stop = YES;
+            return;
+        }
+        [self configureCollectionViewElementsAtCollectionViewIndexPath:[NSIndexPath indexPathForItem:0 inSection:section]];
+    }];
 }
 
 - (void)configureCollectionViewElementsAtCollectionViewIndexPath:(NSIndexPath *)collectionViewIndexPath {
@@ -1281,24 +1675,15 @@ static NSInteger const ATLPhotoActionSheet = 1000;
         [self configureCell:(UICollectionViewCell<ATLMessagePresenting> *)cell forMessage:message indexPath:collectionViewIndexPath];
     }
     
-    // Find the header...
-    for (ATLConversationCollectionViewHeader *header in self.sectionHeaders) {
-        NSIndexPath *queryControllerIndexPath = [self.conversationDataSource.queryController indexPathForObject:header.message];
-        if (queryControllerIndexPath && [header.message.identifier isEqual:message.identifier]) {
-            NSIndexPath *collectionViewIndexPath = [self.conversationDataSource collectionViewIndexPathForQueryControllerIndexPath:queryControllerIndexPath];
-            [self configureHeader:header atIndexPath:collectionViewIndexPath];
-            break;
-        }
+    // Headers and footers are registered under their message when dequeued, so finding them doesn't involve the query controller.
+    if (!message.identifier) return;
+    ATLConversationCollectionViewHeader *header = [self.sectionHeadersByMessageIdentifier objectForKey:message.identifier];
+    if (header) {
+        [self configureHeader:header atIndexPath:collectionViewIndexPath];
     }
-    
-    // ...and the footer
-    for (ATLConversationCollectionViewFooter *footer in self.sectionFooters) {
-        NSIndexPath *queryControllerIndexPath = [self.conversationDataSource.queryController indexPathForObject:footer.message];
-        if (queryControllerIndexPath && [footer.message.identifier isEqual:message.identifier]) {
-            NSIndexPath *collectionViewIndexPath = [self.conversationDataSource collectionViewIndexPathForQueryControllerIndexPath:queryControllerIndexPath];
-            [self configureFooter:footer atIndexPath:collectionViewIndexPath];
-            break;
-        }
+    ATLConversationCollectionViewFooter *footer = [self.sectionFootersByMessageIdentifier objectForKey:message.identifier];
+    if (footer) {
+        [self configureFooter:footer atIndexPath:collectionViewIndexPath];
     }
 }
 
@@ -1330,14 +1715,50 @@ static NSInteger const ATLPhotoActionSheet = 1000;
 {
     NSString *participantName;
     if (message.sender.userID) {
+        participantName = [self.labelCache participantNameForUserID:message.sender.userID];
+        if (participantName) return participantName;
         id<ATLParticipant> participant = [self participantForIdentity:message.sender];
-        participantName = participant.displayName ?: ATLLocalizedString(@"atl.conversation.participant.unknown.key", @"Unknown User", nil);
+        if (participant.displayName) {
+            participantName = participant.displayName;
+            [self.labelCache setParticipantName:participantName forUserID:message.sender.userID];
+        } else {
+            participantName = ATLLocalizedString(@"atl.conversation.participant.unknown.key", @"Unknown User", nil);
+        }
     } else {
         participantName = message.sender.displayName;
     }
     return participantName;
 }
 
+- (void)prepareLayoutsForMessages:(NSArray *)messages completion:(void (^)(void))completion
+{
+    NSMutableArray *outgoingMessages = [NSMutableArray new];
+    NSMutableArray *incomingMessages = [NSMutableArray new];
+    for (LYRMessage *message in messages) {
+        if ([message.sender.userID isEqualToString:self.layerClient.authenticatedUser.userID]) {
+            [outgoingMessages addObject:message];
+        } else {
+            [incomingMessages addObject:message];
+        }
+    }
+    dispatch_group_t group = dispatch_group_create();
+    if (outgoingMessages.count) {
+        dispatch_group_enter(group);
+        [ATLOutgoingMessageCollectionViewCell prepareLayoutsForMessages:outgoingMessages inView:self.view completion:^{
+            dispatch_group_leave(group);
+        }];
+    }
+    if (incomingMessages.count) {
+        dispatch_group_enter(group);
+        [ATLIncomingMessageCollectionViewCell prepareLayoutsForMessages:incomingMessages inView:self.view completion:^{
+            dispatch_group_leave(group);
+        }];
+    }
+    if (completion) {
+        dispatch_group_notify(group, dispatch_get_main_queue(), completion);
+    }
+}
+
 #pragma mark - NSNotification Center Registration
 
 - (void)atl_registerForNotifications
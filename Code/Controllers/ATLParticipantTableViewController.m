@@ -32,6 +32,7 @@ static NSString *const ATLParticipantCellIdentifier = @"ATLParticipantCellIdenti
 
 @property (nonatomic) ATLParticipantTableDataSet *unfilteredDataSet;
 @property (nonatomic) ATLParticipantTableDataSet *filteredDataSet;
+@property (nonatomic) ATLParticipantTableDataSetBuilder *dataSetBuilder;
 @property (nonatomic) NSMutableSet *selectedParticipants;
 @property (nonatomic) UISearchBar *searchBar;
 @property (nonatomic) BOOL hasAppeared;
@@ -125,7 +126,9 @@ NSString *const ATLParticipantTableViewControllerTitle = @"Participants";
         self.tableView.rowHeight = self.rowHeight;
         self.tableView.allowsMultipleSelection = self.allowsMultipleSelection;
         [self.tableView registerClass:self.cellClass forCellReuseIdentifier:ATLParticipantCellIdentifier];
-        self.unfilteredDataSet = [ATLParticipantTableDataSet dataSetWithParticipants:self.participants sortType:self.sortType];
+        // Search results are built from the same participants, so they reuse the sort keys computed here.
+        self.dataSetBuilder = [[ATLParticipantTableDataSetBuilder alloc] initWithSortType:self.sortType];
+        self.unfilteredDataSet = [self.dataSetBuilder dataSetWithParticipants:self.participants];
         [self.tableView reloadData];
     }
 }
@@ -196,7 +199,7 @@ NSString *const ATLParticipantTableViewControllerTitle = @"Participants";
 {
     [self.delegate participantTableViewController:self didSearchWithString:searchString completion:^(NSSet *filteredParticipants) {
         if (![searchString isEqualToString:controller.searchBar.text]) return;
-        self.filteredDataSet = [ATLParticipantTableDataSet dataSetWithParticipants:filteredParticipants sortType:self.sortType];
+        self.filteredDataSet = [self.dataSetBuilder dataSetWithParticipants:filteredParticipants];
         UITableView *tableView = controller.searchResultsTableView;
         [tableView reloadData];
         for (id<ATLParticipant> participant in self.selectedParticipants) {
@@ -24,6 +24,39 @@
 extern NSInteger const ATLNumberOfSectionsBeforeFirstMessageSection;
 
 NS_ASSUME_NONNULL_BEGIN
+
+@class ATLConversationDataSource;
+
+/**
+ @abstract The `ATLConversationDataSourceDelegate` protocol lets the receiver get ready for a page of
+ history before it is displayed.
+ */
+@protocol ATLConversationDataSourceDelegate <NSObject>
+
+@optional
+
+/**
+ @abstract Tells the delegate that the pagination window is about to grow to include `messages`.
+ @discussion The window isn't changed until `completion` is called, which gives the delegate a chance to
+ measure the incoming messages off the main thread, so that displaying them is cheap. The messages are fetched
+ on a background queue, so this is called on the main thread some time after the expansion started.
+ @param dataSource The data source expanding its pagination window.
+ @param messages The messages that will be added to the front of the window, in query order.
+ @param completion Must be called on the main thread once the delegate is ready for the messages.
+ */
+- (void)conversationDataSource:(ATLConversationDataSource *)dataSource willExpandPaginationWindowWithMessages:(NSArray <LYRMessage *> *)messages completion:(void (^)(void))completion;
+
+/**
+ @abstract Tells the delegate that the data source replaced its `queryController` to move a bounded pagination window.
+ @discussion The new query controller keeps the delegate of the previous one. Its contents can't be expressed as a change of the
+ previous contents, so anything displaying them has to be reloaded.
+ @param dataSource The data source whose query controller was replaced.
+ @param previousQueryController The query controller that was replaced. It still holds the messages previously displayed.
+ */
+- (void)conversationDataSource:(ATLConversationDataSource *)dataSource didReplaceQueryController:(LYRQueryController *)previousQueryController;
+
+@end
+
 /**
  @abstract The `ATLConversationDataSource` manages an `LYRQueryController` object whose data is displayed in an
  `ATLConversationViewController`. The `ATLConversationDataSource` also provides convenience methods for the translation 
@@ -46,6 +79,38 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (instancetype)dataSourceWithLayerClient:(LYRClient *)layerClient query:(LYRQuery *)query;
 
+/**
+ @abstract Creates and returns an `ATLConversationDataSource` object whose pagination window is centered on a message.
+ @discussion The window holds a page of messages on each side of the anchor, however far back the anchor is. Older messages
+ are loaded with `expandPaginationWindow` and newer ones with `expandPaginationWindowTowardsNewerMessages`, independently of
+ each other. Until the newest message is loaded, `newerMessagesAvailable` is `YES`.
+ @param layerClient An `LYRClient` object used to initialize the `queryController` property.
+ @param query An `LYRQuery` object used as the query for the `queryController` property. Must sort messages by ascending position.
+ @param anchorMessage The message to center the window on, such as the first unread message or a search result.
+ @return An `ATLConversationDataSource` object.
+ */
++ (instancetype)dataSourceWithLayerClient:(LYRClient *)layerClient query:(LYRQuery *)query anchorMessage:(LYRMessage *)anchorMessage;
+
+/**
+ @abstract Creates and returns an `ATLConversationDataSource` object whose pagination window is centered on a position in the conversation.
+ @param layerClient An `LYRClient` object used to initialize the `queryController` property.
+ @param query An `LYRQuery` object used as the query for the `queryController` property. Must sort messages by ascending position.
+ @param anchorPosition The position of the message to center the window on. See the `position` property of `LYRMessage`.
+ @return An `ATLConversationDataSource` object.
+ */
++ (instancetype)dataSourceWithLayerClient:(LYRClient *)layerClient query:(LYRQuery *)query anchorPosition:(LYRPosition)anchorPosition;
+
+/**
+ @abstract Creates an `ATLConversationDataSource` object without blocking the calling thread.
+ @discussion Counting the messages and executing the `queryController` happen on a background queue. The query controller's
+ delegate should be set in the completion block, before any changes are delivered.
+ @param layerClient An `LYRClient` object used to initialize the `queryController` property.
+ @param query An `LYRQuery` object used as the query for the `queryController` property.
+ @param anchorMessage The message to center the window on, or `nil` to load the newest messages.
+ @param completion The block called on the main queue with the data source, or `nil` if the query controller couldn't be created.
+ */
++ (void)loadDataSourceWithLayerClient:(LYRClient *)layerClient query:(LYRQuery *)query anchorMessage:(nullable LYRMessage *)anchorMessage completion:(void (^)(ATLConversationDataSource *_Nullable dataSource))completion;
+
 /**
  @abstract The `LYRQueryController` object managing data displayed in the `ATLConversationViewController`.
  @discussion The `queryController` is hydrated with messages belonging to the `LYRConversation` object
@@ -53,6 +118,11 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) LYRQueryController *queryController;
 
+/**
+ @abstract The object notified before the pagination window grows.
+ */
+@property (nonatomic, weak, nullable) id<ATLConversationDataSourceDelegate> delegate;
+
 ///---------------------------------------
 /// @name Pagination
 ///---------------------------------------
@@ -64,11 +134,110 @@ NS_ASSUME_NONNULL_BEGIN
 - (BOOL)moreMessagesAvailable;
 
 /**
- @abstract Expands the pagination window of the `queryController` by the `paginationWindow` property if
+ @abstract Expands the pagination window of the `queryController` by the `minimumPaginationWindowExpansion` property if
  more messages are available for display.
  */
 - (void)expandPaginationWindow;
 
+/**
+ @abstract Expands the pagination window by enough messages to cover the distance scrolled during `paginationLookaheadInterval`.
+ @discussion The number of messages is derived from the scroll velocity and the average height of a message, and clamped
+ between `minimumPaginationWindowExpansion` and `maximumPaginationWindowExpansion`. Does nothing if an expansion is already
+ in progress or no more messages are available.
+ @param velocity The speed at which the user scrolls towards older messages, in points per second.
+ @param averageMessageHeight The average height of the displayed messages, in points.
+ */
+- (void)expandPaginationWindowWithScrollVelocity:(CGFloat)velocity averageMessageHeight:(CGFloat)averageMessageHeight;
+
+/**
+ @abstract Returns the distance from the top of the displayed messages at which the next expansion should start.
+ @discussion Scrolling faster starts the expansion further ahead, so the messages are available by the time the user reaches them.
+ @param velocity The speed at which the user scrolls towards older messages, in points per second.
+ */
+- (CGFloat)paginationTriggerDistanceForScrollVelocity:(CGFloat)velocity;
+
+/**
+ @abstract `YES` from the start of an expansion until the new messages have been handled, including while more messages are
+ synchronized or the new page is fetched. No other expansion starts in the meantime.
+ */
+@property (nonatomic, readonly) BOOL expandingPaginationWindow;
+
+/**
+ @abstract `YES` while the changes the `queryController` reports are the messages added by an expansion.
+ @discussion Set right before the pagination window grows, and until `didFinishExpandingPaginationWindow` is called. Changes
+ reported while an expansion waits for messages aren't part of the new page, so they are handled as usual.
+ */
+@property (nonatomic, readonly) BOOL reportingExpandedPaginationWindow;
+
+/**
+ @abstract Tells the receiver that the delegate of the `queryController` has handled the messages added by an expansion.
+ @discussion Call it from `queryControllerDidChangeContent:` when `reportingExpandedPaginationWindow` is `YES`, after updating
+ the collection view. It sets both `reportingExpandedPaginationWindow` and `expandingPaginationWindow` back to `NO`.
+ */
+- (void)didFinishExpandingPaginationWindow;
+
+/**
+ @abstract The smallest number of messages added to the pagination window at once. Default is 10.
+ */
+@property (nonatomic) NSUInteger minimumPaginationWindowExpansion;
+
+/**
+ @abstract The largest number of messages added to the pagination window at once. Default is 100.
+ */
+@property (nonatomic) NSUInteger maximumPaginationWindowExpansion;
+
+/**
+ @abstract The scrolling time an expansion should cover at the current scroll velocity. Default is 1 second.
+ */
+@property (nonatomic) NSTimeInterval paginationLookaheadInterval;
+
+/**
+ @abstract The distance from the top at which an expansion starts when the user doesn't scroll. Default is 200 points.
+ */
+@property (nonatomic) CGFloat minimumPaginationTriggerDistance;
+
+/**
+ @abstract The maximum number of messages kept in the pagination window. Default is 0, meaning the window grows without limit.
+ @discussion When the window holds more messages than this, `trimPaginationWindowAroundQueryControllerRow:` drops the messages
+ furthest from the given row. Dropping the newest messages replaces the `queryController` with one limited to older messages,
+ and `newerMessagesAvailable` becomes `YES` until they are brought back by `expandPaginationWindowTowardsNewerMessages`.
+ */
+@property (nonatomic) NSUInteger maximumNumberOfMessagesInPaginationWindow;
+
+/**
+ @abstract `YES` if newer messages were dropped from the pagination window.
+ */
+@property (nonatomic, readonly) BOOL newerMessagesAvailable;
+
+/**
+ @abstract Drops the messages furthest from a row so that the window holds no more than `maximumNumberOfMessagesInPaginationWindow` messages.
+ @discussion Dropping the oldest messages shrinks the window, which the `queryController` reports as deletions. Dropping the newest
+ messages replaces the `queryController`, see `conversationDataSource:didReplaceQueryController:`. The new query controller is built
+ and executed on a background queue, and no expansion starts until it has replaced the current one.
+ @param row The `queryController` row to keep the window centered on, typically the one in the middle of the screen.
+ */
+- (void)trimPaginationWindowAroundQueryControllerRow:(NSUInteger)row;
+
+/**
+ @abstract Brings back `maximumPaginationWindowExpansion` of the newer messages dropped from the pagination window, or half of
+ `maximumNumberOfMessagesInPaginationWindow` if that is fewer.
+ @discussion Replaces the `queryController`, see `conversationDataSource:didReplaceQueryController:`. The new query controller is
+ built and executed on a background queue, and `expandingPaginationWindow` is `YES` until it has replaced the current one.
+ */
+- (void)expandPaginationWindowTowardsNewerMessages;
+
+/**
+ @abstract Moves the pagination window back to the newest messages, dropping the others, if newer messages aren't loaded.
+ @discussion Replaces the `queryController` right away, see `conversationDataSource:didReplaceQueryController:`, and cancels
+ an expansion towards newer messages that is still underway.
+ */
+- (void)movePaginationWindowToNewestMessages;
+
+/**
+ @abstract Whether messages are synchronized from the server ahead of time, once fewer messages are left locally than the last expansion used. Default is `YES`.
+ */
+@property (nonatomic) BOOL prefetchesRemoteMessages;
+
 ///---------------------------------------
 /// @name Index Translation Methods
 ///---------------------------------------
@@ -42,11 +42,71 @@ LYRConversation *LYRConversationDataSourceConversationFromPredicate(LYRPredicate
     return conversation;
 }
 
+/**
+ @abstract Returns a copy of a message query further limited to the messages whose position compares to `position`.
+ */
+static LYRQuery *ATLMessageQueryWithPosition(LYRQuery *query, LYRPredicateOperator predicateOperator, NSNumber *position)
+{
+    LYRQuery *positionQuery = [query copy];
+    LYRPredicate *positionPredicate = [LYRPredicate predicateWithProperty:@"position" predicateOperator:predicateOperator value:position];
+    if (positionQuery.predicate) {
+        positionQuery.predicate = [LYRCompoundPredicate compoundPredicateWithType:LYRCompoundPredicateTypeAnd subpredicates:@[positionQuery.predicate, positionPredicate]];
+    } else {
+        positionQuery.predicate = positionPredicate;
+    }
+    return positionQuery;
+}
+
+/**
+ @abstract Creates and executes a query controller whose pagination window holds the last `numberOfMessages` messages of `query`.
+ @discussion Doesn't touch any state of the data source, so it can run on the load queue.
+ */
+static LYRQueryController *ATLExecutedQueryController(LYRClient *layerClient, LYRQuery *query, NSSet *updatableProperties, NSUInteger numberOfMessages)
+{
+    NSError *error;
+    LYRQueryController *queryController = [layerClient queryControllerWithQuery:query error:&error];
+    if (!queryController) {
+        NSLog(@"LayerKit failed to create a query controller with error: %@", error);
+        return nil;
+    }
+    queryController.updatableProperties = updatableProperties;
+    queryController.paginationWindow = -(NSInteger)MAX(numberOfMessages, 1);
+    if (![queryController execute:&error]) {
+        NSLog(@"LayerKit failed to execute query with error: %@", error);
+        return nil;
+    }
+    return queryController;
+}
+
+/**
+ @abstract Creates and executes a query controller for the messages of `query` up to `newestPosition`, and counts the messages after it.
+ @discussion Without a `newestPosition`, the query controller follows the newest message. Can run on the load queue as well.
+ */
+static LYRQueryController *ATLExecutedQueryControllerEndingAtPosition(LYRClient *layerClient, LYRQuery *query, NSNumber *newestPosition, NSSet *updatableProperties, NSUInteger numberOfMessages, NSUInteger *numberOfNewerMessages)
+{
+    *numberOfNewerMessages = 0;
+    LYRQuery *windowQuery = newestPosition ? ATLMessageQueryWithPosition(query, LYRPredicateOperatorIsLessThanOrEqualTo, newestPosition) : query;
+    LYRQueryController *queryController = ATLExecutedQueryController(layerClient, windowQuery, updatableProperties, numberOfMessages);
+    if (queryController && newestPosition) {
+        *numberOfNewerMessages = [layerClient countForQuery:ATLMessageQueryWithPosition(query, LYRPredicateOperatorIsGreaterThan, newestPosition) error:nil];
+    }
+    return queryController;
+}
+
 @interface ATLConversationDataSource ()
 
 @property (nonatomic, readwrite) LYRQueryController *queryController;
 @property (nonatomic, readwrite) BOOL expandingPaginationWindow;
+@property (nonatomic, readwrite) BOOL reportingExpandedPaginationWindow;
 @property (nonatomic, readwrite) LYRConversation *conversation;
+@property (nonatomic) LYRClient *layerClient;
+@property (nonatomic) LYRQuery *query;
+@property (nonatomic) BOOL synchronizingMessages;
+@property (nonatomic) NSMutableArray *synchronizationCompletions;
+@property (nonatomic) NSNumber *newestPosition;
+@property (nonatomic) NSUInteger numberOfNewerMessages;
+@property (nonatomic) BOOL replacingQueryController;
+@property (nonatomic) NSUInteger numberOfQueryControllerReplacements;
 
 @end
 
@@ -54,21 +114,90 @@ LYRConversation *LYRConversationDataSourceConversationFromPredicate(LYRPredicate
 
 NSInteger const ATLNumberOfSectionsBeforeFirstMessageSection = 1;
 NSInteger const ATLQueryControllerPaginationWindow = 10;
+NSInteger const ATLQueryControllerMaximumPaginationWindowExpansion = 100;
+static char const ATLConversationDataSourceLoadQueueName[] = "com.layer.Atlas.ATLConversationDataSource.loadQueue";
+
+static dispatch_queue_t ATLConversationDataSourceLoadQueue(void)
+{
+    static dispatch_queue_t loadQueue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        loadQueue = dispatch_queue_create(ATLConversationDataSourceLoadQueueName, DISPATCH_QUEUE_SERIAL);
+    });
+    return loadQueue;
+}
 
 + (instancetype)dataSourceWithLayerClient:(LYRClient *)layerClient query:(LYRQuery *)query
 {
     return [[self alloc] initWithLayerClient:layerClient query:query];
 }
 
++ (instancetype)dataSourceWithLayerClient:(LYRClient *)layerClient query:(LYRQuery *)query anchorMessage:(LYRMessage *)anchorMessage
+{
+    return [[self alloc] initWithLayerClient:layerClient query:query anchorPosition:@(anchorMessage.position)];
+}
+
++ (instancetype)dataSourceWithLayerClient:(LYRClient *)layerClient query:(LYRQuery *)query anchorPosition:(LYRPosition)anchorPosition
+{
+    return [[self alloc] initWithLayerClient:layerClient query:query anchorPosition:@(anchorPosition)];
+}
+
++ (void)loadDataSourceWithLayerClient:(LYRClient *)layerClient query:(LYRQuery *)query anchorMessage:(LYRMessage *)anchorMessage completion:(void (^)(ATLConversationDataSource *dataSource))completion
+{
+    // Read on the calling thread, as the message may not be safe to access from the load queue.
+    NSNumber *anchorPosition = anchorMessage ? @(anchorMessage.position) : nil;
+    dispatch_async(ATLConversationDataSourceLoadQueue(), ^{
+        ATLConversationDataSource *dataSource = [[self alloc] initWithLayerClient:layerClient query:query anchorPosition:anchorPosition];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(dataSource);
+        });
+    });
+}
+
 - (id)initWithLayerClient:(LYRClient *)layerClient query:(LYRQuery *)query
+{
+    return [self initWithLayerClient:layerClient query:query anchorPosition:nil];
+}
+
+- (id)initWithLayerClient:(LYRClient *)layerClient query:(LYRQuery *)query anchorPosition:(NSNumber *)anchorPosition
 {
     self = [super init];
     if (self) {
-        NSUInteger numberOfMessagesAvailable = [layerClient countForQuery:query error:nil];
-        NSUInteger numberOfMessagesToDisplay = MIN(numberOfMessagesAvailable, ATLQueryControllerPaginationWindow);
-    
+        self.conversation = LYRConversationDataSourceConversationFromPredicate(query.predicate);
+        self.layerClient = layerClient;
+        self.query = query;
+        
+        _minimumPaginationWindowExpansion = ATLQueryControllerPaginationWindow;
+        _maximumPaginationWindowExpansion = ATLQueryControllerMaximumPaginationWindowExpansion;
+        _paginationLookaheadInterval = 1.0;
+        _minimumPaginationTriggerDistance = 200;
+        _prefetchesRemoteMessages = YES;
+        _synchronizationCompletions = [NSMutableArray new];
+        
+        NSUInteger numberOfMessagesToDisplay;
+        NSNumber *newestPosition;
+        if (anchorPosition) {
+            // Load a page on each side of the anchor. Only two indexed queries are run, however far back the anchor is.
+            // One message more than a page is fetched, as the window only stops short of the newest message if there is one after the page.
+            LYRQuery *newerMessagesQuery = [self queryForMessagesWithPositionOperator:LYRPredicateOperatorIsGreaterThan position:anchorPosition];
+            newerMessagesQuery.limit = ATLQueryControllerPaginationWindow + 1;
+            NSOrderedSet *newerMessages = [layerClient executeQuery:newerMessagesQuery error:nil];
+            NSUInteger numberOfNewerMessagesToDisplay = MIN(newerMessages.count, (NSUInteger)ATLQueryControllerPaginationWindow);
+            if (newerMessages.count > ATLQueryControllerPaginationWindow) {
+                newestPosition = @([(LYRMessage *)newerMessages[ATLQueryControllerPaginationWindow - 1] position]);
+            }
+            LYRQuery *olderMessagesQuery = [self queryForMessagesWithPositionOperator:LYRPredicateOperatorIsLessThanOrEqualTo position:anchorPosition];
+            NSUInteger numberOfOlderMessages = [layerClient countForQuery:olderMessagesQuery error:nil];
+            numberOfMessagesToDisplay = MIN(numberOfOlderMessages, ATLQueryControllerPaginationWindow + 1) + numberOfNewerMessagesToDisplay;
+        } else {
+            NSUInteger numberOfMessagesAvailable = [layerClient countForQuery:query error:nil];
+            numberOfMessagesToDisplay = MIN(numberOfMessagesAvailable, ATLQueryControllerPaginationWindow);
+        }
+        
+        // The window counts back from the newest message the query includes, so an anchored window ends a page after the anchor.
+        LYRQuery *windowQuery = newestPosition ? [self queryForMessagesWithPositionOperator:LYRPredicateOperatorIsLessThanOrEqualTo position:newestPosition] : query;
         NSError *error = nil;
-        _queryController = [layerClient queryControllerWithQuery:query error:&error];
+        _queryController = [layerClient queryControllerWithQuery:windowQuery error:&error];
         if (!_queryController) {
             NSLog(@"LayerKit failed to create a query controller with error: %@", error);
             return nil;
@@ -76,7 +205,11 @@ NSInteger const ATLQueryControllerPaginationWindow = 10;
         _queryController.updatableProperties = [NSSet setWithObjects:@"parts.transferStatus", @"recipientStatusByUserID", @"sentAt", nil];
         _queryController.paginationWindow = numberOfMessagesToDisplay == 0 ? 1 : -numberOfMessagesToDisplay;
         
-        self.conversation = LYRConversationDataSourceConversationFromPredicate(query.predicate);
+        _newestPosition = newestPosition;
+        if (newestPosition) {
+            LYRQuery *newerMessagesQuery = [self queryForMessagesWithPositionOperator:LYRPredicateOperatorIsGreaterThan position:newestPosition];
+            _numberOfNewerMessages = [layerClient countForQuery:newerMessagesQuery error:nil];
+        }
         
         BOOL success = [_queryController execute:&error];
         if (!success) NSLog(@"LayerKit failed to execute query with error: %@", error);
@@ -86,52 +219,160 @@ NSInteger const ATLQueryControllerPaginationWindow = 10;
 
 - (void)expandPaginationWindow
 {
+    [self expandPaginationWindowWithScrollVelocity:0 averageMessageHeight:0];
+}
+
+- (void)expandPaginationWindowWithScrollVelocity:(CGFloat)velocity averageMessageHeight:(CGFloat)averageMessageHeight
+{
+    if (self.expandingPaginationWindow || self.replacingQueryController) return;
+    if (!self.queryController) return;
+    if (![self moreMessagesAvailable]) return;
     self.expandingPaginationWindow = YES;
-    if (!self.queryController) {
-        self.expandingPaginationWindow = NO;
+    
+    NSUInteger numberOfMessagesToAdd = [self paginationWindowExpansionForScrollVelocity:velocity averageMessageHeight:averageMessageHeight];
+    NSUInteger messagesAvailableLocally = [self messagesAvailableLocally];
+    if (messagesAvailableLocally == 0) {
+        // Nothing left to show until the server sends more, so the expansion waits for the synchronization.
+        __weak typeof(self) weakSelf = self;
+        [self requestToSynchronizeMoreMessages:numberOfMessagesToAdd completion:^{
+            [weakSelf finishExpandingPaginationWindowByAddingMessages:numberOfMessagesToAdd];
+        }];
         return;
     }
     
-    if (![self moreMessagesAvailable]) {
-        self.expandingPaginationWindow = NO;
+    // Show what is available locally right away, and if that drains the local messages fetch the next page in the background.
+    numberOfMessagesToAdd = MIN(numberOfMessagesToAdd, messagesAvailableLocally);
+    if (self.prefetchesRemoteMessages && messagesAvailableLocally - numberOfMessagesToAdd < numberOfMessagesToAdd && [self messagesAvailableRemotely] > messagesAvailableLocally) {
+        [self requestToSynchronizeMoreMessages:numberOfMessagesToAdd completion:nil];
+    }
+    [self finishExpandingPaginationWindowByAddingMessages:numberOfMessagesToAdd];
+}
+
+- (NSUInteger)paginationWindowExpansionForScrollVelocity:(CGFloat)velocity averageMessageHeight:(CGFloat)averageMessageHeight
+{
+    NSUInteger minimumExpansion = MAX(self.minimumPaginationWindowExpansion, 1);
+    NSUInteger maximumExpansion = MAX(self.maximumPaginationWindowExpansion, minimumExpansion);
+    if (velocity <= 0 || averageMessageHeight <= 0) {
+        return minimumExpansion;
+    }
+    CGFloat distance = velocity * self.paginationLookaheadInterval;
+    NSUInteger expansion = (NSUInteger)ceil(distance / averageMessageHeight);
+    return MIN(MAX(expansion, minimumExpansion), maximumExpansion);
+}
+
+- (CGFloat)paginationTriggerDistanceForScrollVelocity:(CGFloat)velocity
+{
+    return MAX(self.minimumPaginationTriggerDistance, velocity * self.paginationLookaheadInterval);
+}
+
+- (void)finishExpandingPaginationWindowByAddingMessages:(NSUInteger)numberOfMessagesToAdd
+{
+    NSUInteger numberOfMessagesDisplayed = ABS(self.queryController.paginationWindow);
+    NSUInteger numberOfMessagesToDisplay = MIN(numberOfMessagesDisplayed + numberOfMessagesToAdd, self.queryController.totalNumberOfObjects);
+    if (numberOfMessagesToDisplay <= numberOfMessagesDisplayed || ![self.delegate respondsToSelector:@selector(conversationDataSource:willExpandPaginationWindowWithMessages:completion:)]) {
+        [self applyPaginationWindowDisplayingMessages:numberOfMessagesToDisplay];
         return;
     }
+    
+    // Hand the page that's about to come in to the delegate first, so it can lay it out ahead of time.
+    // The page is fetched on the load queue, so scrolling carries on while the query runs.
+    LYRQuery *query = [self queryForMessagesPrecedingPaginationWindowWithCount:numberOfMessagesToDisplay - numberOfMessagesDisplayed];
+    LYRClient *layerClient = self.layerClient;
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(ATLConversationDataSourceLoadQueue(), ^{
+        NSArray *messages = @[];
+        if (query) {
+            NSError *error;
+            NSOrderedSet *result = [layerClient executeQuery:query error:&error];
+            if (!result) NSLog(@"LayerKit failed to execute query with error: %@", error);
+            messages = result.array ?: @[];
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [weakSelf expandPaginationWindowDisplayingMessages:numberOfMessagesToDisplay afterPreparingMessages:messages];
+        });
+    });
+}
 
-    int messagesAvailableLocally = (int)[self messagesAvailableLocally] - (int)ATLQueryControllerPaginationWindow;
-    if (messagesAvailableLocally <= 0) {
-        [self requestToSynchronizeMoreMessages:ABS(messagesAvailableLocally)];
-    } else {
-        [self finishExpandingPaginationWindow];
+- (void)expandPaginationWindowDisplayingMessages:(NSUInteger)numberOfMessagesToDisplay afterPreparingMessages:(NSArray *)messages
+{
+    if (![self.delegate respondsToSelector:@selector(conversationDataSource:willExpandPaginationWindowWithMessages:completion:)]) {
+        [self applyPaginationWindowDisplayingMessages:numberOfMessagesToDisplay];
+        return;
     }
+    __weak typeof(self) weakSelf = self;
+    [self.delegate conversationDataSource:self willExpandPaginationWindowWithMessages:messages completion:^{
+        [weakSelf applyPaginationWindowDisplayingMessages:numberOfMessagesToDisplay];
+    }];
 }
 
-- (void)finishExpandingPaginationWindow
+- (void)applyPaginationWindowDisplayingMessages:(NSUInteger)numberOfMessagesToDisplay
 {
-    NSUInteger numberOfMessagesToDisplay = MIN(-self.queryController.paginationWindow + ATLQueryControllerPaginationWindow, self.queryController.totalNumberOfObjects);
+    if (numberOfMessagesToDisplay == (NSUInteger)ABS(self.queryController.paginationWindow)) {
+        self.expandingPaginationWindow = NO;
+        return;
+    }
+    // Only the changes reported from here on are the new page; the delegate says when it has handled them.
+    self.reportingExpandedPaginationWindow = YES;
     self.queryController.paginationWindow = -numberOfMessagesToDisplay;
+}
+
+- (void)didFinishExpandingPaginationWindow
+{
+    if (!self.reportingExpandedPaginationWindow) return;
+    self.reportingExpandedPaginationWindow = NO;
     self.expandingPaginationWindow = NO;
 }
 
-- (void)requestToSynchronizeMoreMessages:(NSUInteger)numberOfMessagesToSynchronize
+- (LYRQuery *)queryForMessagesPrecedingPaginationWindowWithCount:(NSUInteger)count
+{
+    NSUInteger numberOfMessagesDisplayed = ABS(self.queryController.paginationWindow);
+    NSUInteger totalNumberOfMessages = self.queryController.totalNumberOfObjects;
+    if (!self.queryController.query || numberOfMessagesDisplayed + count > totalNumberOfMessages) {
+        return nil;
+    }
+    LYRQuery *query = [self.queryController.query copy];
+    query.offset = totalNumberOfMessages - numberOfMessagesDisplayed - count;
+    query.limit = count;
+    return query;
+}
+
+- (void)requestToSynchronizeMoreMessages:(NSUInteger)numberOfMessagesToSynchronize completion:(nullable void (^)(void))completion
 {
+    // A prefetch may already be on its way, in which case an expansion waiting for messages simply waits for it.
+    if (completion) {
+        [self.synchronizationCompletions addObject:[completion copy]];
+    }
+    if (self.synchronizingMessages) return;
+    self.synchronizingMessages = YES;
+    
     NSError *error;
     __weak typeof(self) weakSelf = self;
-    __block __weak id observer = [[NSNotificationCenter defaultCenter] addObserverForName:LYRConversationDidFinishSynchronizingNotification object:self.conversation queue:nil usingBlock:^(NSNotification * _Nonnull note) {
+    __block __weak id observer = [[NSNotificationCenter defaultCenter] addObserverForName:LYRConversationDidFinishSynchronizingNotification object:self.conversation queue:[NSOperationQueue mainQueue] usingBlock:^(NSNotification * _Nonnull note) {
         if (observer) {
             [[NSNotificationCenter defaultCenter] removeObserver:observer];
         }
-        [weakSelf finishExpandingPaginationWindow];
+        [weakSelf finishSynchronizingMessages];
     }];
     BOOL success = [self.conversation synchronizeMoreMessages:numberOfMessagesToSynchronize error:&error];
     if (!success) {
         if (observer) {
             [[NSNotificationCenter defaultCenter] removeObserver:observer];
         }
-        [weakSelf finishExpandingPaginationWindow];
+        [self finishSynchronizingMessages];
         return;
     }
 }
 
+- (void)finishSynchronizingMessages
+{
+    self.synchronizingMessages = NO;
+    NSArray *completions = [self.synchronizationCompletions copy];
+    [self.synchronizationCompletions removeAllObjects];
+    for (void (^completion)(void) in completions) {
+        completion();
+    }
+}
+
 - (BOOL)moreMessagesAvailable
 {
     return [self messagesAvailableLocally] != 0 || [self messagesAvailableRemotely] != 0;
@@ -144,7 +385,145 @@ NSInteger const ATLQueryControllerPaginationWindow = 10;
 
 - (NSUInteger)messagesAvailableRemotely
 {
-    return (NSUInteger)MAX((NSInteger)0, (NSInteger)self.conversation.totalNumberOfMessages - (NSInteger)ABS(self.queryController.count));
+    return (NSUInteger)MAX((NSInteger)0, (NSInteger)self.conversation.totalNumberOfMessages - (NSInteger)self.numberOfNewerMessages - (NSInteger)ABS(self.queryController.count));
+}
+
+#pragma mark - Sliding Window
+
+- (BOOL)newerMessagesAvailable
+{
+    return self.newestPosition != nil;
+}
+
+- (void)trimPaginationWindowAroundQueryControllerRow:(NSUInteger)row
+{
+    NSUInteger maximumNumberOfMessages = self.maximumNumberOfMessagesInPaginationWindow;
+    NSUInteger numberOfMessages = [self.queryController numberOfObjectsInSection:0];
+    if (maximumNumberOfMessages == 0 || numberOfMessages <= maximumNumberOfMessages) return;
+    if (self.expandingPaginationWindow || self.replacingQueryController) return;
+    
+    NSUInteger firstRow = row > maximumNumberOfMessages / 2 ? row - maximumNumberOfMessages / 2 : 0;
+    NSUInteger lastRow = MIN(firstRow + maximumNumberOfMessages, numberOfMessages) - 1;
+    if (lastRow < numberOfMessages - 1) {
+        LYRMessage *newestMessage = [self.queryController objectAtIndexPath:[NSIndexPath indexPathForRow:lastRow inSection:0]];
+        [self replaceQueryControllerOnLoadQueueWithNewestPosition:@(newestMessage.position) numberOfMessages:maximumNumberOfMessages];
+    } else {
+        // The window counts from the newest message, so dropping the oldest ones only shrinks it.
+        self.queryController.paginationWindow = -(NSInteger)maximumNumberOfMessages;
+    }
+}
+
+- (void)expandPaginationWindowTowardsNewerMessages
+{
+    if (!self.newestPosition || self.expandingPaginationWindow || self.replacingQueryController) return;
+    self.expandingPaginationWindow = YES;
+    self.replacingQueryController = YES;
+    
+    NSUInteger numberOfMessagesToAdd = [self paginationWindowExpansionTowardsNewerMessages];
+    NSUInteger numberOfMessagesDisplayed = [self.queryController numberOfObjectsInSection:0];
+    NSUInteger numberOfQueryControllerReplacements = self.numberOfQueryControllerReplacements;
+    LYRQuery *query = self.query;
+    LYRQuery *newerMessagesQuery = [self queryForMessagesWithPositionOperator:LYRPredicateOperatorIsGreaterThan position:self.newestPosition];
+    newerMessagesQuery.limit = numberOfMessagesToAdd + 1;
+    NSSet *updatableProperties = self.queryController.updatableProperties;
+    LYRClient *layerClient = self.layerClient;
+    __weak typeof(self) weakSelf = self;
+    
+    // Every step replaces the query controller, so it is built and executed on the load queue and only swapped in on the main thread.
+    dispatch_async(ATLConversationDataSourceLoadQueue(), ^{
+        NSError *error;
+        NSOrderedSet *messages = [layerClient executeQuery:newerMessagesQuery error:&error];
+        LYRQueryController *queryController;
+        NSNumber *newestPosition;
+        NSUInteger numberOfNewerMessages = 0;
+        if (messages) {
+            // Once the remaining newer messages fit in the window, it goes back to following the newest message. The extra
+            // message fetched tells whether any are left after this step.
+            NSUInteger numberOfMessagesAdded = MIN(messages.count, numberOfMessagesToAdd);
+            newestPosition = messages.count > numberOfMessagesToAdd ? @([(LYRMessage *)messages[numberOfMessagesToAdd - 1] position]) : nil;
+            queryController = ATLExecutedQueryControllerEndingAtPosition(layerClient, query, newestPosition, updatableProperties, numberOfMessagesDisplayed + numberOfMessagesAdded, &numberOfNewerMessages);
+        } else {
+            NSLog(@"LayerKit failed to execute query with error: %@", error);
+        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [weakSelf finishReplacingQueryController:queryController newestPosition:newestPosition numberOfNewerMessages:numberOfNewerMessages numberOfQueryControllerReplacements:numberOfQueryControllerReplacements];
+        });
+    });
+}
+
+- (NSUInteger)paginationWindowExpansionTowardsNewerMessages
+{
+    // Each step costs a reload of everything displayed, so newer messages come back in the largest steps a bounded window can keep.
+    NSUInteger expansion = MAX(self.maximumPaginationWindowExpansion, MAX(self.minimumPaginationWindowExpansion, 1));
+    if (self.maximumNumberOfMessagesInPaginationWindow > 0) {
+        expansion = MIN(expansion, MAX(self.maximumNumberOfMessagesInPaginationWindow / 2, 1));
+    }
+    return expansion;
+}
+
+- (void)movePaginationWindowToNewestMessages
+{
+    if (!self.newestPosition) return;
+    if (self.expandingPaginationWindow && !self.replacingQueryController) return;
+    // Moving supersedes a replacement of the query controller that is still underway, including an expansion towards newer messages.
+    self.replacingQueryController = NO;
+    self.expandingPaginationWindow = NO;
+    [self replaceQueryControllerWithNewestPosition:nil numberOfMessages:ATLQueryControllerPaginationWindow];
+}
+
+- (void)replaceQueryControllerWithNewestPosition:(NSNumber *)newestPosition numberOfMessages:(NSUInteger)numberOfMessages
+{
+    NSUInteger numberOfNewerMessages;
+    LYRQueryController *queryController = ATLExecutedQueryControllerEndingAtPosition(self.layerClient, self.query, newestPosition, self.queryController.updatableProperties, numberOfMessages, &numberOfNewerMessages);
+    if (!queryController) return;
+    [self replaceQueryController:queryController newestPosition:newestPosition numberOfNewerMessages:numberOfNewerMessages];
+}
+
+- (void)replaceQueryControllerOnLoadQueueWithNewestPosition:(NSNumber *)newestPosition numberOfMessages:(NSUInteger)numberOfMessages
+{
+    self.replacingQueryController = YES;
+    NSUInteger numberOfQueryControllerReplacements = self.numberOfQueryControllerReplacements;
+    LYRQuery *query = self.query;
+    NSSet *updatableProperties = self.queryController.updatableProperties;
+    LYRClient *layerClient = self.layerClient;
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(ATLConversationDataSourceLoadQueue(), ^{
+        NSUInteger numberOfNewerMessages;
+        LYRQueryController *queryController = ATLExecutedQueryControllerEndingAtPosition(layerClient, query, newestPosition, updatableProperties, numberOfMessages, &numberOfNewerMessages);
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [weakSelf finishReplacingQueryController:queryController newestPosition:newestPosition numberOfNewerMessages:numberOfNewerMessages numberOfQueryControllerReplacements:numberOfQueryControllerReplacements];
+        });
+    });
+}
+
+- (void)finishReplacingQueryController:(LYRQueryController *)queryController newestPosition:(NSNumber *)newestPosition numberOfNewerMessages:(NSUInteger)numberOfNewerMessages numberOfQueryControllerReplacements:(NSUInteger)numberOfQueryControllerReplacements
+{
+    // The window was moved to the newest messages in the meantime, which superseded this replacement.
+    if (numberOfQueryControllerReplacements != self.numberOfQueryControllerReplacements) return;
+    self.replacingQueryController = NO;
+    // No other expansion starts while the query controller is replaced, so only one towards newer messages can be underway.
+    self.expandingPaginationWindow = NO;
+    if (!queryController) return;
+    [self replaceQueryController:queryController newestPosition:newestPosition numberOfNewerMessages:numberOfNewerMessages];
+}
+
+- (void)replaceQueryController:(LYRQueryController *)queryController newestPosition:(NSNumber *)newestPosition numberOfNewerMessages:(NSUInteger)numberOfNewerMessages
+{
+    LYRQueryController *previousQueryController = self.queryController;
+    queryController.delegate = previousQueryController.delegate;
+    previousQueryController.delegate = nil;
+    self.queryController = queryController;
+    self.newestPosition = newestPosition;
+    self.numberOfNewerMessages = numberOfNewerMessages;
+    self.numberOfQueryControllerReplacements++;
+    if ([self.delegate respondsToSelector:@selector(conversationDataSource:didReplaceQueryController:)]) {
+        [self.delegate conversationDataSource:self didReplaceQueryController:previousQueryController];
+    }
+}
+
+- (LYRQuery *)queryForMessagesWithPositionOperator:(LYRPredicateOperator)predicateOperator position:(NSNumber *)position
+{
+    return ATLMessageQueryWithPosition(self.query, predicateOperator, position);
 }
 
 - (NSIndexPath *)queryControllerIndexPathForCollectionViewIndexPath:(NSIndexPath *)collectionViewIndexPath
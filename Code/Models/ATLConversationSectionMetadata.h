@@ -0,0 +1,123 @@
+//
+//  ATLConversationSectionMetadata.h
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import "ATLConversationViewController.h"
+#import "ATLDataSourceChangeSet.h"
+@import LayerKit;
+
+/**
+ @abstract The elements displayed around a message, which depend on the neighbouring messages.
+ */
+typedef NS_OPTIONS(NSUInteger, ATLConversationSectionFlags) {
+    ATLConversationSectionFlagDateLabel     = 1 << 0,
+    ATLConversationSectionFlagSenderLabel   = 1 << 1,
+    ATLConversationSectionFlagClustered     = 1 << 2,
+    ATLConversationSectionFlagAvatarItem    = 1 << 3,
+    ATLConversationSectionFlagReadReceipt   = 1 << 4,
+};
+
+NS_ASSUME_NONNULL_BEGIN
+/**
+ @abstract The `ATLConversationSectionMetadata` class keeps the display flags of every section of a
+ conversation, along with the sender and dates of each message they are derived from.
+ @discussion Each section is stored as a small fixed size record, so reading the flags of a section
+ doesn't fetch any message. The table is updated incrementally: applying a change set only reads the
+ inserted and updated messages, and only recomputes the flags of the changed sections and their neighbours.
+ Changing any of the configuration properties recomputes the flags of all sections from the stored records.
+ */
+@interface ATLConversationSectionMetadata : NSObject
+
+/**
+ @abstract Creates a table for a collection view whose first message is preceded by a number of other sections.
+ @param numberOfLeadingSections The number of sections before the first message section. Their flags are always empty.
+ */
+- (instancetype)initWithNumberOfLeadingSections:(NSUInteger)numberOfLeadingSections;
+
+/**
+ @abstract The identifier of the authenticated user, whose messages don't show sender labels and do show read receipts.
+ */
+@property (nonatomic, copy, nullable) NSString *authenticatedUserID;
+
+/**
+ @abstract The time interval between two messages after which a date label is displayed.
+ */
+@property (nonatomic) NSTimeInterval dateDisplayTimeInterval;
+
+/**
+ @abstract Whether sender labels are displayed at all. They are only useful with more than two participants.
+ */
+@property (nonatomic) BOOL displaysSenderLabels;
+
+/**
+ @abstract Whether avatar items are displayed at all.
+ */
+@property (nonatomic) BOOL displaysAvatarItems;
+
+/**
+ @abstract Whether avatar items are displayed for the messages of the authenticated user.
+ */
+@property (nonatomic) BOOL displaysAvatarItemsForAuthenticatedUser;
+
+/**
+ @abstract How often an avatar item is displayed in a run of messages from the same sender.
+ */
+@property (nonatomic) ATLAvatarItemDisplayFrequency avatarItemDisplayFrequency;
+
+/**
+ @abstract Whether messages newer than the last section exist but aren't loaded. The last section then isn't the newest
+ message, so it doesn't show a read receipt.
+ */
+@property (nonatomic) BOOL newerMessagesAvailable;
+
+/**
+ @abstract The number of sections, including the leading ones.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfSections;
+
+/**
+ @abstract Replaces the whole table.
+ @param messages The messages of the conversation, in display order.
+ */
+- (void)reloadWithMessages:(NSArray <LYRMessage *> *)messages;
+
+/**
+ @abstract Applies a batch of changes to the table.
+ @param changeSet The coalesced changes, with indexes in collection view sections.
+ @param messageAtSection Returns the message displayed in a section after the changes. Only called for inserted, moved and updated sections.
+ @return The sections, in indexes after the changes, whose flags changed without being inserted.
+ */
+- (NSIndexSet *)applyChangeSet:(ATLDataSourceChangeSet *)changeSet messageAtSection:(LYRMessage * _Nullable (^)(NSUInteger section))messageAtSection;
+
+/**
+ @abstract Returns the display flags of a section, or no flags if the section doesn't exist.
+ */
+- (ATLConversationSectionFlags)flagsForSection:(NSUInteger)section;
+
+/**
+ @abstract Returns the sections within a range whose message was sent by a user.
+ @discussion Compares the interned sender of each record, so no message is fetched.
+ @param senderID The user ID of the sender.
+ @param range The sections to look at, typically the visible ones.
+ */
+- (NSIndexSet *)sectionsWithSenderID:(NSString *)senderID inRange:(NSRange)range;
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,319 @@
+//
+//  ATLConversationSectionMetadata.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ATLConversationSectionMetadata.h"
+
+static NSTimeInterval const ATLConversationSectionClusterTimeInterval = 60;
+
+/**
+ @abstract The stored state of a section. Senders are interned, so comparing them is an integer comparison.
+ Missing dates are stored as `NAN`.
+ */
+typedef struct {
+    NSUInteger senderIndex;
+    NSTimeInterval sentAt;
+    NSTimeInterval receivedAt;
+    ATLConversationSectionFlags flags;
+} ATLConversationSectionRecord;
+
+static ATLConversationSectionRecord const ATLConversationSectionEmptyRecord = { NSNotFound, NAN, NAN, 0 };
+
+@interface ATLConversationSectionMetadata ()
+
+@property (nonatomic) NSUInteger numberOfLeadingSections;
+@property (nonatomic) NSMutableData *records;
+@property (nonatomic) NSMutableArray <NSString *> *senderIDs;
+@property (nonatomic) NSMutableDictionary <NSString *, NSNumber *> *senderIndexes;
+@property (nonatomic) NSUInteger authenticatedSenderIndex;
+@property (nonatomic) BOOL needsFlagsUpdate;
+
+@end
+
+@implementation ATLConversationSectionMetadata
+
+- (instancetype)initWithNumberOfLeadingSections:(NSUInteger)numberOfLeadingSections
+{
+    self = [super init];
+    if (self) {
+        _numberOfLeadingSections = numberOfLeadingSections;
+        _records = [NSMutableData new];
+        _senderIDs = [NSMutableArray new];
+        _senderIndexes = [NSMutableDictionary new];
+        _authenticatedSenderIndex = NSNotFound;
+        _dateDisplayTimeInterval = 60*60;
+        _avatarItemDisplayFrequency = ATLAvatarItemDisplayFrequencySection;
+        [self reloadWithMessages:@[]];
+    }
+    return self;
+}
+
+- (id)init
+{
+    @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:@"Failed to call designated initializer." userInfo:nil];
+    return nil;
+}
+
+#pragma mark - Configuration
+
+- (void)setAuthenticatedUserID:(NSString *)authenticatedUserID
+{
+    if (authenticatedUserID == _authenticatedUserID || [authenticatedUserID isEqualToString:_authenticatedUserID]) return;
+    _authenticatedUserID = [authenticatedUserID copy];
+    self.authenticatedSenderIndex = [self senderIndexForUserID:authenticatedUserID];
+    self.needsFlagsUpdate = YES;
+}
+
+- (void)setDateDisplayTimeInterval:(NSTimeInterval)dateDisplayTimeInterval
+{
+    if (dateDisplayTimeInterval == _dateDisplayTimeInterval) return;
+    _dateDisplayTimeInterval = dateDisplayTimeInterval;
+    self.needsFlagsUpdate = YES;
+}
+
+- (void)setDisplaysSenderLabels:(BOOL)displaysSenderLabels
+{
+    if (displaysSenderLabels == _displaysSenderLabels) return;
+    _displaysSenderLabels = displaysSenderLabels;
+    self.needsFlagsUpdate = YES;
+}
+
+- (void)setDisplaysAvatarItems:(BOOL)displaysAvatarItems
+{
+    if (displaysAvatarItems == _displaysAvatarItems) return;
+    _displaysAvatarItems = displaysAvatarItems;
+    self.needsFlagsUpdate = YES;
+}
+
+- (void)setDisplaysAvatarItemsForAuthenticatedUser:(BOOL)displaysAvatarItemsForAuthenticatedUser
+{
+    if (displaysAvatarItemsForAuthenticatedUser == _displaysAvatarItemsForAuthenticatedUser) return;
+    _displaysAvatarItemsForAuthenticatedUser = displaysAvatarItemsForAuthenticatedUser;
+    self.needsFlagsUpdate = YES;
+}
+
+- (void)setAvatarItemDisplayFrequency:(ATLAvatarItemDisplayFrequency)avatarItemDisplayFrequency
+{
+    if (avatarItemDisplayFrequency == _avatarItemDisplayFrequency) return;
+    _avatarItemDisplayFrequency = avatarItemDisplayFrequency;
+    self.needsFlagsUpdate = YES;
+}
+
+- (void)setNewerMessagesAvailable:(BOOL)newerMessagesAvailable
+{
+    if (newerMessagesAvailable == _newerMessagesAvailable) return;
+    _newerMessagesAvailable = newerMessagesAvailable;
+    self.needsFlagsUpdate = YES;
+}
+
+#pragma mark - Public Methods
+
+- (NSUInteger)numberOfSections
+{
+    return self.records.length / sizeof(ATLConversationSectionRecord);
+}
+
+- (void)reloadWithMessages:(NSArray<LYRMessage *> *)messages
+{
+    NSUInteger numberOfSections = self.numberOfLeadingSections + messages.count;
+    self.records = [NSMutableData dataWithLength:numberOfSections * sizeof(ATLConversationSectionRecord)];
+    ATLConversationSectionRecord *records = self.records.mutableBytes;
+    for (NSUInteger section = 0; section < self.numberOfLeadingSections; section++) {
+        records[section] = ATLConversationSectionEmptyRecord;
+    }
+    [messages enumerateObjectsUsingBlock:^(LYRMessage *message, NSUInteger idx, BOOL *stop) {
+        records[self.numberOfLeadingSections + idx] = [self recordForMessage:message];
+    }];
+    self.needsFlagsUpdate = YES;
+}
+
+- (NSIndexSet *)applyChangeSet:(ATLDataSourceChangeSet *)changeSet messageAtSection:(LYRMessage *(^)(NSUInteger))messageAtSection
+{
+    [self updateFlagsIfNeeded];
+    
+    NSMutableIndexSet *removedSections = [changeSet.deletedSections mutableCopy];
+    NSMutableIndexSet *addedSections = [changeSet.insertedSections mutableCopy];
+    for (ATLDataSourceChange *move in changeSet.moves) {
+        [removedSections addIndex:move.currentIndex];
+        [addedSections addIndex:move.newIndex];
+    }
+    
+    // Splice the records the same way the collection view splices its sections: removals first, then insertions in ascending order.
+    NSUInteger recordSize = sizeof(ATLConversationSectionRecord);
+    [removedSections enumerateIndexesWithOptions:NSEnumerationReverse usingBlock:^(NSUInteger section, BOOL *stop) {
+        if (section >= self.numberOfSections) return;
+        [self.records replaceBytesInRange:NSMakeRange(section * recordSize, recordSize) withBytes:NULL length:0];
+    }];
+    [addedSections enumerateIndexesUsingBlock:^(NSUInteger section, BOOL *stop) {
+        ATLConversationSectionRecord record = [self recordForMessage:messageAtSection(section)];
+        NSUInteger location = MIN(section, self.numberOfSections) * recordSize;
+        [self.records replaceBytesInRange:NSMakeRange(location, 0) withBytes:&record length:recordSize];
+    }];
+    
+    NSUInteger numberOfSections = self.numberOfSections;
+    ATLConversationSectionRecord *records = self.records.mutableBytes;
+    [changeSet.updatedSections enumerateIndexesUsingBlock:^(NSUInteger section, BOOL *stop) {
+        if (section >= numberOfSections) return;
+        ATLConversationSectionFlags flags = records[section].flags;
+        records[section] = [self recordForMessage:messageAtSection(section)];
+        records[section].flags = flags;
+    }];
+    
+    // A section's flags depend on the previous and the next message, so the neighbours of every change are recomputed as well.
+    NSMutableIndexSet *sectionsToUpdate = [addedSections mutableCopy];
+    [sectionsToUpdate addIndexes:changeSet.updatedSections];
+    [sectionsToUpdate addIndexes:changeSet.neighbouringSections];
+    [[sectionsToUpdate copy] enumerateIndexesUsingBlock:^(NSUInteger section, BOOL *stop) {
+        if (section > 0) [sectionsToUpdate addIndex:section - 1];
+        [sectionsToUpdate addIndex:section + 1];
+    }];
+    
+    NSMutableIndexSet *changedSections = [NSMutableIndexSet new];
+    [sectionsToUpdate enumerateIndexesUsingBlock:^(NSUInteger section, BOOL *stop) {
+        if (section >= numberOfSections) {
+            *stop = YES;
+            return;
+        }
+        ATLConversationSectionFlags flags = [self computedFlagsForSection:section];
+        if (flags != records[section].flags && ![changeSet.insertedSections containsIndex:section]) {
+            [changedSections addIndex:section];
+        }
+        records[section].flags = flags;
+    }];
+    return changedSections;
+}
+
+- (ATLConversationSectionFlags)flagsForSection:(NSUInteger)section
+{
+    if (section >= self.numberOfSections) return 0;
+    [self updateFlagsIfNeeded];
+    ATLConversationSectionRecord *records = self.records.mutableBytes;
+    return records[section].flags;
+}
+
+- (NSIndexSet *)sectionsWithSenderID:(NSString *)senderID inRange:(NSRange)range
+{
+    NSMutableIndexSet *sections = [NSMutableIndexSet new];
+    NSNumber *senderIndex = senderID ? self.senderIndexes[senderID] : nil;
+    if (!senderIndex) return sections;
+    NSUInteger endSection = MIN(NSMaxRange(range), self.numberOfSections);
+    ATLConversationSectionRecord *records = self.records.mutableBytes;
+    for (NSUInteger section = range.location; section < endSection; section++) {
+        if (records[section].senderIndex == senderIndex.unsignedIntegerValue) {
+            [sections addIndex:section];
+        }
+    }
+    return sections;
+}
+
+#pragma mark - Flags
+
+- (void)updateFlagsIfNeeded
+{
+    if (!self.needsFlagsUpdate) return;
+    self.needsFlagsUpdate = NO;
+    NSUInteger numberOfSections = self.numberOfSections;
+    ATLConversationSectionRecord *records = self.records.mutableBytes;
+    for (NSUInteger section = 0; section < numberOfSections; section++) {
+        records[section].flags = [self computedFlagsForSection:section];
+    }
+}
+
+- (ATLConversationSectionFlags)computedFlagsForSection:(NSUInteger)section
+{
+    NSUInteger numberOfSections = self.numberOfSections;
+    if (section < self.numberOfLeadingSections || section >= numberOfSections) return 0;
+    ATLConversationSectionRecord *records = self.records.mutableBytes;
+    ATLConversationSectionRecord *record = &records[section];
+    ATLConversationSectionRecord *previousRecord = section > self.numberOfLeadingSections ? &records[section - 1] : NULL;
+    ATLConversationSectionRecord *nextRecord = section + 1 < numberOfSections ? &records[section + 1] : NULL;
+    BOOL sentByAuthenticatedUser = record->senderIndex != NSNotFound && record->senderIndex == self.authenticatedSenderIndex;
+    NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+    ATLConversationSectionFlags flags = 0;
+    
+    if (!previousRecord) {
+        flags |= ATLConversationSectionFlagDateLabel;
+    } else if (!isnan(previousRecord->sentAt)) {
+        NSTimeInterval sentAt = isnan(record->sentAt) ? now : record->sentAt;
+        if (sentAt - previousRecord->sentAt > self.dateDisplayTimeInterval) {
+            flags |= ATLConversationSectionFlagDateLabel;
+        }
+    }
+    
+    if (self.displaysSenderLabels && !sentByAuthenticatedUser) {
+        BOOL sameSenderAsPrevious = previousRecord && record->senderIndex != NSNotFound && previousRecord->senderIndex == record->senderIndex;
+        if (!sameSenderAsPrevious) {
+            flags |= ATLConversationSectionFlagSenderLabel;
+        }
+    }
+    
+    if (!nextRecord && !self.newerMessagesAvailable && sentByAuthenticatedUser) {
+        flags |= ATLConversationSectionFlagReadReceipt;
+    }
+    
+    if (nextRecord && !isnan(nextRecord->receivedAt)) {
+        NSTimeInterval receivedAt = isnan(record->receivedAt) ? now : record->receivedAt;
+        if (nextRecord->receivedAt - receivedAt < ATLConversationSectionClusterTimeInterval) {
+            flags |= ATLConversationSectionFlagClustered;
+        }
+    }
+    
+    if ([self shouldDisplayAvatarItemForRecord:record nextRecord:nextRecord clustered:(flags & ATLConversationSectionFlagClustered) != 0]) {
+        flags |= ATLConversationSectionFlagAvatarItem;
+    }
+    return flags;
+}
+
+- (BOOL)shouldDisplayAvatarItemForRecord:(ATLConversationSectionRecord *)record nextRecord:(ATLConversationSectionRecord *)nextRecord clustered:(BOOL)clustered
+{
+    if (!self.displaysAvatarItems) return NO;
+    if (record->senderIndex == NSNotFound) return NO;
+    if (record->senderIndex == self.authenticatedSenderIndex && !self.displaysAvatarItemsForAuthenticatedUser) return NO;
+    if (!clustered && self.avatarItemDisplayFrequency == ATLAvatarItemDisplayFrequencyCluster) return YES;
+    if (nextRecord && nextRecord->senderIndex == record->senderIndex && self.avatarItemDisplayFrequency != ATLAvatarItemDisplayFrequencyAll) {
+        return NO;
+    }
+    return YES;
+}
+
+#pragma mark - Helpers
+
+- (ATLConversationSectionRecord)recordForMessage:(LYRMessage *)message
+{
+    ATLConversationSectionRecord record = ATLConversationSectionEmptyRecord;
+    if (!message) return record;
+    record.senderIndex = [self senderIndexForUserID:message.sender.userID];
+    record.sentAt = message.sentAt ? message.sentAt.timeIntervalSinceReferenceDate : NAN;
+    record.receivedAt = message.receivedAt ? message.receivedAt.timeIntervalSinceReferenceDate : NAN;
+    return record;
+}
+
+- (NSUInteger)senderIndexForUserID:(NSString *)userID
+{
+    if (!userID) return NSNotFound;
+    NSNumber *senderIndex = self.senderIndexes[userID];
+    if (!senderIndex) {
+        senderIndex = @(self.senderIDs.count);
+        [self.senderIDs addObject:userID];
+        self.senderIndexes[userID] = senderIndex;
+    }
+    return senderIndex.unsignedIntegerValue;
+}
+
+@end
@@ -0,0 +1,81 @@
+//
+//  ATLDataSourceChangeSet.h
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+#import "ATLDataSourceChange.h"
+
+NS_ASSUME_NONNULL_BEGIN
+/**
+ @abstract The `ATLDataSourceChangeSet` class coalesces the `ATLDataSourceChange` objects
+ reported during a single query controller change batch into the minimal set of section updates.
+ @discussion Inserts, deletes and updates are merged into index sets. Moves whose source ends
+ up at its destination anyway once the other changes are applied are dropped, and the moved
+ section is reported as updated instead.
+ */
+@interface ATLDataSourceChangeSet : NSObject
+
+/**
+ @abstract Coalesces a batch of changes.
+ @param changes The changes reported between `queryControllerWillChangeContent:` and `queryControllerDidChangeContent:`.
+ Indexes of deletions and move sources refer to the sections before the batch, indexes of insertions and move destinations to the sections after it.
+ @return A new change set.
+ */
++ (instancetype)changeSetWithChanges:(NSArray <ATLDataSourceChange *> *)changes;
+
+/**
+ @abstract The deleted sections, in indexes before the batch.
+ */
+@property (nonatomic, readonly) NSIndexSet *deletedSections;
+
+/**
+ @abstract The inserted sections, in indexes after the batch.
+ */
+@property (nonatomic, readonly) NSIndexSet *insertedSections;
+
+/**
+ @abstract The moves which actually change the order of the sections.
+ */
+@property (nonatomic, readonly) NSArray <ATLDataSourceChange *> *moves;
+
+/**
+ @abstract The sections whose content changed without being inserted, in indexes after the batch.
+ */
+@property (nonatomic, readonly) NSIndexSet *updatedSections;
+
+/**
+ @abstract The sections, in indexes after the batch, which were not inserted but whose previous or next section changed.
+ @discussion Headers, footers and avatars depend on the neighbouring messages, so these sections may need to be reconfigured.
+ */
+@property (nonatomic, readonly) NSIndexSet *neighbouringSections;
+
+/**
+ @abstract `YES` if the batch changes the number or the order of the sections.
+ */
+@property (nonatomic, readonly) BOOL hasStructuralChanges;
+
+/**
+ @abstract Returns the index a section has after the batch.
+ @param section The index of the section before the batch.
+ @return The index after the batch, or `NSNotFound` if the section was deleted or moved.
+ */
+- (NSUInteger)sectionAfterChangesForSection:(NSUInteger)section;
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,194 @@
+//
+//  ATLDataSourceChangeSet.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ATLDataSourceChangeSet.h"
+
+/**
+ @abstract Maps a section index through a set of removals followed by a set of insertions, the way `UICollectionView` places sections which aren't part of an update.
+ */
+static NSUInteger ATLSectionIndexAfterChanges(NSUInteger section, NSIndexSet *removedSections, NSIndexSet *insertedSections)
+{
+    if ([removedSections containsIndex:section]) return NSNotFound;
+    __block NSUInteger index = section - [removedSections countOfIndexesInRange:NSMakeRange(0, section)];
+    [insertedSections enumerateIndexesUsingBlock:^(NSUInteger insertedIndex, BOOL *stop) {
+        if (insertedIndex > index) {
+            *stop = YES;
+            return;
+        }
+        index++;
+    }];
+    return index;
+}
+
+@interface ATLDataSourceChangeSet ()
+
+@property (nonatomic, readwrite) NSIndexSet *deletedSections;
+@property (nonatomic, readwrite) NSIndexSet *insertedSections;
+@property (nonatomic, readwrite) NSArray <ATLDataSourceChange *> *moves;
+@property (nonatomic, readwrite) NSIndexSet *updatedSections;
+@property (nonatomic, readwrite) NSIndexSet *neighbouringSections;
+@property (nonatomic) NSIndexSet *removedSections;
+@property (nonatomic) NSIndexSet *addedSections;
+
+@end
+
+@implementation ATLDataSourceChangeSet
+
++ (instancetype)changeSetWithChanges:(NSArray<ATLDataSourceChange *> *)changes
+{
+    return [[self alloc] initWithChanges:changes];
+}
+
+- (id)initWithChanges:(NSArray<ATLDataSourceChange *> *)changes
+{
+    self = [super init];
+    if (self) {
+        [self coalesceChanges:changes];
+    }
+    return self;
+}
+
+- (id)init
+{
+    @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:@"Failed to call designated initializer." userInfo:nil];
+    return nil;
+}
+
+#pragma mark - Coalescing
+
+- (void)coalesceChanges:(NSArray<ATLDataSourceChange *> *)changes
+{
+    NSMutableIndexSet *deletedSections = [NSMutableIndexSet new];
+    NSMutableIndexSet *insertedSections = [NSMutableIndexSet new];
+    NSMutableIndexSet *updatedSectionsBeforeChanges = [NSMutableIndexSet new];
+    NSMutableIndexSet *updatedSections = [NSMutableIndexSet new];
+    NSMutableArray *moves = [NSMutableArray new];
+    for (ATLDataSourceChange *change in changes) {
+        switch (change.type) {
+            case LYRQueryControllerChangeTypeInsert:
+                if (change.newIndex != NSNotFound) [insertedSections addIndex:change.newIndex];
+                break;
+                
+            case LYRQueryControllerChangeTypeDelete:
+                if (change.currentIndex != NSNotFound) [deletedSections addIndex:change.currentIndex];
+                break;
+                
+            case LYRQueryControllerChangeTypeMove:
+                if (change.currentIndex != NSNotFound && change.newIndex != NSNotFound) [moves addObject:change];
+                break;
+                
+            case LYRQueryControllerChangeTypeUpdate:
+                if (change.newIndex != NSNotFound) {
+                    [updatedSections addIndex:change.newIndex];
+                } else if (change.currentIndex != NSNotFound) {
+                    [updatedSectionsBeforeChanges addIndex:change.currentIndex];
+                }
+                break;
+                
+            default:
+                break;
+        }
+    }
+    
+    // A move is redundant if its section lands on the destination anyway once the other changes are applied.
+    // Dropping one move changes where the others land, so the remaining moves are checked again after each drop.
+    NSUInteger moveIndex = 0;
+    while (moveIndex < moves.count) {
+        ATLDataSourceChange *move = moves[moveIndex];
+        [moves removeObjectAtIndex:moveIndex];
+        NSIndexSet *removedSections = [self sectionsByAddingSections:[self sourcesOfMoves:moves] toSections:deletedSections];
+        NSIndexSet *addedSections = [self sectionsByAddingSections:[self destinationsOfMoves:moves] toSections:insertedSections];
+        if (ATLSectionIndexAfterChanges(move.currentIndex, removedSections, addedSections) == (NSUInteger)move.newIndex) {
+            [updatedSections addIndex:move.newIndex];
+            moveIndex = 0;
+        } else {
+            [moves insertObject:move atIndex:moveIndex];
+            moveIndex++;
+        }
+    }
+    
+    self.deletedSections = deletedSections;
+    self.insertedSections = insertedSections;
+    self.moves = moves;
+    self.removedSections = [self sectionsByAddingSections:[self sourcesOfMoves:moves] toSections:deletedSections];
+    self.addedSections = [self sectionsByAddingSections:[self destinationsOfMoves:moves] toSections:insertedSections];
+    
+    [updatedSectionsBeforeChanges enumerateIndexesUsingBlock:^(NSUInteger section, BOOL *stop) {
+        NSUInteger sectionAfterChanges = [self sectionAfterChangesForSection:section];
+        if (sectionAfterChanges != NSNotFound) [updatedSections addIndex:sectionAfterChanges];
+    }];
+    [updatedSections removeIndexes:insertedSections];
+    self.updatedSections = updatedSections;
+    
+    // Sections next to an added or removed section get a new neighbour; moved sections may have new neighbours on both sides.
+    NSMutableIndexSet *neighbouringSections = [NSMutableIndexSet new];
+    [self.addedSections enumerateIndexesUsingBlock:^(NSUInteger section, BOOL *stop) {
+        if (section > 0) [neighbouringSections addIndex:section - 1];
+        [neighbouringSections addIndex:section + 1];
+    }];
+    [self.removedSections enumerateIndexesUsingBlock:^(NSUInteger section, BOOL *stop) {
+        NSUInteger previousSection = section > 0 ? [self sectionAfterChangesForSection:section - 1] : NSNotFound;
+        NSUInteger nextSection = [self sectionAfterChangesForSection:section + 1];
+        if (previousSection != NSNotFound) [neighbouringSections addIndex:previousSection];
+        if (nextSection != NSNotFound) [neighbouringSections addIndex:nextSection];
+    }];
+    [neighbouringSections addIndexes:[self destinationsOfMoves:moves]];
+    [neighbouringSections removeIndexes:insertedSections];
+    self.neighbouringSections = neighbouringSections;
+}
+
+- (BOOL)hasStructuralChanges
+{
+    return self.deletedSections.count > 0 || self.insertedSections.count > 0 || self.moves.count > 0;
+}
+
+- (NSUInteger)sectionAfterChangesForSection:(NSUInteger)section
+{
+    return ATLSectionIndexAfterChanges(section, self.removedSections, self.addedSections);
+}
+
+#pragma mark - Helpers
+
+- (NSIndexSet *)sourcesOfMoves:(NSArray<ATLDataSourceChange *> *)moves
+{
+    NSMutableIndexSet *sections = [NSMutableIndexSet new];
+    for (ATLDataSourceChange *move in moves) {
+        [sections addIndex:move.currentIndex];
+    }
+    return sections;
+}
+
+- (NSIndexSet *)destinationsOfMoves:(NSArray<ATLDataSourceChange *> *)moves
+{
+    NSMutableIndexSet *sections = [NSMutableIndexSet new];
+    for (ATLDataSourceChange *move in moves) {
+        [sections addIndex:move.newIndex];
+    }
+    return sections;
+}
+
+- (NSIndexSet *)sectionsByAddingSections:(NSIndexSet *)sections toSections:(NSIndexSet *)otherSections
+{
+    NSMutableIndexSet *result = [otherSections mutableCopy];
+    [result addIndexes:sections];
+    return result;
+}
+
+@end
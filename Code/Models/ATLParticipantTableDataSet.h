@@ -56,5 +56,38 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable id<ATLParticipant>)participantAtIndexPath:(NSIndexPath *)indexPath;
 
+@end
+
+/**
+ @abstract The `ATLParticipantTableDataSetBuilder` class builds data sets of participants, remembering what it computed for each participant.
+ @discussion The name a participant is sorted by is folded to a sort key, ignoring case, diacritics and width, and its section
+ initial is computed, once per participant. Both are kept for later data sets, such as those of search results, and computed
+ again only if the participant's name or the current locale changes. Large sets of participants are sorted in parallel chunks
+ which are then merged. Not thread safe; meant to be used from the main thread by a single participant table view controller.
+ */
+@interface ATLParticipantTableDataSetBuilder : NSObject
+
+/**
+ @abstract Creates a builder for data sets sorted by the given type.
+ */
+- (instancetype)initWithSortType:(ATLParticipantPickerSortType)sortType;
+
+/**
+ @abstract The type of sorting of the data sets built.
+ */
+@property (nonatomic, readonly) ATLParticipantPickerSortType sortType;
+
+/**
+ @abstract Builds a data set from a set of participants.
+ @param participants The set of participants to use. Each object in the given set must conform to the `ATLParticipant` protocol.
+ @return A new data set initialized with the given set of participants.
+ */
+- (ATLParticipantTableDataSet *)dataSetWithParticipants:(NSSet <id<ATLParticipant>>*)participants;
+
+/**
+ @abstract Forgets the sort keys and initials computed so far.
+ */
+- (void)removeAllSortKeys;
+
 @end
 NS_ASSUME_NONNULL_END
@@ -20,6 +20,8 @@
 #import "ATLParticipantTableDataSet.h"
 
 static NSString *const ATLParticipantTableMiscellaneaSectionTitle = @"#";
+static NSUInteger const ATLParticipantTableParallelSortChunkLength = 4096;
+static NSUInteger const ATLParticipantTableSortKeyBatchLength = 512;
 
 @interface ATLParticipantTableSectionData : NSObject
 
@@ -31,63 +33,64 @@ static NSString *const ATLParticipantTableMiscellaneaSectionTitle = @"#";
 
 @end
 
+/**
+ @abstract The sort key and section initial computed for the name of a participant.
+ */
+@interface ATLParticipantTableSortKey : NSObject
+
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, copy) NSString *foldedName;
+@property (nonatomic, copy) NSString *initial;
+
+@end
+
+@implementation ATLParticipantTableSortKey
+
+@end
+
+@interface ATLParticipantTableSortItem : NSObject
+
+@property (nonatomic) id<ATLParticipant> participant;
+@property (nonatomic) ATLParticipantTableSortKey *sortKey;
+
+@end
+
+@implementation ATLParticipantTableSortItem
+
+@end
+
+static void ATLParticipantTableMergeSortedItems(NSArray *items, NSArray *otherItems, NSMutableArray *mergedItems, NSComparator comparator)
+{
+    NSUInteger index = 0;
+    NSUInteger otherIndex = 0;
+    while (index < items.count && otherIndex < otherItems.count) {
+        // Ties keep the item of the first array first, so the merge is stable.
+        if (comparator(items[index], otherItems[otherIndex]) != NSOrderedDescending) {
+            [mergedItems addObject:items[index++]];
+        } else {
+            [mergedItems addObject:otherItems[otherIndex++]];
+        }
+    }
+    [mergedItems addObjectsFromArray:[items subarrayWithRange:NSMakeRange(index, items.count - index)]];
+    [mergedItems addObjectsFromArray:[otherItems subarrayWithRange:NSMakeRange(otherIndex, otherItems.count - otherIndex)]];
+}
+
 @interface ATLParticipantTableDataSet ()
 
 @property (nonatomic) NSArray *sectionTitles;
 @property (nonatomic) NSArray *participants;
 @property (nonatomic) NSArray *sections;
 
++ (NSString *)initialForName:(NSString *)name;
+
 @end
 
 @implementation ATLParticipantTableDataSet
 
 + (instancetype)dataSetWithParticipants:(NSSet *)participants sortType:(ATLParticipantPickerSortType)sortType
 {
-    NSSortDescriptor *sortDescriptor;
-    switch (sortType) {
-        case ATLParticipantPickerSortTypeFirstName:
-            sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"firstName" ascending:YES selector:@selector(localizedStandardCompare:)];
-            break;
-        case ATLParticipantPickerSortTypeLastName:
-            sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"lastName" ascending:YES selector:@selector(localizedStandardCompare:)];
-            break;
-    }
-    NSArray *sortedParticipants = [participants sortedArrayUsingDescriptors:@[sortDescriptor]];
-
-    NSMutableArray *sections = [NSMutableArray new];
-    NSMutableArray *sectionTitles = [NSMutableArray new];
-    NSString *currentSectionTitle;
-    ATLParticipantTableSectionData *currentSectionData;
-    for (id<ATLParticipant> participant in sortedParticipants) {
-        NSString *name;
-        switch (sortType) {
-            case ATLParticipantPickerSortTypeFirstName:
-                name = participant.firstName;
-                break;
-            case ATLParticipantPickerSortTypeLastName:
-                name = participant.lastName;
-                break;
-        }
-        NSString *initial = [self initialForName:name];
-        if ([initial isEqualToString:currentSectionTitle]) {
-            NSRange range = currentSectionData.participantsRange;
-            range.length += 1;
-            currentSectionData.participantsRange = range;
-        } else {
-            currentSectionTitle = initial;
-            [sectionTitles addObject:currentSectionTitle];
-            ATLParticipantTableSectionData *priorSectionData = currentSectionData;
-            currentSectionData = [ATLParticipantTableSectionData new];
-            currentSectionData.participantsRange = NSMakeRange(NSMaxRange(priorSectionData.participantsRange), 1);
-            [sections addObject:currentSectionData];
-        }
-    }
-
-    ATLParticipantTableDataSet *dataSet = [self new];
-    dataSet.participants = sortedParticipants;
-    dataSet.sectionTitles = sectionTitles;
-    dataSet.sections = sections;
-    return dataSet;
+    ATLParticipantTableDataSetBuilder *builder = [[ATLParticipantTableDataSetBuilder alloc] initWithSortType:sortType];
+    return [builder dataSetWithParticipants:participants];
 }
 
 + (NSString *)initialForName:(NSString *)name
@@ -140,3 +143,167 @@ static NSString *const ATLParticipantTableMiscellaneaSectionTitle = @"#";
 }
 
 @end
+
+@interface ATLParticipantTableDataSetBuilder ()
+
+@property (nonatomic, readwrite) ATLParticipantPickerSortType sortType;
+@property (nonatomic) NSMapTable *sortKeys;
+@property (nonatomic) NSLocale *locale;
+
+@end
+
+@implementation ATLParticipantTableDataSetBuilder
+
+- (instancetype)initWithSortType:(ATLParticipantPickerSortType)sortType
+{
+    self = [super init];
+    if (self) {
+        _sortType = sortType;
+        _sortKeys = [NSMapTable weakToStrongObjectsMapTable];
+    }
+    return self;
+}
+
+- (id)init
+{
+    @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:@"Failed to call designated initializer." userInfo:nil];
+    return nil;
+}
+
+#pragma mark - Public Methods
+
+- (ATLParticipantTableDataSet *)dataSetWithParticipants:(NSSet *)participants
+{
+    NSLocale *locale = [NSLocale currentLocale];
+    if (![locale isEqual:self.locale]) {
+        [self removeAllSortKeys];
+        self.locale = locale;
+    }
+    NSArray *sortedItems = [self sortedItems:[self sortItemsForParticipants:participants]];
+
+    NSMutableArray *sortedParticipants = [NSMutableArray arrayWithCapacity:sortedItems.count];
+    NSMutableArray *sections = [NSMutableArray new];
+    NSMutableArray *sectionTitles = [NSMutableArray new];
+    NSString *currentSectionTitle;
+    ATLParticipantTableSectionData *currentSectionData;
+    for (ATLParticipantTableSortItem *item in sortedItems) {
+        [sortedParticipants addObject:item.participant];
+        NSString *initial = item.sortKey.initial;
+        if ([initial isEqualToString:currentSectionTitle]) {
+            NSRange range = currentSectionData.participantsRange;
+            range.length += 1;
+            currentSectionData.participantsRange = range;
+        } else {
+            currentSectionTitle = initial;
+            [sectionTitles addObject:currentSectionTitle];
+            ATLParticipantTableSectionData *priorSectionData = currentSectionData;
+            currentSectionData = [ATLParticipantTableSectionData new];
+            currentSectionData.participantsRange = NSMakeRange(NSMaxRange(priorSectionData.participantsRange), 1);
+            [sections addObject:currentSectionData];
+        }
+    }
+
+    ATLParticipantTableDataSet *dataSet = [ATLParticipantTableDataSet new];
+    dataSet.participants = sortedParticipants;
+    dataSet.sectionTitles = sectionTitles;
+    dataSet.sections = sections;
+    return dataSet;
+}
+
+- (void)removeAllSortKeys
+{
+    [self.sortKeys removeAllObjects];
+}
+
+#pragma mark - Sorting
+
+- (NSArray *)sortItemsForParticipants:(NSSet *)participants
+{
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:participants.count];
+    NSMutableArray *newSortKeys = [NSMutableArray new];
+    for (id<ATLParticipant> participant in participants) {
+        NSString *name = [self nameForParticipant:participant];
+        ATLParticipantTableSortKey *sortKey = [self.sortKeys objectForKey:participant];
+        if (!sortKey || !(sortKey.name == name || [sortKey.name isEqualToString:name])) {
+            sortKey = [ATLParticipantTableSortKey new];
+            sortKey.name = name;
+            [self.sortKeys setObject:sortKey forKey:participant];
+            [newSortKeys addObject:sortKey];
+        }
+        ATLParticipantTableSortItem *item = [ATLParticipantTableSortItem new];
+        item.participant = participant;
+        item.sortKey = sortKey;
+        [items addObject:item];
+    }
+
+    // Each batch of new keys is only touched by one thread.
+    NSLocale *locale = self.locale;
+    NSUInteger batchCount = (newSortKeys.count + ATLParticipantTableSortKeyBatchLength - 1) / ATLParticipantTableSortKeyBatchLength;
+    dispatch_apply(batchCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^(size_t batch) {
+        NSUInteger end = MIN((batch + 1) * ATLParticipantTableSortKeyBatchLength, newSortKeys.count);
+        for (NSUInteger index = batch * ATLParticipantTableSortKeyBatchLength; index < end; index++) {
+            ATLParticipantTableSortKey *sortKey = newSortKeys[index];
+            NSString *name = sortKey.name ?: @"";
+            sortKey.foldedName = [name stringByFoldingWithOptions:NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch | NSWidthInsensitiveSearch locale:locale];
+            sortKey.initial = [ATLParticipantTableDataSet initialForName:name];
+        }
+    });
+    return items;
+}
+
+- (NSArray *)sortedItems:(NSArray *)items
+{
+    // Folded names differ at the first letter that differs regardless of case and diacritics, which is what a localized
+    // comparison considers first; only names which fold to the same key need the full comparison of the original names.
+    NSLocale *locale = self.locale;
+    NSComparator comparator = ^NSComparisonResult(ATLParticipantTableSortItem *item, ATLParticipantTableSortItem *otherItem) {
+        NSString *foldedName = item.sortKey.foldedName;
+        NSComparisonResult result = [foldedName compare:otherItem.sortKey.foldedName options:NSNumericSearch range:NSMakeRange(0, foldedName.length) locale:locale];
+        if (result != NSOrderedSame) return result;
+        return [item.sortKey.name ?: @"" localizedStandardCompare:otherItem.sortKey.name ?: @""];
+    };
+    NSUInteger chunkCount = MIN([NSProcessInfo processInfo].activeProcessorCount, items.count / ATLParticipantTableParallelSortChunkLength);
+    if (chunkCount < 2) {
+        return [items sortedArrayUsingComparator:comparator];
+    }
+
+    NSUInteger chunkLength = (items.count + chunkCount - 1) / chunkCount;
+    NSMutableArray *chunks = [NSMutableArray arrayWithCapacity:chunkCount];
+    for (NSUInteger location = 0; location < items.count; location += chunkLength) {
+        NSRange range = NSMakeRange(location, MIN(chunkLength, items.count - location));
+        [chunks addObject:[[items subarrayWithRange:range] mutableCopy]];
+    }
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0);
+    dispatch_apply(chunks.count, queue, ^(size_t index) {
+        [chunks[index] sortUsingComparator:comparator];
+    });
+    while (chunks.count > 1) {
+        NSUInteger pairCount = chunks.count / 2;
+        NSMutableArray *mergedChunks = [NSMutableArray arrayWithCapacity:pairCount + 1];
+        for (NSUInteger pair = 0; pair < pairCount; pair++) {
+            [mergedChunks addObject:[NSMutableArray arrayWithCapacity:[chunks[2 * pair] count] + [chunks[2 * pair + 1] count]]];
+        }
+        if (chunks.count % 2) {
+            [mergedChunks addObject:chunks.lastObject];
+        }
+        NSArray *chunksToMerge = chunks;
+        dispatch_apply(pairCount, queue, ^(size_t pair) {
+            ATLParticipantTableMergeSortedItems(chunksToMerge[2 * pair], chunksToMerge[2 * pair + 1], mergedChunks[pair], comparator);
+        });
+        chunks = mergedChunks;
+    }
+    return chunks.firstObject;
+}
+
+- (NSString *)nameForParticipant:(id<ATLParticipant>)participant
+{
+    switch (self.sortType) {
+        case ATLParticipantPickerSortTypeFirstName:
+            return participant.firstName;
+        case ATLParticipantPickerSortTypeLastName:
+            return participant.lastName;
+    }
+    return nil;
+}
+
+@end
@@ -0,0 +1,81 @@
+//
+//  ATLAnimatedImage.h
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <UIKit/UIKit.h>
+#import <ImageIO/ImageIO.h>
+
+NS_ASSUME_NONNULL_BEGIN
+/**
+ @abstract The default number of bytes the pre-rendered frames of a single animated image may occupy (8MB).
+ */
+extern NSUInteger const ATLAnimatedImageDefaultMemoryLimit;
+
+/**
+ @abstract The `ATLAnimatedImage` class is an animated image which decodes its
+   frames on demand from the underlying image source.
+ @discussion The image itself is the first frame of the animation, so it
+   can be displayed by any `UIImageView`; an `ATLAnimatedImageView` plays
+   the animation. Only as many decoded frames as fit in `memoryLimit` are
+   kept around, in a ring ahead of the frame on screen, which is refilled
+   on a background queue while the animation plays. If every frame fits,
+   each frame is decoded once. Frames are downsampled to `maximumPixelSize`.
+ */
+@interface ATLAnimatedImage : UIImage
+
+/**
+ @abstract Creates an animated image from an image source, such as an animated GIF.
+ @param source The image source to decode the frames from. It is retained by the animated image.
+ @param maximumPixelSize The maximum width or height of the decoded frames, in pixels. Pass 0 to decode frames at their full size.
+ @param scale The scale of the image, usually the main screen's, read on the main thread.
+ @param memoryLimit The maximum number of bytes the decoded frames may occupy.
+ @return Returns an animated image, or `nil` if the first frame couldn't be decoded.
+ */
+- (nullable instancetype)initWithImageSource:(CGImageSourceRef)source maximumPixelSize:(CGFloat)maximumPixelSize scale:(CGFloat)scale memoryLimit:(NSUInteger)memoryLimit;
+
+/**
+ @abstract The number of frames in the animation.
+ */
+@property (nonatomic, readonly) NSUInteger frameCount;
+
+/**
+ @abstract The time one loop of the animation takes.
+ */
+@property (nonatomic, readonly) NSTimeInterval totalDuration;
+
+/**
+ @abstract The number of decoded frames kept in memory at the same time.
+ */
+@property (nonatomic, readonly) NSUInteger frameBufferCount;
+
+/**
+ @abstract Returns how long the frame at the index should stay on screen.
+ */
+- (NSTimeInterval)durationOfFrameAtIndex:(NSUInteger)index;
+
+/**
+ @abstract Returns the decoded frame at the index if it is ready, and schedules
+   the frames following it to be decoded.
+ @discussion Returns `nil` if the frame hasn't been decoded yet, in which case
+   the caller should keep showing the current frame and ask again later.
+ */
+- (nullable UIImage *)frameAtIndex:(NSUInteger)index;
+
+@end
+NS_ASSUME_NONNULL_END
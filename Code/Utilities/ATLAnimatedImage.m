@@ -0,0 +1,251 @@
+//
+//  ATLAnimatedImage.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ATLAnimatedImage.h"
+
+NSUInteger const ATLAnimatedImageDefaultMemoryLimit = 8 * 1024 * 1024;
+static char const ATLAnimatedImageSerialQueueName[] = "com.layer.Atlas.ATLAnimatedImage.serialQueue";
+static char const ATLAnimatedImageFrameDecodingQueueName[] = "com.layer.Atlas.ATLAnimatedImage.frameDecodingQueue";
+static NSTimeInterval const ATLAnimatedImageMinimumFrameDuration = 0.02;
+static NSTimeInterval const ATLAnimatedImageDefaultFrameDuration = 0.1;
+
+static NSTimeInterval ATLAnimatedImageDurationOfFrameAtIndex(CGImageSourceRef source, size_t index)
+{
+    NSTimeInterval duration = 0;
+    CFDictionaryRef properties = CGImageSourceCopyPropertiesAtIndex(source, index, NULL);
+    if (properties) {
+        NSDictionary *gifProperties = ((__bridge NSDictionary *)properties)[(NSString *)kCGImagePropertyGIFDictionary];
+        NSNumber *frameDuration = gifProperties[(NSString *)kCGImagePropertyGIFUnclampedDelayTime];
+        if (frameDuration.doubleValue <= 0) {
+            frameDuration = gifProperties[(NSString *)kCGImagePropertyGIFDelayTime];
+        }
+        duration = frameDuration.doubleValue;
+        CFRelease(properties);
+    }
+    // Browsers play frames with no (or a silly small) delay at 10fps, and so do we.
+    if (duration < ATLAnimatedImageMinimumFrameDuration) {
+        duration = ATLAnimatedImageDefaultFrameDuration;
+    }
+    return duration;
+}
+
+static CGImageRef ATLAnimatedImageCreateDecodedFrameAtIndex(CGImageSourceRef source, size_t index, CGFloat maximumPixelSize)
+{
+    CGImageRef image;
+    if (maximumPixelSize > 0) {
+        NSDictionary *thumbnailOptions = @{ (NSString *)kCGImageSourceCreateThumbnailFromImageAlways : @YES,
+                                            (NSString *)kCGImageSourceCreateThumbnailWithTransform : @YES,
+                                            (NSString *)kCGImageSourceThumbnailMaxPixelSize : @(maximumPixelSize) };
+        image = CGImageSourceCreateThumbnailAtIndex(source, index, (__bridge CFDictionaryRef)thumbnailOptions);
+    } else {
+        image = CGImageSourceCreateImageAtIndex(source, index, NULL);
+    }
+    if (!image) {
+        return NULL;
+    }
+    // Draw the frame into a bitmap, so displaying it doesn't decode it again on the main thread.
+    size_t width = CGImageGetWidth(image);
+    size_t height = CGImageGetHeight(image);
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace, kCGBitmapByteOrder32Host | kCGImageAlphaPremultipliedFirst);
+    CGColorSpaceRelease(colorSpace);
+    if (!context) {
+        return image;
+    }
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), image);
+    CGImageRelease(image);
+    CGImageRef decodedImage = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+    return decodedImage;
+}
+
+@interface ATLAnimatedImage ()
+
+@property (nonatomic) CGImageSourceRef imageSource;
+@property (nonatomic) CGFloat maximumPixelSize;
+@property (nonatomic) NSArray <NSNumber *> *frameDurations;
+@property (nonatomic, readwrite) NSUInteger frameCount;
+@property (nonatomic, readwrite) NSTimeInterval totalDuration;
+@property (nonatomic, readwrite) NSUInteger frameBufferCount;
+@property (nonatomic) dispatch_queue_t serialQueue;
+@property (nonatomic) dispatch_queue_t frameDecodingQueue;
+@property (nonatomic) NSMutableDictionary <NSNumber *, UIImage *> *frames;
+@property (nonatomic) NSMutableIndexSet *requestedFrameIndexes;
+
+@end
+
+@implementation ATLAnimatedImage
+
+- (instancetype)initWithImageSource:(CGImageSourceRef)source maximumPixelSize:(CGFloat)maximumPixelSize scale:(CGFloat)scale memoryLimit:(NSUInteger)memoryLimit
+{
+    if (!source) {
+        return nil;
+    }
+    CGImageRef posterImage = ATLAnimatedImageCreateDecodedFrameAtIndex(source, 0, maximumPixelSize);
+    if (!posterImage) {
+        return nil;
+    }
+    self = [super initWithCGImage:posterImage scale:scale orientation:UIImageOrientationUp];
+    if (self) {
+        _imageSource = (CGImageSourceRef)CFRetain(source);
+        _maximumPixelSize = maximumPixelSize;
+        _frameCount = MAX(CGImageSourceGetCount(source), 1);
+        NSMutableArray *frameDurations = [NSMutableArray arrayWithCapacity:_frameCount];
+        for (size_t index = 0; index < _frameCount; index++) {
+            NSTimeInterval frameDuration = ATLAnimatedImageDurationOfFrameAtIndex(source, index);
+            [frameDurations addObject:@(frameDuration)];
+            _totalDuration += frameDuration;
+        }
+        _frameDurations = frameDurations;
+        
+        // All frames have the size of the first one, so the poster tells how much memory each frame takes.
+        size_t bytesPerFrame = MAX(CGImageGetBytesPerRow(posterImage) * CGImageGetHeight(posterImage), 1);
+        _frameBufferCount = MIN(MAX(memoryLimit / bytesPerFrame, 1), _frameCount);
+        _frames = [NSMutableDictionary dictionaryWithCapacity:_frameBufferCount];
+        _frames[@0] = [UIImage imageWithCGImage:posterImage scale:self.scale orientation:UIImageOrientationUp];
+        _requestedFrameIndexes = [NSMutableIndexSet indexSet];
+        _serialQueue = dispatch_queue_create(ATLAnimatedImageSerialQueueName, DISPATCH_QUEUE_SERIAL);
+        _frameDecodingQueue = dispatch_queue_create(ATLAnimatedImageFrameDecodingQueueName, DISPATCH_QUEUE_SERIAL);
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    }
+    CGImageRelease(posterImage);
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    if (_imageSource) {
+        CFRelease(_imageSource);
+    }
+}
+
+#pragma mark - Public Methods
+
+- (NSTimeInterval)durationOfFrameAtIndex:(NSUInteger)index
+{
+    if (index >= self.frameCount) {
+        return 0;
+    }
+    return self.frameDurations[index].doubleValue;
+}
+
+- (UIImage *)frameAtIndex:(NSUInteger)index
+{
+    if (index >= self.frameCount) {
+        return nil;
+    }
+    __block UIImage *frame;
+    NSMutableIndexSet *frameIndexesToDecode = [NSMutableIndexSet indexSet];
+    dispatch_sync(self.serialQueue, ^{
+        frame = self.frames[@(index)];
+        if (self.frameBufferCount == self.frameCount && self.frames.count == self.frameCount) {
+            return;
+        }
+        
+        // The ring spans the requested frame and the ones following it; anything else can go.
+        NSMutableIndexSet *ringFrameIndexes = [NSMutableIndexSet indexSet];
+        for (NSUInteger offset = 0; offset < self.frameBufferCount; offset++) {
+            [ringFrameIndexes addIndex:(index + offset) % self.frameCount];
+        }
+        if (self.frameBufferCount < self.frameCount) {
+            for (NSNumber *frameIndex in self.frames.allKeys) {
+                if (![ringFrameIndexes containsIndex:frameIndex.unsignedIntegerValue]) {
+                    [self.frames removeObjectForKey:frameIndex];
+                }
+            }
+            // Pending decodes which fell behind the ring are skipped.
+            NSMutableIndexSet *staleFrameIndexes = [self.requestedFrameIndexes mutableCopy];
+            [staleFrameIndexes removeIndexes:ringFrameIndexes];
+            [self.requestedFrameIndexes removeIndexes:staleFrameIndexes];
+        }
+        [ringFrameIndexes enumerateIndexesUsingBlock:^(NSUInteger frameIndex, BOOL *stop) {
+            if (!self.frames[@(frameIndex)] && ![self.requestedFrameIndexes containsIndex:frameIndex]) {
+                [frameIndexesToDecode addIndex:frameIndex];
+            }
+        }];
+        [self.requestedFrameIndexes addIndexes:frameIndexesToDecode];
+    });
+    if (frameIndexesToDecode.count) {
+        [self decodeFramesAtIndexes:frameIndexesToDecode startingAtIndex:index];
+    }
+    return frame;
+}
+
+#pragma mark - Frame Decoding
+
+- (void)decodeFramesAtIndexes:(NSIndexSet *)frameIndexes startingAtIndex:(NSUInteger)startIndex
+{
+    // Decode in playback order, so the frame needed next is ready first, wrapping around at the end of the loop.
+    NSMutableArray <NSNumber *> *orderedFrameIndexes = [NSMutableArray arrayWithCapacity:frameIndexes.count];
+    [frameIndexes enumerateIndexesInRange:NSMakeRange(startIndex, self.frameCount - startIndex) options:0 usingBlock:^(NSUInteger frameIndex, BOOL *stop) {
+        [orderedFrameIndexes addObject:@(frameIndex)];
+    }];
+    [frameIndexes enumerateIndexesInRange:NSMakeRange(0, startIndex) options:0 usingBlock:^(NSUInteger frameIndex, BOOL *stop) {
+        [orderedFrameIndexes addObject:@(frameIndex)];
+    }];
+    
+    __weak typeof(self) weakSelf = self;
+    dispatch_async(self.frameDecodingQueue, ^{
+        for (NSNumber *frameIndex in orderedFrameIndexes) {
+            typeof(self) strongSelf = weakSelf;
+            if (!strongSelf) {
+                return;
+            }
+            __block BOOL stillRequested;
+            dispatch_sync(strongSelf.serialQueue, ^{
+                stillRequested = [strongSelf.requestedFrameIndexes containsIndex:frameIndex.unsignedIntegerValue];
+            });
+            UIImage *frame;
+            if (stillRequested) {
+                CGImageRef decodedFrame = ATLAnimatedImageCreateDecodedFrameAtIndex(strongSelf.imageSource, frameIndex.unsignedIntegerValue, strongSelf.maximumPixelSize);
+                if (decodedFrame) {
+                    frame = [UIImage imageWithCGImage:decodedFrame scale:strongSelf.scale orientation:UIImageOrientationUp];
+                    CGImageRelease(decodedFrame);
+                }
+            }
+            dispatch_sync(strongSelf.serialQueue, ^{
+                if ([strongSelf.requestedFrameIndexes containsIndex:frameIndex.unsignedIntegerValue]) {
+                    [strongSelf.requestedFrameIndexes removeIndex:frameIndex.unsignedIntegerValue];
+                    if (frame) {
+                        strongSelf.frames[frameIndex] = frame;
+                    }
+                }
+            });
+        }
+    });
+}
+
+#pragma mark - Notification Handlers
+
+- (void)didReceiveMemoryWarning:(NSNotification *)notification
+{
+    dispatch_sync(self.serialQueue, ^{
+        // Keep the poster frame, everything else is decoded again when the animation plays.
+        UIImage *posterFrame = self.frames[@0];
+        [self.frames removeAllObjects];
+        [self.requestedFrameIndexes removeAllIndexes];
+        if (posterFrame) {
+            self.frames[@0] = posterFrame;
+        }
+    });
+}
+
+@end
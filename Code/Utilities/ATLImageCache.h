@@ -0,0 +1,79 @@
+//
+//  ATLImageCache.h
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <UIKit/UIKit.h>
+@import LayerKit;
+
+NS_ASSUME_NONNULL_BEGIN
+/**
+ @abstract The `ATLImageCache` class is a process-wide cache of decoded and
+   scaled bitmaps of image message parts.
+ @discussion Images are keyed by the `LYRMessagePart` identifier and the
+   pixel size they were scaled to. Each entry costs the number of bytes its
+   bitmap occupies; once `totalCostLimit` is exceeded, the least recently
+   used entries are evicted. The cache is emptied on memory warnings.
+   All methods are thread safe.
+ */
+@interface ATLImageCache : NSObject
+
+/**
+ @abstract Returns the shared image cache.
+ */
++ (instancetype)sharedImageCache;
+
+/**
+ @abstract The maximum number of bytes the cached bitmaps may occupy.
+   Default is 1/16th of the physical memory, but no more than 64MB.
+ */
+@property (nonatomic) NSUInteger totalCostLimit;
+
+/**
+ @abstract The number of bytes the cached bitmaps currently occupy.
+ */
+@property (nonatomic, readonly) NSUInteger totalCost;
+
+/**
+ @abstract Returns the cached image of a message part.
+ @param messagePart The message part the image was decoded from.
+ @param pixelSize The pixel size the image was requested at. Pass `CGSizeZero` if the image was requested at its default size.
+ @return The decoded image, or `nil` if it isn't cached.
+ */
+- (nullable UIImage *)imageForMessagePart:(LYRMessagePart *)messagePart pixelSize:(CGSize)pixelSize;
+
+/**
+ @abstract Stores a decoded image of a message part.
+ @param image The decoded image. Should already be backed by a bitmap, otherwise the cost accounting won't reflect the memory used.
+ @param messagePart The message part the image was decoded from.
+ @param pixelSize The pixel size the image was requested at.
+ */
+- (void)setImage:(UIImage *)image forMessagePart:(LYRMessagePart *)messagePart pixelSize:(CGSize)pixelSize;
+
+/**
+ @abstract Removes all cached images of a message part, regardless of their pixel size.
+ */
+- (void)removeImagesForMessagePart:(LYRMessagePart *)messagePart;
+
+/**
+ @abstract Empties the cache.
+ */
+- (void)removeAllImages;
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,225 @@
+//
+//  ATLImageCache.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ATLImageCache.h"
+
+static char const ATLImageCacheSerialQueueName[] = "com.layer.Atlas.ATLImageCache.serialQueue";
+static NSUInteger const ATLImageCacheMaximumDefaultCostLimit = 64 * 1024 * 1024;
+
+/**
+ @abstract A node in the doubly linked recency list; the head is the most recently used entry.
+ */
+@interface ATLImageCacheEntry : NSObject
+
+@property (nonatomic) NSString *key;
+@property (nonatomic) NSURL *messagePartIdentifier;
+@property (nonatomic) UIImage *image;
+@property (nonatomic) NSUInteger cost;
+@property (nonatomic, weak) ATLImageCacheEntry *previous;
+@property (nonatomic) ATLImageCacheEntry *next;
+
+@end
+
+@implementation ATLImageCacheEntry
+
+@end
+
+static NSUInteger ATLImageCacheCostForImage(UIImage *image)
+{
+    CGImageRef imageRef = image.CGImage;
+    if (imageRef == NULL) {
+        return (NSUInteger)(image.size.width * image.scale * image.size.height * image.scale * 4);
+    }
+    return CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef);
+}
+
+@interface ATLImageCache ()
+
+@property (nonatomic) dispatch_queue_t serialQueue;
+@property (nonatomic) NSMutableDictionary <NSString *, ATLImageCacheEntry *> *entries;
+@property (nonatomic) ATLImageCacheEntry *head;
+@property (nonatomic, weak) ATLImageCacheEntry *tail;
+@property (nonatomic, readwrite) NSUInteger totalCost;
+
+@end
+
+@implementation ATLImageCache
+
++ (instancetype)sharedImageCache
+{
+    static ATLImageCache *sharedImageCache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedImageCache = [[self alloc] init];
+    });
+    return sharedImageCache;
+}
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        _serialQueue = dispatch_queue_create(ATLImageCacheSerialQueueName, DISPATCH_QUEUE_SERIAL);
+        _entries = [NSMutableDictionary new];
+        _totalCostLimit = (NSUInteger)MIN([NSProcessInfo processInfo].physicalMemory / 16, ATLImageCacheMaximumDefaultCostLimit);
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(removeAllImages) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark - Public Methods
+
+- (UIImage *)imageForMessagePart:(LYRMessagePart *)messagePart pixelSize:(CGSize)pixelSize
+{
+    if (!messagePart.identifier) {
+        return nil;
+    }
+    NSString *key = [self keyForMessagePartIdentifier:messagePart.identifier pixelSize:pixelSize];
+    __block UIImage *image;
+    dispatch_sync(self.serialQueue, ^{
+        ATLImageCacheEntry *entry = self.entries[key];
+        if (entry) {
+            [self moveEntryToHead:entry];
+            image = entry.image;
+        }
+    });
+    return image;
+}
+
+- (void)setImage:(UIImage *)image forMessagePart:(LYRMessagePart *)messagePart pixelSize:(CGSize)pixelSize
+{
+    if (!image || !messagePart.identifier) {
+        return;
+    }
+    ATLImageCacheEntry *entry = [ATLImageCacheEntry new];
+    entry.key = [self keyForMessagePartIdentifier:messagePart.identifier pixelSize:pixelSize];
+    entry.messagePartIdentifier = messagePart.identifier;
+    entry.image = image;
+    entry.cost = ATLImageCacheCostForImage(image);
+    dispatch_sync(self.serialQueue, ^{
+        ATLImageCacheEntry *existingEntry = self.entries[entry.key];
+        if (existingEntry) {
+            [self removeEntry:existingEntry];
+        }
+        self.entries[entry.key] = entry;
+        [self insertEntryAtHead:entry];
+        self.totalCost += entry.cost;
+        [self evictEntriesToCostLimit];
+    });
+}
+
+- (void)removeImagesForMessagePart:(LYRMessagePart *)messagePart
+{
+    NSURL *messagePartIdentifier = messagePart.identifier;
+    if (!messagePartIdentifier) {
+        return;
+    }
+    dispatch_sync(self.serialQueue, ^{
+        for (ATLImageCacheEntry *entry in self.entries.allValues) {
+            if ([entry.messagePartIdentifier isEqual:messagePartIdentifier]) {
+                [self removeEntry:entry];
+            }
+        }
+    });
+}
+
+- (void)removeAllImages
+{
+    dispatch_sync(self.serialQueue, ^{
+        [self.entries removeAllObjects];
+        self.head = nil;
+        self.tail = nil;
+        self.totalCost = 0;
+    });
+}
+
+- (void)setTotalCostLimit:(NSUInteger)totalCostLimit
+{
+    dispatch_sync(self.serialQueue, ^{
+        _totalCostLimit = totalCostLimit;
+        [self evictEntriesToCostLimit];
+    });
+}
+
+#pragma mark - Recency List (must be called on the serial queue)
+
+- (void)insertEntryAtHead:(ATLImageCacheEntry *)entry
+{
+    entry.previous = nil;
+    entry.next = self.head;
+    self.head.previous = entry;
+    self.head = entry;
+    if (!self.tail) {
+        self.tail = entry;
+    }
+}
+
+- (void)unlinkEntry:(ATLImageCacheEntry *)entry
+{
+    if (entry.previous) {
+        entry.previous.next = entry.next;
+    } else {
+        self.head = entry.next;
+    }
+    if (entry.next) {
+        entry.next.previous = entry.previous;
+    } else {
+        self.tail = entry.previous;
+    }
+    entry.previous = nil;
+    entry.next = nil;
+}
+
+- (void)moveEntryToHead:(ATLImageCacheEntry *)entry
+{
+    if (self.head == entry) {
+        return;
+    }
+    [self unlinkEntry:entry];
+    [self insertEntryAtHead:entry];
+}
+
+- (void)removeEntry:(ATLImageCacheEntry *)entry
+{
+    [self unlinkEntry:entry];
+    [self.entries removeObjectForKey:entry.key];
+    self.totalCost -= entry.cost;
+}
+
+- (void)evictEntriesToCostLimit
+{
+    while (self.totalCost > self.totalCostLimit && self.tail) {
+        [self removeEntry:self.tail];
+    }
+}
+
+#pragma mark - Helpers
+
+- (NSString *)keyForMessagePartIdentifier:(NSURL *)messagePartIdentifier pixelSize:(CGSize)pixelSize
+{
+    return [NSString stringWithFormat:@"%@#%.0fx%.0f", messagePartIdentifier.absoluteString, pixelSize.width, pixelSize.height];
+}
+
+@end
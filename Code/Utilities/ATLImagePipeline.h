@@ -0,0 +1,91 @@
+//
+//  ATLImagePipeline.h
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ @abstract The priority of an image request. Requests with a higher priority are
+   started before pending requests with a lower priority.
+ */
+typedef NS_ENUM(NSInteger, ATLImageRequestPriority) {
+    ATLImageRequestPriorityLow,
+    ATLImageRequestPriorityNormal,
+    ATLImageRequestPriorityHigh,
+};
+
+/**
+ @abstract A cancellation token for a unit of work enqueued on the `ATLImagePipeline`.
+ */
+@interface ATLImageRequest : NSObject
+
+/**
+ @abstract The priority of the request. Changing it has no effect once the request started decoding.
+ */
+@property (nonatomic) ATLImageRequestPriority priority;
+
+/**
+ @abstract Returns `YES` if the request has been cancelled. Long running decode
+   blocks may poll it to bail out early.
+ */
+@property (nonatomic, readonly, getter=isCancelled) BOOL cancelled;
+
+/**
+ @abstract Cancels the request. A pending request is dropped without ever being
+   decoded, and the completion of a cancelled request is never called.
+ @discussion Must be called on the main thread.
+ */
+- (void)cancel;
+
+@end
+
+/**
+ @abstract The `ATLImagePipeline` class runs image decoding work on a bounded
+   number of background workers shared by all message cells.
+ @discussion Unlike dispatching on a concurrent queue, pending requests don't
+   occupy a thread, can be reprioritized while waiting, and are dropped as soon
+   as they are cancelled, so flinging through a conversation doesn't spawn
+   threads or decode images for cells that already went off screen.
+ */
+@interface ATLImagePipeline : NSObject
+
+/**
+ @abstract Returns the shared image pipeline.
+ */
++ (instancetype)sharedImagePipeline;
+
+/**
+ @abstract The maximum number of requests decoded at the same time.
+   Default is the number of active processors, but no more than 4.
+ */
+@property (nonatomic) NSUInteger maximumConcurrentRequestCount;
+
+/**
+ @abstract Enqueues an image decode.
+ @param priority The initial priority of the request.
+ @param decodeBlock Called on a background worker to produce the image. Receives the request, so it can check for cancellation.
+ @param completion Called on the main thread with the decoded image, unless the request was cancelled in the meantime.
+ @return The request, which should be retained by the caller to cancel it or change its priority.
+ */
+- (ATLImageRequest *)requestImageWithPriority:(ATLImageRequestPriority)priority decodeBlock:(UIImage *__nullable (^)(ATLImageRequest *request))decodeBlock completion:(void (^)(UIImage *__nullable image))completion;
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,127 @@
+//
+//  ATLImagePipeline.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ATLImagePipeline.h"
+
+static NSString *const ATLImagePipelineOperationQueueName = @"com.layer.Atlas.ATLImagePipeline.operationQueue";
+static NSUInteger const ATLImagePipelineMaximumDefaultConcurrentRequestCount = 4;
+
+static NSOperationQueuePriority ATLOperationQueuePriorityForImageRequestPriority(ATLImageRequestPriority priority)
+{
+    switch (priority) {
+        case ATLImageRequestPriorityLow:
+            return NSOperationQueuePriorityLow;
+        case ATLImageRequestPriorityNormal:
+            return NSOperationQueuePriorityNormal;
+        case ATLImageRequestPriorityHigh:
+            return NSOperationQueuePriorityVeryHigh;
+    }
+    return NSOperationQueuePriorityNormal;
+}
+
+@interface ATLImageRequest ()
+
+@property (nonatomic, weak) NSOperation *operation;
+@property (atomic, readwrite, getter=isCancelled) BOOL cancelled;
+
+@end
+
+@implementation ATLImageRequest
+
+- (void)setPriority:(ATLImageRequestPriority)priority
+{
+    _priority = priority;
+    self.operation.queuePriority = ATLOperationQueuePriorityForImageRequestPriority(priority);
+}
+
+- (void)cancel
+{
+    self.cancelled = YES;
+    [self.operation cancel];
+}
+
+@end
+
+@interface ATLImagePipeline ()
+
+@property (nonatomic) NSOperationQueue *operationQueue;
+
+@end
+
+@implementation ATLImagePipeline
+
++ (instancetype)sharedImagePipeline
+{
+    static ATLImagePipeline *sharedImagePipeline;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedImagePipeline = [[self alloc] init];
+    });
+    return sharedImagePipeline;
+}
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        _operationQueue = [NSOperationQueue new];
+        _operationQueue.name = ATLImagePipelineOperationQueueName;
+        _operationQueue.qualityOfService = NSQualityOfServiceUserInitiated;
+        _operationQueue.maxConcurrentOperationCount = MIN([NSProcessInfo processInfo].activeProcessorCount, ATLImagePipelineMaximumDefaultConcurrentRequestCount);
+    }
+    return self;
+}
+
+#pragma mark - Public Methods
+
+- (NSUInteger)maximumConcurrentRequestCount
+{
+    return (NSUInteger)self.operationQueue.maxConcurrentOperationCount;
+}
+
+- (void)setMaximumConcurrentRequestCount:(NSUInteger)maximumConcurrentRequestCount
+{
+    self.operationQueue.maxConcurrentOperationCount = MAX(maximumConcurrentRequestCount, 1);
+}
+
+- (ATLImageRequest *)requestImageWithPriority:(ATLImageRequestPriority)priority decodeBlock:(UIImage *(^)(ATLImageRequest *request))decodeBlock completion:(void (^)(UIImage *image))completion
+{
+    ATLImageRequest *request = [ATLImageRequest new];
+    // The operation retains the request, not the other way around, so a finished request doesn't keep its decode block alive.
+    NSBlockOperation *operation = [NSBlockOperation blockOperationWithBlock:^{
+        if (request.isCancelled) {
+            return;
+        }
+        UIImage *image = decodeBlock(request);
+        dispatch_async(dispatch_get_main_queue(), ^{
+            // Cancellation happens on the main thread, so checking here guarantees a cancelled request never completes.
+            if (request.isCancelled) {
+                return;
+            }
+            completion(image);
+        });
+    }];
+    request.operation = operation;
+    request.priority = priority;
+    [self.operationQueue addOperation:operation];
+    return request;
+}
+
+@end
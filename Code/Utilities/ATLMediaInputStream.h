@@ -49,6 +49,14 @@ typedef NS_ENUM(NSUInteger, ATLMediaInputStreamError) {
      @abstract An error during video export process.
      */
     ATLMediaInputStreamErrorVideoExportFailed                      = 1005,
+    /**
+     @abstract An error to open stream if setting up the fragmented video writer failed.
+     */
+    ATLMediaInputStreamErrorFailedInitializingVideoWriter          = 1006,
+    /**
+     @abstract An error to open stream when the video can't be encoded within the `maximumFileSize`.
+     */
+    ATLMediaInputStreamErrorVideoExceedsMaximumFileSize            = 1007,
 };
 
 /**
@@ -145,5 +153,56 @@ typedef NS_ENUM(NSUInteger, ATLMediaInputStreamError) {
  */
 @property (nonatomic) float compressionQuality;
 
+/**
+ @abstract The average bitrate in bits per second the video output should
+   aim for (audio included). Default is set to 0.
+ @discussion If set, the resolution, frame rate and encoder bitrate are picked
+   from the source track's dimensions and duration to fit the budget.
+   If set to zero `0`, the encoder preset is picked by `compressionQuality`.
+ */
+@property (nonatomic) NSUInteger targetBitrate;
+
+/**
+ @abstract The maximum size in bytes of the video output. Default is set to 0.
+ @discussion If set, the encoding is picked so the output fits. Opening the
+   stream fails with `ATLMediaInputStreamErrorVideoExceedsMaximumFileSize`
+   when the video can't fit even at the lowest supported quality.
+ */
+@property (nonatomic) NSUInteger maximumFileSize;
+
+/**
+ @abstract The estimated size in bytes of the video output.
+ @discussion Available after the stream is opened and before any encoding
+   takes place, so oversized sends can be stopped early. Returns 0 for images.
+   With a `targetBitrate` or `maximumFileSize` it is derived from the picked
+   encoder bitrates; otherwise it is the export preset's own estimate, or, if
+   the preset can't estimate, an upper bound based on the source data rate.
+ */
+@property (nonatomic, readonly) NSUInteger estimatedOutputSize;
+
+/**
+ @abstract The capacity in bytes of the buffer between the media encoder and
+   the receiver. Default is set to 512KB.
+ @discussion The encoder keeps producing data until the buffer fills up,
+   so larger capacities keep more chunks in flight at the cost of memory.
+   The value is rounded up to the next power of two and has to be set
+   before the first `read:maxLength:` call. Unless `videoFragmentInterval`
+   is set, video streams are read directly from the exported file and don't
+   use this buffer.
+ */
+@property (nonatomic) NSUInteger transferBufferCapacity;
+
+/**
+ @abstract The duration in seconds of fragments produced while streaming
+   a video. Default is set to 0.
+ @discussion If set to a positive value, videos are transcoded into
+   fragmented MP4 and every finished fragment becomes readable while the
+   encoder is still working on the rest of the clip, so the time to the first
+   byte depends on the fragment duration instead of the clip length.
+   Requires iOS 14 or newer; otherwise, or if set to zero `0`, the whole
+   video is exported before streaming starts.
+ */
+@property (nonatomic) NSTimeInterval videoFragmentInterval;
+
 @end
 NS_ASSUME_NONNULL_END
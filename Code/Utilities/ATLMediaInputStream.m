@@ -21,7 +21,13 @@
 #import "ATLMediaInputStream.h"
 #import <ImageIO/ImageIO.h>
 #import <MobileCoreServices/MobileCoreServices.h>
+#import <stdatomic.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
 @import AVFoundation;
+#if __IPHONE_OS_VERSION_MAX_ALLOWED >= 140000
+@import UniformTypeIdentifiers;
+#endif
 
 #ifdef DEBUG_ATLMediaInputStreamLog
 #define ATLMediaInputStreamLog(fmt, ...) NSLog(fmt, ##__VA_ARGS__)
@@ -31,10 +37,14 @@
 
 NSString *const ATLMediaInputStreamErrorDomain = @"com.layer.Atlas.ATLMediaInputStream";
 static char const ATLMediaInputConsumerAsyncQueueName[] = "com.layer.Atlas.ATLMediaInputStream.asyncConsumerQueue";
-static char const ATLMediaInputConsumerSerialTransferQueueName[] = "com.layer.Atlas.ATLMediaInputStream.serialTransferQueue";
 static char const ATLMediaInputStreamAsyncToBlockingQueueName[] = "com.layer.Atlas.ATLMediaInputStream.blocking";
+static char const ATLMediaInputVideoTranscodingQueueName[] = "com.layer.Atlas.ATLMediaInputStream.videoTranscodingQueue";
 NSString *const ATLMediaInputStreamAppleCameraTIFFOptionsKey = @"{TIFF}";
-static NSUInteger const ATLMediaInputDefaultFileStreamBuffer = 1024 * 1024;
+static NSUInteger const ATLMediaInputVideoMappingWindowSize = 4 * 1024 * 1024;
+static float const ATLMediaInputVideoMinimumBitsPerPixel = 0.07f;
+static NSUInteger const ATLMediaInputVideoMinimumBitrate = 100 * 1000;
+static double const ATLMediaInputVideoContainerOverhead = 0.02;
+static NSUInteger const ATLMediaInputDefaultTransferBufferCapacity = 512 * 1024;
 NSString *const ATLMediaInputStreamTempDirectory = @"com.layer.atlas";
 
 /* Core I/O callbacks */
@@ -42,6 +52,30 @@ ALAsset *ATLMediaInputStreamAssetForAssetURL(NSURL *assetURL, ALAssetsLibrary *a
 static size_t ATLMediaInputStreamGetBytesFromAssetCallback(void *assetStreamRef, void *buffer, off_t offset, size_t length);
 static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef, const void *buffer, size_t length);
 
+/* Video encoder settings derived from the source track and the size/bitrate budget */
+typedef struct {
+    CGSize dimensions;
+    float frameRate;
+    NSUInteger videoBitrate; // 0 leaves it up to the encoder
+    NSUInteger audioBitrate;
+} ATLMediaInputVideoEncoding;
+
+static ATLMediaInputVideoEncoding ATLMediaInputVideoEncodingForSource(CGSize sourceDimensions, float sourceFrameRate, NSTimeInterval duration, BOOL hasAudio, NSUInteger targetBitrate, NSUInteger maximumFileSize, NSUInteger maximumSize);
+static NSUInteger ATLMediaInputVideoEstimatedFileSize(double bitrate, NSTimeInterval duration);
+
+/* Single-producer/single-consumer transfer ring buffer */
+typedef struct {
+    uint8_t *bytes;
+    size_t capacity; // always a power of two
+    atomic_size_t writeCount;
+    atomic_size_t readCount;
+} ATLMediaInputStreamRingBuffer;
+
+static ATLMediaInputStreamRingBuffer *ATLMediaInputStreamRingBufferCreate(size_t capacity);
+static void ATLMediaInputStreamRingBufferFree(ATLMediaInputStreamRingBuffer *ringBuffer);
+static size_t ATLMediaInputStreamRingBufferWrite(ATLMediaInputStreamRingBuffer *ringBuffer, const uint8_t *bytes, size_t length);
+static size_t ATLMediaInputStreamRingBufferRead(ATLMediaInputStreamRingBuffer *ringBuffer, uint8_t *bytes, size_t length);
+
 @interface ATLMediaInputStream ()
 
 /* Private and public properties */
@@ -50,6 +84,7 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
 @property (nonatomic, readwrite) UIImage *sourceImage;
 @property (nonatomic, readwrite) NSDictionary *metadata;
 @property (nonatomic, readwrite) BOOL isLossless;
+@property (nonatomic, readwrite) NSUInteger estimatedOutputSize;
 @property (nonatomic) NSStreamStatus mediaStreamStatus;
 @property (nonatomic) NSError *mediaStreamError;
 
@@ -57,12 +92,14 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
 @property (nonatomic) dispatch_semaphore_t streamFlowRequesterSemaphore;
 @property (nonatomic) dispatch_semaphore_t streamFlowProviderSemaphore;
 @property (nonatomic) dispatch_queue_t consumerAsyncQueue;
-@property (nonatomic) dispatch_queue_t transferBufferSerialGuard;
 
 /* Stream flow control (shared between ATLMediaInputStream API and Image I/O */
-@property (nonatomic) NSData *dataConsumed;
-@property (nonatomic) NSUInteger numberOfBytesRequested;
-@property (nonatomic) NSUInteger numberOfBytesProvided;
+@property (nonatomic, assign) ATLMediaInputStreamRingBuffer *transferBuffer;
+@property (atomic) BOOL transferCompleted;
+@property (atomic) BOOL transferCancelled;
+
+- (BOOL)writeBytesToTransferBuffer:(const uint8_t *)bytes length:(NSUInteger)length;
+- (void)finishTransferWithError:(NSError *)error;
 
 /* References needed by ALAsset, Core Graphics and Image I/O used during transfer */
 @property (nonatomic) ALAssetsLibrary *assetLibrary; // needs to be alive during transfer
@@ -79,13 +116,37 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
 @property (nonatomic, assign) CGDataConsumerRef consumer;
 @property (nonatomic, assign) CGImageDestinationRef destination;
 @property (nonatomic) NSDictionary *sourceImageProperties;
+@property (nonatomic) dispatch_group_t consumerGroup;
 
 @end
 
+#if __IPHONE_OS_VERSION_MAX_ALLOWED >= 140000
+@interface ATLAssetVideoInputStream : ATLMediaInputStream <AVAssetWriterDelegate>
+#else
 @interface ATLAssetVideoInputStream : ATLMediaInputStream
+#endif
 
 @property (nonatomic, strong) AVAssetExportSession *videoAssetExportSession;
 
+@property (nonatomic) NSURL *exportedFileURL;
+@property (nonatomic) ATLMediaInputVideoEncoding videoEncoding;
+
+/* Transcoding export (AVAssetReader -> AVAssetWriter) used for fragments or size/bitrate budgets */
+@property (nonatomic, strong) AVAssetReader *videoAssetReader;
+@property (nonatomic, strong) AVAssetWriter *videoAssetWriter;
+@property (nonatomic, strong) NSArray <AVAssetReaderOutput *> *videoAssetReaderOutputs;
+@property (nonatomic, strong) NSArray <AVAssetWriterInput *> *videoAssetWriterInputs;
+@property (nonatomic) dispatch_queue_t videoTranscodingQueue;
+@property (nonatomic) BOOL exportsVideoFragments;
+
+/* Memory mapped view of the exported video file */
+@property (nonatomic) int exportedFileDescriptor;
+@property (nonatomic) off_t exportedFileLength;
+@property (nonatomic) off_t exportedFileOffset;
+@property (nonatomic, assign) uint8_t *mappedWindow;
+@property (nonatomic) off_t mappedWindowOffset;
+@property (nonatomic) size_t mappedWindowLength;
+
 - (instancetype)initWithAssetURL:(NSURL *)assetURL;
 
 @end
@@ -168,6 +229,12 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
 {
     [super close];
     
+    // Closing unblocks the consumer, which has to unwind out of `CGImageDestinationFinalize()` before the references it uses are released.
+    if (self.consumerGroup) {
+        dispatch_group_wait(self.consumerGroup, DISPATCH_TIME_FOREVER);
+        self.consumerGroup = nil;
+    }
+    
     // Release Image I/O references
     if (_destination != NULL) {
         CFRelease(_destination);
@@ -193,28 +260,22 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
 
 - (void)startConsumption
 {
-    dispatch_sync(self.transferBufferSerialGuard, ^{
-        self.mediaStreamStatus = NSStreamStatusReading;
-        dispatch_async(self.consumerAsyncQueue, ^{
-            // This will cause the Image I/O consumer to start transfering
-            // image data on a async queue.
-            ATLMediaInputStreamLog(@"input stream: starting the consumer...");
-            BOOL success;
-            success = CGImageDestinationFinalize(self.destination);
-            if (!success) {
-                self.mediaStreamError = [NSError errorWithDomain:ATLMediaInputStreamErrorDomain code:ATLMediaInputStreamErrorFailedFinalizingDestination userInfo:nil];
-                ATLMediaInputStreamLog(@"input stream failed to finalize image destination with %@", self.mediaStreamError);
-            }
-            ATLMediaInputStreamLog(@"input stream: stopping the consumer...");
-            
-            // Notify requester that consumer is done.
-            dispatch_semaphore_signal(self.streamFlowRequesterSemaphore);
-            if (!success) {
-                self.mediaStreamStatus = NSStreamStatusError;
-            } else {
-                self.mediaStreamStatus = NSStreamStatusAtEnd;
-            }
-        });
+    self.mediaStreamStatus = NSStreamStatusReading;
+    self.consumerGroup = dispatch_group_create();
+    dispatch_group_async(self.consumerGroup, self.consumerAsyncQueue, ^{
+        // This will cause the Image I/O consumer to start transfering
+        // image data on a async queue.
+        ATLMediaInputStreamLog(@"input stream: starting the consumer...");
+        NSError *error;
+        BOOL success = CGImageDestinationFinalize(self.destination);
+        if (!success) {
+            error = [NSError errorWithDomain:ATLMediaInputStreamErrorDomain code:ATLMediaInputStreamErrorFailedFinalizingDestination userInfo:nil];
+            ATLMediaInputStreamLog(@"input stream failed to finalize image destination with %@", error);
+        }
+        ATLMediaInputStreamLog(@"input stream: stopping the consumer...");
+        
+        // Notify requester that consumer is done.
+        [self finishTransferWithError:error];
     });
 }
 
@@ -482,7 +543,7 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
 
 - (instancetype)initWithAssetURL:(NSURL *)assetURL
 {
-    self = [super init];
+    self = [self init];
     if (self) {
         if (!assetURL) {
             @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:[NSString stringWithFormat:@"Cannot initialize %@ with `nil` assetURL.", self.class] userInfo:nil];
@@ -492,12 +553,54 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
     return self;
 }
 
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        _exportedFileDescriptor = -1;
+        _mappedWindow = NULL;
+    }
+    return self;
+}
+
 - (void)open
 {
     [super open];
     
     // Prepare the AVAsset (works with both ALAsset and files).
     AVAsset *videoAVAsset = [AVAsset assetWithURL:self.sourceAssetURL ?: self.sourceFileURL];
+    
+    // Pick the encoding and let the receiver know how large the output will be.
+    AVAssetTrack *videoTrack = [videoAVAsset tracksWithMediaType:AVMediaTypeVideo].firstObject;
+    AVAssetTrack *audioTrack = [videoAVAsset tracksWithMediaType:AVMediaTypeAudio].firstObject;
+    CGSize orientedSize = CGSizeApplyAffineTransform(videoTrack.naturalSize, videoTrack.preferredTransform);
+    NSTimeInterval duration = CMTimeGetSeconds(videoAVAsset.duration);
+    self.videoEncoding = ATLMediaInputVideoEncodingForSource(CGSizeMake(fabs(orientedSize.width), fabs(orientedSize.height)), videoTrack.nominalFrameRate, duration, audioTrack != nil, self.targetBitrate, self.maximumFileSize, self.maximumSize);
+    if (self.videoEncoding.videoBitrate > 0) {
+        self.estimatedOutputSize = ATLMediaInputVideoEstimatedFileSize(self.videoEncoding.videoBitrate + self.videoEncoding.audioBitrate, duration);
+    } else {
+        // Replaced by the export session's own estimate below when it has one; the source data rate is only an upper bound,
+        // as the presets re-encode the video at the same or a lower quality.
+        self.estimatedOutputSize = ATLMediaInputVideoEstimatedFileSize(videoTrack.estimatedDataRate + audioTrack.estimatedDataRate, duration);
+    }
+    if (self.maximumFileSize > 0 && self.estimatedOutputSize > self.maximumFileSize) {
+        self.mediaStreamError = [NSError errorWithDomain:ATLMediaInputStreamErrorDomain code:ATLMediaInputStreamErrorVideoExceedsMaximumFileSize userInfo:@{ NSLocalizedDescriptionKey: @"The video can't be encoded within the maximum file size.", @"estimatedOutputSize": @(self.estimatedOutputSize) }];
+        self.mediaStreamStatus = NSStreamStatusError;
+        return;
+    }
+
+    // Transcode with explicit encoder settings when streaming fragments or
+    // when the output has to fit a bitrate or size budget.
+    if ([self shouldExportVideoFragments] || self.targetBitrate > 0 || self.maximumFileSize > 0) {
+        NSError *error;
+        if (![self setupTranscodingExportWithAsset:videoAVAsset error:&error]) {
+            self.mediaStreamError = error;
+            self.mediaStreamStatus = NSStreamStatusError;
+            return;
+        }
+        self.mediaStreamStatus = NSStreamStatusOpen;
+        return;
+    }
 
     // Set the appropriate encoder preset based on the self.compressionQuality.
     NSString *encoderPresetName;
@@ -521,20 +624,17 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
         }
     }
     
-    // Prepare the temporary file URL (it should be a member property).
-    NSArray *paths = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES);
-    NSString *basePath = ([paths count] > 0) ? [paths objectAtIndex:0] : nil;
-    NSURL *baseURL = [NSURL fileURLWithPath:basePath isDirectory:YES];
-    NSURL *outputDirURL = [NSURL URLWithString:ATLMediaInputStreamTempDirectory relativeToURL:baseURL];
-    NSURL *outputURL = [NSURL URLWithString:[NSString stringWithFormat:@"exported-video-%@.mp4", [[NSUUID UUID] UUIDString]] relativeToURL:outputDirURL];
-    [[NSFileManager defaultManager] createDirectoryAtURL:outputDirURL withIntermediateDirectories:YES attributes:nil error:nil];
-    [[NSFileManager defaultManager] removeItemAtURL:outputURL error:nil];
-    
     // Prepare the AVExportSession (use the temp file url).
+    self.exportedFileURL = [self temporaryExportFileURL];
     self.videoAssetExportSession = [[AVAssetExportSession alloc] initWithAsset:videoAVAsset presetName:encoderPresetName];
-    self.videoAssetExportSession.outputURL = outputURL.absoluteURL;
+    self.videoAssetExportSession.outputURL = self.exportedFileURL;
     self.videoAssetExportSession.outputFileType = AVFileTypeMPEG4;
     self.videoAssetExportSession.shouldOptimizeForNetworkUse = YES;
+    self.videoAssetExportSession.timeRange = CMTimeRangeMake(kCMTimeZero, videoAVAsset.duration);
+    long long presetEstimatedOutputSize = self.videoAssetExportSession.estimatedOutputFileLength;
+    if (presetEstimatedOutputSize > 0) {
+        self.estimatedOutputSize = (NSUInteger)presetEstimatedOutputSize;
+    }
     
     // Success
     self.mediaStreamStatus = NSStreamStatusOpen;
@@ -543,96 +643,389 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
 - (void)close
 {
     [super close];
+    // Tear down the mapping before the file goes away.
+    [self unmapWindow];
+    if (self.exportedFileDescriptor >= 0) {
+        close(self.exportedFileDescriptor);
+        self.exportedFileDescriptor = -1;
+    }
+    // Stop the transcoding export, if any.
+    if (self.videoAssetReader.status == AVAssetReaderStatusReading) {
+        [self.videoAssetReader cancelReading];
+    }
+    if (self.videoAssetWriter.status == AVAssetWriterStatusWriting) {
+        [self.videoAssetWriter cancelWriting];
+    }
+    self.videoAssetReader = nil;
+    self.videoAssetWriter = nil;
+    self.videoAssetReaderOutputs = nil;
+    self.videoAssetWriterInputs = nil;
     // Delete the temporary file at path where the video was exported to.
-    if (self.videoAssetExportSession.outputURL) {
-        [[NSFileManager defaultManager] removeItemAtURL:self.videoAssetExportSession.outputURL error:nil];
+    if (self.exportedFileURL) {
+        [[NSFileManager defaultManager] removeItemAtURL:self.exportedFileURL error:nil];
+        self.exportedFileURL = nil;
     }
     // Nil out export session and do other cleanups.
     self.videoAssetExportSession = nil;
-    self.dataConsumed = nil;
     self.mediaStreamStatus = NSStreamStatusClosed;
 }
 
 - (void)startConsumption
 {
     self.mediaStreamStatus = NSStreamStatusReading;
+    if (self.videoAssetWriter) {
+        [self startTranscodingConsumption];
+        return;
+    }
     [self.videoAssetExportSession exportAsynchronouslyWithCompletionHandler:^{
         switch (self.videoAssetExportSession.status) {
             case AVAssetExportSessionStatusFailed: {
-                ATLMediaInputStreamLog(@"consumer: failed exporting the video with error=%@", self.exportSession.error);
-                self.mediaStreamError = self.videoAssetExportSession.error;
-                self.mediaStreamStatus = NSStreamStatusError;
-                dispatch_semaphore_signal(self.streamFlowRequesterSemaphore);
+                ATLMediaInputStreamLog(@"consumer: failed exporting the video with error=%@", self.videoAssetExportSession.error);
+                [self finishTransferWithError:self.videoAssetExportSession.error];
                 break;
             }
             case AVAssetExportSessionStatusCompleted: {
                 ATLMediaInputStreamLog(@"consumer: export completed");
-                [self consumeData];
+                NSError *error;
+                [self openExportedFileWithError:&error];
+                [self finishTransferWithError:error];
                 break;
             }
             default: {
-                self.mediaStreamError = [NSError errorWithDomain:ATLMediaInputStreamErrorDomain code:ATLMediaInputStreamErrorVideoExportFailed userInfo:@{ NSLocalizedDescriptionKey: @"Could not export the video.", @"exporterror": self.videoAssetExportSession.error ?: [NSNull null], @"exportstatus": @(self.videoAssetExportSession.status) }];
-                self.mediaStreamStatus = NSStreamStatusError;
-                ATLMediaInputStreamLog(@"consumer: failed exporting the video with error=%@", self.mediaStreamError);
-                dispatch_semaphore_signal(self.streamFlowRequesterSemaphore);
+                NSError *error = [NSError errorWithDomain:ATLMediaInputStreamErrorDomain code:ATLMediaInputStreamErrorVideoExportFailed userInfo:@{ NSLocalizedDescriptionKey: @"Could not export the video.", @"exporterror": self.videoAssetExportSession.error ?: [NSNull null], @"exportstatus": @(self.videoAssetExportSession.status) }];
+                ATLMediaInputStreamLog(@"consumer: failed exporting the video with error=%@", error);
+                [self finishTransferWithError:error];
                 break;
             }
         }
     }];
 }
 
-- (void)consumeData
+- (NSInteger)read:(uint8_t *)buffer maxLength:(NSUInteger)bytesToConsume
 {
-    NSInputStream *exportedVideoFileInputStream = [[NSInputStream alloc]initWithURL:self.videoAssetExportSession.outputURL];
-    NSMutableData *dataFromStream = [NSMutableData data];
-    uint8_t *buffer = malloc(ATLMediaInputDefaultFileStreamBuffer);
-    NSInteger bytesRead;
+    // Fragments are passed through the transfer buffer as they're written.
+    if (self.exportsVideoFragments) {
+        return [super read:buffer maxLength:bytesToConsume];
+    }
     
-    // Open the expoted video file input stream.
-    [exportedVideoFileInputStream open];
+    if (self.mediaStreamStatus == NSStreamStatusOpen) {
+        [self startConsumption];
+    }
     
-    if (exportedVideoFileInputStream.streamStatus != NSStreamStatusOpen) {
-        self.mediaStreamError = exportedVideoFileInputStream.streamError;
-        self.mediaStreamStatus = exportedVideoFileInputStream.streamStatus;
-        dispatch_semaphore_signal(self.streamFlowRequesterSemaphore);
-        return;
+    // If already completed
+    if (self.mediaStreamStatus == NSStreamStatusAtEnd) {
+        return 0; // EOS
     }
     
-    do {
-        bytesRead = [exportedVideoFileInputStream read:buffer maxLength:MIN(ATLMediaInputDefaultFileStreamBuffer, self.numberOfBytesRequested)];
-        if (bytesRead != 0) {
-            [dataFromStream appendBytes:buffer length:self.numberOfBytesRequested];
-        } else if (bytesRead < 0) {
-            self.mediaStreamStatus = exportedVideoFileInputStream.streamStatus;
-            self.mediaStreamError = exportedVideoFileInputStream.streamError;
-            ATLMediaInputStreamLog(@"consumer: failed streaming the exported video file with error=%@", exportedVideoFileInputStream.streamError);
-            break;
+    // Cannot provide data, if not in reading state.
+    if (self.mediaStreamStatus != NSStreamStatusReading) {
+        return -1; // Operation fails
+    }
+    
+    // Wait for the export session to finish writing the file.
+    while (!self.transferCompleted && self.mediaStreamStatus == NSStreamStatusReading) {
+        ATLMediaInputStreamLog(@"input stream: waiting for the export to complete");
+        dispatch_semaphore_wait(self.streamFlowRequesterSemaphore, DISPATCH_TIME_FOREVER);
+    }
+    if (self.mediaStreamStatus == NSStreamStatusError) {
+        return -1; // Operation failed, see self.streamError;
+    }
+    if (self.mediaStreamStatus != NSStreamStatusReading) {
+        return 0; // Closed while waiting.
+    }
+    
+    if (self.exportedFileOffset >= self.exportedFileLength) {
+        [self unmapWindow];
+        self.mediaStreamStatus = NSStreamStatusAtEnd;
+        return 0; // EOS
+    }
+    
+    NSError *error;
+    if (![self mapWindowAtOffset:self.exportedFileOffset error:&error]) {
+        self.mediaStreamError = error;
+        self.mediaStreamStatus = NSStreamStatusError;
+        return -1;
+    }
+    
+    // Copy straight out of the mapped file.
+    size_t windowPosition = (size_t)(self.exportedFileOffset - self.mappedWindowOffset);
+    size_t bytesConsumed = MIN(bytesToConsume, self.mappedWindowLength - windowPosition);
+    memcpy(buffer, self.mappedWindow + windowPosition, bytesConsumed);
+    self.exportedFileOffset += bytesConsumed;
+    ATLMediaInputStreamLog(@"input stream: passed %lu bytes to receiver", bytesConsumed);
+    return bytesConsumed;
+}
+
+/**
+ @abstract Opens the file the video was exported to, so it can be mapped into memory.
+ @param error A reference to an `NSError` object that will contain error information in case the action was not successful.
+ @return Returns `YES` if the file was opened; On failures, method sets the `error` and returns `NO`.
+ */
+- (BOOL)openExportedFileWithError:(NSError **)error
+{
+    int fileDescriptor = open(self.exportedFileURL.path.fileSystemRepresentation, O_RDONLY);
+    struct stat fileStat;
+    if (fileDescriptor < 0 || fstat(fileDescriptor, &fileStat) != 0) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{ NSLocalizedDescriptionKey: @"Failed opening the exported video file." }];
         }
-        // Consumption continues, after flow control logic in readBytes:len: signals it.
-        dispatch_sync(self.transferBufferSerialGuard, ^{
-            ATLMediaInputStreamLog(@"consumer: waiting for request from stream (have %lu bytes ready)", bytesRead);
-            dispatch_semaphore_wait(self.streamFlowProviderSemaphore, DISPATCH_TIME_FOREVER);
-        });
-        
-        // Copy buffer into NSData that was consumed by the file input stream.
-        NSUInteger bytesConsumed = MIN(self.numberOfBytesRequested, bytesRead);
-        NSData *dataConsumed = [NSData dataWithBytes:buffer length:bytesConsumed];
-        self.dataConsumed = dataConsumed;
-        ATLMediaInputStreamLog(@"consumer: consumed %lu bytes (requested %lu bytes, provided %lu bytes)", (unsigned long)dataConsumed.length, (unsigned long)assetStream.numberOfBytesRequested, length);
+        if (fileDescriptor >= 0) {
+            close(fileDescriptor);
+        }
+        return NO;
+    }
+    self.exportedFileDescriptor = fileDescriptor;
+    self.exportedFileLength = fileStat.st_size;
+    self.exportedFileOffset = 0;
+    return YES;
+}
+
+/**
+ @abstract Maps a window of the exported file that contains the `offset`.
+ @discussion Only a single window of `ATLMediaInputVideoMappingWindowSize` bytes
+   is mapped at a time, and windows the receiver is done with are unmapped,
+   so the resident memory stays the same regardless of the video size.
+ @param offset The file offset that needs to be readable.
+ @param error A reference to an `NSError` object that will contain error information in case the action was not successful.
+ @return Returns `YES` if the window is mapped; On failures, method sets the `error` and returns `NO`.
+ */
+- (BOOL)mapWindowAtOffset:(off_t)offset error:(NSError **)error
+{
+    if (self.mappedWindow != NULL && offset >= self.mappedWindowOffset && offset < self.mappedWindowOffset + (off_t)self.mappedWindowLength) {
+        return YES;
+    }
+    [self unmapWindow];
+    
+    off_t windowOffset = offset - (offset % getpagesize());
+    size_t windowLength = (size_t)MIN((off_t)ATLMediaInputVideoMappingWindowSize, self.exportedFileLength - windowOffset);
+    void *window = mmap(NULL, windowLength, PROT_READ, MAP_PRIVATE, self.exportedFileDescriptor, windowOffset);
+    if (window == MAP_FAILED) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{ NSLocalizedDescriptionKey: @"Failed mapping the exported video file into memory." }];
+        }
+        return NO;
+    }
+    madvise(window, windowLength, MADV_SEQUENTIAL);
+    self.mappedWindow = window;
+    self.mappedWindowOffset = windowOffset;
+    self.mappedWindowLength = windowLength;
+    return YES;
+}
+
+- (void)unmapWindow
+{
+    if (self.mappedWindow != NULL) {
+        munmap(self.mappedWindow, self.mappedWindowLength);
+        self.mappedWindow = NULL;
+        self.mappedWindowOffset = 0;
+        self.mappedWindowLength = 0;
+    }
+}
+
+#pragma mark - Transcoding Export
+
+- (BOOL)shouldExportVideoFragments
+{
+    if (self.videoFragmentInterval <= 0) {
+        return NO;
+    }
+#if __IPHONE_OS_VERSION_MAX_ALLOWED >= 140000
+    if (@available(iOS 14.0, *)) {
+        return YES;
+    }
+#endif
+    return NO;
+}
+
+/**
+ @abstract Creates a unique file URL in the caches directory the video can be exported to.
+ */
+- (NSURL *)temporaryExportFileURL
+{
+    NSArray *paths = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES);
+    NSString *basePath = ([paths count] > 0) ? [paths objectAtIndex:0] : nil;
+    NSURL *baseURL = [NSURL fileURLWithPath:basePath isDirectory:YES];
+    NSURL *outputDirURL = [NSURL URLWithString:ATLMediaInputStreamTempDirectory relativeToURL:baseURL];
+    NSURL *outputURL = [NSURL URLWithString:[NSString stringWithFormat:@"exported-video-%@.mp4", [[NSUUID UUID] UUIDString]] relativeToURL:outputDirURL];
+    [[NSFileManager defaultManager] createDirectoryAtURL:outputDirURL withIntermediateDirectories:YES attributes:nil error:nil];
+    [[NSFileManager defaultManager] removeItemAtURL:outputURL error:nil];
+    return outputURL.absoluteURL;
+}
+
+/**
+ @abstract Prepares an `AVAssetReader` and `AVAssetWriter` pair which transcode the video with the settings in `self.videoEncoding`.
+ @discussion When fragments are requested, the writer produces fragmented MP4 and every fragment
+   is handed to the transfer buffer as soon as it's finished, so the receiver can start reading
+   while the rest of the clip is still being encoded. Otherwise the writer outputs to a temporary file.
+ @param asset The source `AVAsset`.
+ @param error A reference to an `NSError` object that will contain error information in case the action was not successful.
+ @return Returns `YES` if setup was successful; On failures, method sets the `error` and returns `NO`.
+ */
+- (BOOL)setupTranscodingExportWithAsset:(AVAsset *)asset error:(NSError **)error
+{
+    NSError *readerError;
+    AVAssetReader *assetReader = [[AVAssetReader alloc] initWithAsset:asset error:&readerError];
+    if (!assetReader) {
+        if (error) {
+            *error = readerError;
+        }
+        return NO;
+    }
+    
+    AVAssetWriter *assetWriter;
+    BOOL exportsVideoFragments = [self shouldExportVideoFragments];
+    if (exportsVideoFragments) {
+#if __IPHONE_OS_VERSION_MAX_ALLOWED >= 140000
+        if (@available(iOS 14.0, *)) {
+            assetWriter = [[AVAssetWriter alloc] initWithContentType:[UTType typeWithIdentifier:AVFileTypeMPEG4]];
+            assetWriter.outputFileTypeProfile = AVFileTypeProfileMPEG4AppleHLS;
+            assetWriter.preferredOutputSegmentInterval = CMTimeMakeWithSeconds(self.videoFragmentInterval, 1000);
+            assetWriter.initialSegmentStartTime = kCMTimeZero;
+            assetWriter.delegate = self;
+        }
+#endif
+    } else {
+        NSError *writerError;
+        self.exportedFileURL = [self temporaryExportFileURL];
+        assetWriter = [[AVAssetWriter alloc] initWithURL:self.exportedFileURL fileType:AVFileTypeMPEG4 error:&writerError];
+        if (!assetWriter) {
+            if (error) {
+                *error = writerError;
+            }
+            return NO;
+        }
+    }
+    assetWriter.shouldOptimizeForNetworkUse = YES;
+    
+    NSMutableArray *readerOutputs = [NSMutableArray array];
+    NSMutableArray *writerInputs = [NSMutableArray array];
+    ATLMediaInputVideoEncoding encoding = self.videoEncoding;
+    NSArray *videoTracks = [asset tracksWithMediaType:AVMediaTypeVideo];
+    if (videoTracks.count) {
+        // The video composition applies the track's orientation and resamples the frame rate.
+        AVMutableVideoComposition *videoComposition = [AVMutableVideoComposition videoCompositionWithPropertiesOfAsset:asset];
+        videoComposition.frameDuration = CMTimeMakeWithSeconds(1.0 / encoding.frameRate, 600);
+        AVAssetReaderVideoCompositionOutput *videoOutput = [AVAssetReaderVideoCompositionOutput assetReaderVideoCompositionOutputWithVideoTracks:videoTracks videoSettings:@{ (NSString *)kCVPixelBufferPixelFormatTypeKey: @(kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange) }];
+        videoOutput.videoComposition = videoComposition;
         
-        // Signal the requester data is ready for consumption.
-        dispatch_semaphore_signal(self.streamFlowRequesterSemaphore);
-        ATLMediaInputStreamLog(@"return %lu", (unsigned long)bytesConsumed);
-    } while (bytesRead != 0);
-    [exportedVideoFileInputStream close];
+        NSMutableDictionary *compressionProperties = [NSMutableDictionary dictionaryWithObject:@(encoding.frameRate) forKey:AVVideoExpectedSourceFrameRateKey];
+        if (encoding.videoBitrate > 0) {
+            [compressionProperties setObject:@(encoding.videoBitrate) forKey:AVVideoAverageBitRateKey];
+        }
+        if (exportsVideoFragments) {
+            [compressionProperties setObject:@(self.videoFragmentInterval) forKey:AVVideoMaxKeyFrameIntervalDurationKey];
+        }
+        NSDictionary *videoSettings = @{ AVVideoCodecKey: AVVideoCodecH264,
+                                         AVVideoWidthKey: @(encoding.dimensions.width),
+                                         AVVideoHeightKey: @(encoding.dimensions.height),
+                                         AVVideoScalingModeKey: AVVideoScalingModeResizeAspect,
+                                         AVVideoCompressionPropertiesKey: compressionProperties };
+        AVAssetWriterInput *videoInput = [AVAssetWriterInput assetWriterInputWithMediaType:AVMediaTypeVideo outputSettings:videoSettings];
+        videoInput.expectsMediaDataInRealTime = NO;
+        [readerOutputs addObject:videoOutput];
+        [writerInputs addObject:videoInput];
+    }
+    AVAssetTrack *audioTrack = [asset tracksWithMediaType:AVMediaTypeAudio].firstObject;
+    if (audioTrack) {
+        AVAssetReaderTrackOutput *audioOutput = [AVAssetReaderTrackOutput assetReaderTrackOutputWithTrack:audioTrack outputSettings:@{ AVFormatIDKey: @(kAudioFormatLinearPCM) }];
+        NSDictionary *audioSettings = @{ AVFormatIDKey: @(kAudioFormatMPEG4AAC),
+                                         AVNumberOfChannelsKey: @2,
+                                         AVSampleRateKey: @44100,
+                                         AVEncoderBitRateKey: @(encoding.audioBitrate) };
+        AVAssetWriterInput *audioInput = [AVAssetWriterInput assetWriterInputWithMediaType:AVMediaTypeAudio outputSettings:audioSettings];
+        audioInput.expectsMediaDataInRealTime = NO;
+        [readerOutputs addObject:audioOutput];
+        [writerInputs addObject:audioInput];
+    }
+    
+    for (NSUInteger idx = 0; idx < readerOutputs.count; idx++) {
+        if (![assetReader canAddOutput:readerOutputs[idx]] || ![assetWriter canAddInput:writerInputs[idx]]) {
+            if (error) {
+                *error = [NSError errorWithDomain:ATLMediaInputStreamErrorDomain code:ATLMediaInputStreamErrorFailedInitializingVideoWriter userInfo:@{ NSLocalizedDescriptionKey: @"Failed pairing the asset reader outputs with the asset writer inputs." }];
+            }
+            return NO;
+        }
+        [assetReader addOutput:readerOutputs[idx]];
+        [assetWriter addInput:writerInputs[idx]];
+    }
+    if (readerOutputs.count == 0) {
+        if (error) {
+            *error = [NSError errorWithDomain:ATLMediaInputStreamErrorDomain code:ATLMediaInputStreamErrorFailedInitializingVideoWriter userInfo:@{ NSLocalizedDescriptionKey: @"Source asset doesn't include any video or audio tracks." }];
+        }
+        return NO;
+    }
+    
+    self.exportsVideoFragments = exportsVideoFragments;
+    self.videoAssetReader = assetReader;
+    self.videoAssetWriter = assetWriter;
+    self.videoAssetReaderOutputs = readerOutputs;
+    self.videoAssetWriterInputs = writerInputs;
+    self.videoTranscodingQueue = dispatch_queue_create(ATLMediaInputVideoTranscodingQueueName, DISPATCH_QUEUE_SERIAL);
+    return YES;
+}
 
-    free(buffer);
+- (void)startTranscodingConsumption
+{
+    if (![self.videoAssetReader startReading] || ![self.videoAssetWriter startWriting]) {
+        [self finishTransferWithError:self.videoAssetReader.error ?: self.videoAssetWriter.error];
+        return;
+    }
+    [self.videoAssetWriter startSessionAtSourceTime:kCMTimeZero];
     
-    if (bytesRead == 0) {
-        self.mediaStreamStatus = NSStreamStatusAtEnd;
+    // Pump samples from every reader output into its writer input.
+    dispatch_group_t transcodingGroup = dispatch_group_create();
+    for (NSUInteger idx = 0; idx < self.videoAssetWriterInputs.count; idx++) {
+        AVAssetReaderOutput *readerOutput = self.videoAssetReaderOutputs[idx];
+        AVAssetWriterInput *writerInput = self.videoAssetWriterInputs[idx];
+        dispatch_group_enter(transcodingGroup);
+        __block BOOL finished = NO;
+        [writerInput requestMediaDataWhenReadyOnQueue:self.videoTranscodingQueue usingBlock:^{
+            while (!finished && writerInput.isReadyForMoreMediaData) {
+                CMSampleBufferRef sampleBuffer = self.transferCancelled ? NULL : [readerOutput copyNextSampleBuffer];
+                BOOL appended = NO;
+                if (sampleBuffer) {
+                    appended = [writerInput appendSampleBuffer:sampleBuffer];
+                    CFRelease(sampleBuffer);
+                }
+                if (!appended) {
+                    finished = YES;
+                    [writerInput markAsFinished];
+                    dispatch_group_leave(transcodingGroup);
+                }
+            }
+        }];
     }
-    dispatch_semaphore_signal(self.streamFlowRequesterSemaphore);
+    
+    dispatch_group_notify(transcodingGroup, self.videoTranscodingQueue, ^{
+        if (self.transferCancelled || self.videoAssetReader.status == AVAssetReaderStatusFailed || self.videoAssetWriter.status == AVAssetWriterStatusFailed) {
+            NSError *error = self.videoAssetReader.error ?: self.videoAssetWriter.error;
+            [self.videoAssetReader cancelReading];
+            [self.videoAssetWriter cancelWriting];
+            ATLMediaInputStreamLog(@"consumer: transcoding stopped with error=%@", error);
+            [self finishTransferWithError:error];
+            return;
+        }
+        [self.videoAssetWriter finishWritingWithCompletionHandler:^{
+            NSError *error;
+            if (self.videoAssetWriter.status != AVAssetWriterStatusCompleted) {
+                error = [NSError errorWithDomain:ATLMediaInputStreamErrorDomain code:ATLMediaInputStreamErrorVideoExportFailed userInfo:@{ NSLocalizedDescriptionKey: @"Could not export the video.", @"exporterror": self.videoAssetWriter.error ?: [NSNull null], @"exportstatus": @(self.videoAssetWriter.status) }];
+            } else if (!self.exportsVideoFragments) {
+                [self openExportedFileWithError:&error];
+            }
+            ATLMediaInputStreamLog(@"consumer: transcoding completed with error=%@", error);
+            [self finishTransferWithError:error];
+        }];
+    });
+}
+
+#if __IPHONE_OS_VERSION_MAX_ALLOWED >= 140000
+- (void)assetWriter:(AVAssetWriter *)writer didOutputSegmentData:(NSData *)segmentData segmentType:(AVAssetSegmentType)segmentType API_AVAILABLE(ios(14.0))
+{
+    ATLMediaInputStreamLog(@"consumer: writer produced a %@ segment of %lu bytes", segmentType == AVAssetSegmentTypeInitialization ? @"initialization" : @"media", (unsigned long)segmentData.length);
+    // Blocks while the receiver hasn't drained enough of the previous fragments.
+    [self writeBytesToTransferBuffer:segmentData.bytes length:segmentData.length];
 }
+#endif
 
 @end
 
@@ -689,15 +1082,13 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
         }
         _mediaStreamStatus = NSStreamStatusNotOpen;
         _mediaStreamError = nil;
-        _dataConsumed = [NSData data];
-        _numberOfBytesRequested = 0;
-        _numberOfBytesProvided = 0;
+        _transferBuffer = NULL;
+        _transferBufferCapacity = ATLMediaInputDefaultTransferBufferCapacity;
         _maximumSize = 0;
         _compressionQuality = 0.0f;
         _streamFlowRequesterSemaphore = dispatch_semaphore_create(0);
         _streamFlowProviderSemaphore = dispatch_semaphore_create(0);
         _consumerAsyncQueue = dispatch_queue_create(ATLMediaInputConsumerAsyncQueueName, DISPATCH_QUEUE_CONCURRENT);
-        _transferBufferSerialGuard = dispatch_queue_create(ATLMediaInputConsumerSerialTransferQueueName, DISPATCH_QUEUE_SERIAL);
     }
     return self;
 }
@@ -707,6 +1098,10 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
     if (self.streamStatus != NSStreamStatusClosed) {
         [self close];
     }
+    if (_transferBuffer != NULL) {
+        ATLMediaInputStreamRingBufferFree(_transferBuffer);
+        _transferBuffer = NULL;
+    }
 }
 
 #pragma mark - Transient isLossless implementation
@@ -715,7 +1110,7 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
 {
     NSSet *keyPaths = [super keyPathsForValuesAffectingValueForKey:key];
     if ([key isEqualToString:@"isLossless"]) {
-        NSSet *affectingKey = [NSSet setWithObjects:@"maximumSize", @"compressionQuality", nil];
+        NSSet *affectingKey = [NSSet setWithObjects:@"maximumSize", @"compressionQuality", @"targetBitrate", @"maximumFileSize", nil];
         keyPaths = [keyPaths setByAddingObjectsFromSet:affectingKey];
     }
     return keyPaths;
@@ -723,7 +1118,7 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
 
 - (BOOL)isLossless
 {
-    return (self.maximumSize == 0 && self.compressionQuality == 0.0f);
+    return (self.maximumSize == 0 && self.compressionQuality == 0.0f && self.targetBitrate == 0 && self.maximumFileSize == 0);
 }
 
 #pragma mark - Public Overrides
@@ -755,10 +1150,11 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
     
     if (self.mediaStreamStatus == NSStreamStatusReading) {
         // Close the stream gracefully.
-        self.numberOfBytesRequested = 0;
         ATLMediaInputStreamLog(@"closing stream...");
     }
-    // Signal any ongoing requests.
+    // Unblock the producer (if waiting for space) and any ongoing requests.
+    self.transferCancelled = YES;
+    dispatch_semaphore_signal(self.streamFlowProviderSemaphore);
     dispatch_semaphore_signal(self.streamFlowRequesterSemaphore);
     self.mediaStreamStatus = NSStreamStatusClosed;
 }
@@ -766,6 +1162,9 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
 - (NSInteger)read:(uint8_t *)buffer maxLength:(NSUInteger)bytesToConsume
 {
     if (self.mediaStreamStatus == NSStreamStatusOpen) {
+        if (self.transferBuffer == NULL) {
+            self.transferBuffer = ATLMediaInputStreamRingBufferCreate(MAX(self.transferBufferCapacity, 1));
+        }
         [self startConsumption];
     }
     
@@ -779,29 +1178,32 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
         return -1; // Operation fails
     }
     
-    // Setting the data stream request.
     ATLMediaInputStreamLog(@"input stream: requesting %lu of bytes", bytesToConsume);
-    self.numberOfBytesRequested = bytesToConsume;
-    
-    // Notify data provider that request is ready.
-    dispatch_semaphore_signal(self.streamFlowProviderSemaphore);
-    
-    // Wait for the response.
-    ATLMediaInputStreamLog(@"input stream: waiting for cosumer to prepare data");
-    dispatch_semaphore_wait(self.streamFlowRequesterSemaphore, DISPATCH_TIME_FOREVER);
-    
-    if (self.mediaStreamStatus == NSStreamStatusError) {
-        return -1; // Operation failed, see self.streamError;
+    while (YES) {
+        // Check for completion before draining, so bytes written right
+        // before the producer finished are never missed.
+        BOOL transferCompleted = self.transferCompleted;
+        size_t bytesConsumed = ATLMediaInputStreamRingBufferRead(self.transferBuffer, buffer, bytesToConsume);
+        if (bytesConsumed > 0) {
+            // Notify data provider that there's free space in the buffer.
+            dispatch_semaphore_signal(self.streamFlowProviderSemaphore);
+            ATLMediaInputStreamLog(@"input stream: passed %lu bytes to receiver", bytesConsumed);
+            return bytesConsumed;
+        }
+        if (self.mediaStreamStatus == NSStreamStatusError) {
+            return -1; // Operation failed, see self.streamError;
+        }
+        if (self.mediaStreamStatus != NSStreamStatusReading) {
+            return 0; // Closed while waiting.
+        }
+        if (transferCompleted) {
+            self.mediaStreamStatus = NSStreamStatusAtEnd;
+            return 0; // EOS
+        }
+        // Wait for the producer to put more data in.
+        ATLMediaInputStreamLog(@"input stream: waiting for cosumer to prepare data");
+        dispatch_semaphore_wait(self.streamFlowRequesterSemaphore, DISPATCH_TIME_FOREVER);
     }
-    
-    // Copy the consumed data to `buffer`.
-    [self.dataConsumed getBytes:buffer length:bytesToConsume];
-    ATLMediaInputStreamLog(@"input stream: passed data to receiver");
-    
-    // Clear transfer buffer.
-    NSInteger bytesConsumed = self.dataConsumed.length;
-    self.dataConsumed = [NSData data];
-    return bytesConsumed;
 }
 
 /**
@@ -818,6 +1220,52 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
     @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:[NSString stringWithFormat:@"Method %@ on %@ not implemented", NSStringFromSelector(@selector(getBuffer:length:)), self.class] userInfo:nil];
 }
 
+#pragma mark - Transfer Buffer
+
+/**
+ @abstract Copies bytes from the producer into the transfer buffer, blocking only while the buffer is full.
+ @param bytes The bytes to transfer.
+ @param length The number of bytes to transfer.
+ @return Returns `YES` once all bytes were written; `NO` if the stream was closed in the meantime.
+ */
+- (BOOL)writeBytesToTransferBuffer:(const uint8_t *)bytes length:(NSUInteger)length
+{
+    NSUInteger bytesWritten = 0;
+    while (bytesWritten < length) {
+        if (self.transferCancelled) {
+            return NO;
+        }
+        size_t written = ATLMediaInputStreamRingBufferWrite(self.transferBuffer, bytes + bytesWritten, length - bytesWritten);
+        if (written > 0) {
+            bytesWritten += written;
+            // Signal the requester data is ready for consumption.
+            dispatch_semaphore_signal(self.streamFlowRequesterSemaphore);
+        } else {
+            ATLMediaInputStreamLog(@"consumer: waiting for free space (have %lu bytes ready)", (unsigned long)(length - bytesWritten));
+            dispatch_semaphore_wait(self.streamFlowProviderSemaphore, DISPATCH_TIME_FOREVER);
+        }
+    }
+    return YES;
+}
+
+/**
+ @abstract Marks the end of the transfer. Bytes still in the buffer are handed out before the stream reaches `NSStreamStatusAtEnd`.
+ @param error An error if the producer failed, otherwise `nil`.
+ */
+- (void)finishTransferWithError:(NSError *)error
+{
+    if (error || self.mediaStreamError) {
+        if (error) {
+            self.mediaStreamError = error;
+        }
+        if (self.mediaStreamStatus == NSStreamStatusReading) {
+            self.mediaStreamStatus = NSStreamStatusError;
+        }
+    }
+    self.transferCompleted = YES;
+    dispatch_semaphore_signal(self.streamFlowRequesterSemaphore);
+}
+
 @end
 
 #pragma mark - Image I/O Callback Implementation
@@ -881,20 +1329,133 @@ static size_t ATLMediaInputStreamPutBytesIntoStreamCallback(void *assetStreamRef
 {
     ATLMediaInputStream *assetStream = (__bridge ATLMediaInputStream *)assetStreamRef;
     
-    // Consumption continues, after flow control logic in readBytes:len: signals it.
-    dispatch_sync(assetStream.transferBufferSerialGuard, ^{
-        ATLMediaInputStreamLog(@"consumer: waiting for request from stream (have %lu bytes ready)", length);
-        dispatch_semaphore_wait(assetStream.streamFlowProviderSemaphore, DISPATCH_TIME_FOREVER);
-    });
+    // Copy bytes straight into the transfer buffer; blocks only when it's full.
+    if (![assetStream writeBytesToTransferBuffer:buffer length:length]) {
+        ATLMediaInputStreamLog(@"consumer: stream closed, dropping %lu bytes", (unsigned long)length);
+        return 0;
+    }
+    ATLMediaInputStreamLog(@"consumer: consumed %lu bytes", (unsigned long)length);
+    return length;
+}
+
+#pragma mark - Video Encoding Implementation
+
+static NSUInteger ATLMediaInputVideoEstimatedFileSize(double bitrate, NSTimeInterval duration)
+{
+    return (NSUInteger)(bitrate * MAX(duration, 0) / 8.0 * (1.0 + ATLMediaInputVideoContainerOverhead));
+}
+
+static CGSize ATLMediaInputVideoDimensionsWithShortSide(CGSize dimensions, CGFloat shortSide)
+{
+    CGFloat scale = MIN(1.0, shortSide / MIN(dimensions.width, dimensions.height));
+    // H.264 needs even dimensions.
+    return CGSizeMake(MAX(2, floor(dimensions.width * scale / 2.0) * 2.0), MAX(2, floor(dimensions.height * scale / 2.0) * 2.0));
+}
+
+static ATLMediaInputVideoEncoding ATLMediaInputVideoEncodingForSource(CGSize sourceDimensions, float sourceFrameRate, NSTimeInterval duration, BOOL hasAudio, NSUInteger targetBitrate, NSUInteger maximumFileSize, NSUInteger maximumSize)
+{
+    ATLMediaInputVideoEncoding encoding;
+    encoding.dimensions = sourceDimensions;
+    encoding.frameRate = sourceFrameRate > 0 ? sourceFrameRate : 30.0f;
+    encoding.videoBitrate = 0;
+    encoding.audioBitrate = hasAudio ? 128 * 1000 : 0;
+    if (encoding.dimensions.width <= 0 || encoding.dimensions.height <= 0) {
+        encoding.dimensions = CGSizeMake(640, 480);
+    }
     
-    // Copy buffer into NSData that was consumed by Image I/O process.
-    NSUInteger bytesConsumed = MIN(assetStream.numberOfBytesRequested, length);
-    NSData *dataConsumed = [NSData dataWithBytes:buffer length:bytesConsumed];
-    assetStream.dataConsumed = dataConsumed;
-    ATLMediaInputStreamLog(@"consumer: consumed %lu bytes (requested %lu bytes, provided %lu bytes)", (unsigned long)dataConsumed.length, (unsigned long)assetStream.numberOfBytesRequested, length);
+    // Respect the `maximumSize` (longest side in pixels) first.
+    if (maximumSize > 0 && MAX(encoding.dimensions.width, encoding.dimensions.height) > maximumSize) {
+        CGFloat scale = maximumSize / MAX(encoding.dimensions.width, encoding.dimensions.height);
+        encoding.dimensions = ATLMediaInputVideoDimensionsWithShortSide(encoding.dimensions, MIN(encoding.dimensions.width, encoding.dimensions.height) * scale);
+    } else {
+        encoding.dimensions = ATLMediaInputVideoDimensionsWithShortSide(encoding.dimensions, MIN(encoding.dimensions.width, encoding.dimensions.height));
+    }
     
-    // Signal the requester data is ready for consumption.
-    dispatch_semaphore_signal(assetStream.streamFlowRequesterSemaphore);
-    ATLMediaInputStreamLog(@"return %lu", (unsigned long)bytesConsumed);
-    return bytesConsumed;
+    // Total bitrate the output can afford.
+    double bitrateBudget = targetBitrate;
+    if (maximumFileSize > 0 && duration > 0) {
+        double fileSizeBitrate = maximumFileSize * 8.0 / (1.0 + ATLMediaInputVideoContainerOverhead) / duration;
+        bitrateBudget = bitrateBudget > 0 ? MIN(bitrateBudget, fileSizeBitrate) : fileSizeBitrate;
+    }
+    if (bitrateBudget <= 0) {
+        return encoding;
+    }
+    if (hasAudio) {
+        encoding.audioBitrate = bitrateBudget < 1000 * 1000 ? 64 * 1000 : 128 * 1000;
+    }
+    encoding.videoBitrate = MAX(ATLMediaInputVideoMinimumBitrate, (NSUInteger)MAX(bitrateBudget - encoding.audioBitrate, 0));
+    
+    // Step down the resolution ladder, and then the frame rate, until there
+    // are enough bits per pixel for the encoder to produce a watchable picture.
+    static CGFloat const shortSideLadder[] = { 1080, 720, 540, 480, 360, 240 };
+    size_t const ladderCount = sizeof(shortSideLadder) / sizeof(shortSideLadder[0]);
+    CGSize dimensions = encoding.dimensions;
+    for (size_t idx = 0; idx < ladderCount; idx++) {
+        if (shortSideLadder[idx] > MIN(encoding.dimensions.width, encoding.dimensions.height)) {
+            continue;
+        }
+        dimensions = ATLMediaInputVideoDimensionsWithShortSide(encoding.dimensions, shortSideLadder[idx]);
+        if (encoding.videoBitrate / (dimensions.width * dimensions.height * encoding.frameRate) >= ATLMediaInputVideoMinimumBitsPerPixel) {
+            break;
+        }
+    }
+    encoding.dimensions = dimensions;
+    static float const frameRateLadder[] = { 24.0f, 15.0f };
+    for (size_t idx = 0; idx < sizeof(frameRateLadder) / sizeof(frameRateLadder[0]); idx++) {
+        if (encoding.videoBitrate / (dimensions.width * dimensions.height * encoding.frameRate) >= ATLMediaInputVideoMinimumBitsPerPixel) {
+            break;
+        }
+        encoding.frameRate = MIN(encoding.frameRate, frameRateLadder[idx]);
+    }
+    return encoding;
+}
+
+#pragma mark - Transfer Ring Buffer Implementation
+
+static ATLMediaInputStreamRingBuffer *ATLMediaInputStreamRingBufferCreate(size_t capacity)
+{
+    // Round capacity up to a power of two, so indexes can be masked.
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity) {
+        roundedCapacity <<= 1;
+    }
+    ATLMediaInputStreamRingBuffer *ringBuffer = calloc(1, sizeof(ATLMediaInputStreamRingBuffer));
+    ringBuffer->bytes = malloc(roundedCapacity);
+    ringBuffer->capacity = roundedCapacity;
+    atomic_init(&ringBuffer->writeCount, 0);
+    atomic_init(&ringBuffer->readCount, 0);
+    return ringBuffer;
+}
+
+static void ATLMediaInputStreamRingBufferFree(ATLMediaInputStreamRingBuffer *ringBuffer)
+{
+    free(ringBuffer->bytes);
+    free(ringBuffer);
+}
+
+static size_t ATLMediaInputStreamRingBufferWrite(ATLMediaInputStreamRingBuffer *ringBuffer, const uint8_t *bytes, size_t length)
+{
+    // Only the producer advances `writeCount`, only the consumer advances `readCount`.
+    size_t writeCount = atomic_load_explicit(&ringBuffer->writeCount, memory_order_relaxed);
+    size_t readCount = atomic_load_explicit(&ringBuffer->readCount, memory_order_acquire);
+    length = MIN(length, ringBuffer->capacity - (writeCount - readCount));
+    size_t offset = writeCount & (ringBuffer->capacity - 1);
+    size_t firstPart = MIN(length, ringBuffer->capacity - offset);
+    memcpy(ringBuffer->bytes + offset, bytes, firstPart);
+    memcpy(ringBuffer->bytes, bytes + firstPart, length - firstPart);
+    atomic_store_explicit(&ringBuffer->writeCount, writeCount + length, memory_order_release);
+    return length;
+}
+
+static size_t ATLMediaInputStreamRingBufferRead(ATLMediaInputStreamRingBuffer *ringBuffer, uint8_t *bytes, size_t length)
+{
+    size_t readCount = atomic_load_explicit(&ringBuffer->readCount, memory_order_relaxed);
+    size_t writeCount = atomic_load_explicit(&ringBuffer->writeCount, memory_order_acquire);
+    length = MIN(length, writeCount - readCount);
+    size_t offset = readCount & (ringBuffer->capacity - 1);
+    size_t firstPart = MIN(length, ringBuffer->capacity - offset);
+    memcpy(bytes, ringBuffer->bytes + offset, firstPart);
+    memcpy(bytes + firstPart, ringBuffer->bytes, length - firstPart);
+    atomic_store_explicit(&ringBuffer->readCount, readCount + length, memory_order_release);
+    return length;
 }
@@ -0,0 +1,106 @@
+//
+//  ATLMessageLabelCache.h
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <UIKit/UIKit.h>
+#import "ATLConversationSectionMetadata.h"
+@import LayerKit;
+
+NS_ASSUME_NONNULL_BEGIN
+/**
+ @abstract The `ATLMessageLabelCache` class caches the strings displayed in the headers and footers
+   around messages, along with the heights measured for them.
+ @discussion Strings and heights are keyed by message identifier and remember the version of the
+   message they were built from: a date string is dropped once the message's `sentAt` changes, and a
+   recipient status string once its `recipientStatusByUserID` changes. Participant names are keyed by
+   user ID, as they are the same for every message of a sender. At most 1000 messages are kept.
+   Not thread safe; meant to be used from the main thread by a single conversation view controller.
+ */
+@interface ATLMessageLabelCache : NSObject
+
+/**
+ @abstract Returns the cached date string of a message, or `nil` if it's missing or stale.
+ */
+- (nullable NSAttributedString *)dateStringForMessage:(LYRMessage *)message;
+
+/**
+ @abstract Caches the date string of a message. Ignored for messages which haven't been sent, as their date is the current one.
+ */
+- (void)setDateString:(NSAttributedString *)dateString forMessage:(LYRMessage *)message;
+
+/**
+ @abstract Returns the cached recipient status string of a message, or `nil` if it's missing or stale.
+ */
+- (nullable NSAttributedString *)recipientStatusStringForMessage:(LYRMessage *)message;
+
+/**
+ @abstract Caches the recipient status string of a message.
+ */
+- (void)setRecipientStatusString:(NSAttributedString *)recipientStatusString forMessage:(LYRMessage *)message;
+
+/**
+ @abstract Returns the cached display name of a participant.
+ */
+- (nullable NSString *)participantNameForUserID:(NSString *)userID;
+
+/**
+ @abstract Caches the display name of a participant.
+ */
+- (void)setParticipantName:(NSString *)participantName forUserID:(NSString *)userID;
+
+/**
+ @abstract Returns the cached header height of a message, if it was measured with the same labels.
+ @param flags The `ATLConversationSectionFlagDateLabel` and `ATLConversationSectionFlagSenderLabel` flags of the section.
+ @param participantName The participant name displayed in the header, if any.
+ */
+- (nullable NSNumber *)headerHeightForMessage:(LYRMessage *)message flags:(ATLConversationSectionFlags)flags participantName:(nullable NSString *)participantName;
+
+/**
+ @abstract Caches the header height of a message.
+ */
+- (void)setHeaderHeight:(CGFloat)height forMessage:(LYRMessage *)message flags:(ATLConversationSectionFlags)flags participantName:(nullable NSString *)participantName;
+
+/**
+ @abstract Returns the cached footer height of a message, if it was measured with the same labels.
+ @param flags The `ATLConversationSectionFlagReadReceipt` and `ATLConversationSectionFlagClustered` flags of the section.
+ */
+- (nullable NSNumber *)footerHeightForMessage:(LYRMessage *)message flags:(ATLConversationSectionFlags)flags;
+
+/**
+ @abstract Caches the footer height of a message.
+ */
+- (void)setFooterHeight:(CGFloat)height forMessage:(LYRMessage *)message flags:(ATLConversationSectionFlags)flags;
+
+/**
+ @abstract Removes the strings and heights of a message, e.g. because one of its properties changed.
+ */
+- (void)removeLabelsForMessage:(LYRMessage *)message;
+
+/**
+ @abstract Removes the display name of a participant. Header heights measured with the previous name are no longer returned.
+ */
+- (void)removeParticipantNameForUserID:(NSString *)userID;
+
+/**
+ @abstract Empties the cache.
+ */
+- (void)removeAllLabels;
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,195 @@
+//
+//  ATLMessageLabelCache.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ATLMessageLabelCache.h"
+
+static NSUInteger const ATLMessageLabelCacheCountLimit = 1000;
+
+static BOOL ATLMessageLabelCacheObjectsEqual(id object, id otherObject)
+{
+    return object == otherObject || [object isEqual:otherObject];
+}
+
+/**
+ @abstract The labels of a single message, along with the versions of the properties they were built from.
+ */
+@interface ATLMessageLabelCacheEntry : NSObject
+
+@property (nonatomic) NSDate *sentAt;
+@property (nonatomic) NSAttributedString *dateString;
+@property (nonatomic) NSDictionary *recipientStatusByUserID;
+@property (nonatomic) NSAttributedString *recipientStatusString;
+@property (nonatomic) NSNumber *headerHeight;
+@property (nonatomic) ATLConversationSectionFlags headerFlags;
+@property (nonatomic, copy) NSString *headerParticipantName;
+@property (nonatomic) NSNumber *footerHeight;
+@property (nonatomic) ATLConversationSectionFlags footerFlags;
+
+@end
+
+@implementation ATLMessageLabelCacheEntry
+
+- (void)invalidateIfStaleForMessage:(LYRMessage *)message
+{
+    if (!ATLMessageLabelCacheObjectsEqual(self.sentAt, message.sentAt)) {
+        self.sentAt = message.sentAt;
+        self.dateString = nil;
+        self.headerHeight = nil;
+    }
+    if (!ATLMessageLabelCacheObjectsEqual(self.recipientStatusByUserID, message.recipientStatusByUserID)) {
+        self.recipientStatusByUserID = [message.recipientStatusByUserID copy];
+        self.recipientStatusString = nil;
+        self.footerHeight = nil;
+    }
+}
+
+@end
+
+@interface ATLMessageLabelCache ()
+
+@property (nonatomic) NSCache <NSURL *, ATLMessageLabelCacheEntry *> *entries;
+@property (nonatomic) NSMutableDictionary <NSString *, NSString *> *participantNames;
+
+@end
+
+@implementation ATLMessageLabelCache
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        _entries = [NSCache new];
+        _entries.countLimit = ATLMessageLabelCacheCountLimit;
+        _participantNames = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+#pragma mark - Strings
+
+- (NSAttributedString *)dateStringForMessage:(LYRMessage *)message
+{
+    return [self existingEntryForMessage:message].dateString;
+}
+
+- (void)setDateString:(NSAttributedString *)dateString forMessage:(LYRMessage *)message
+{
+    if (!message.sentAt) return;
+    [self entryForMessage:message].dateString = dateString;
+}
+
+- (NSAttributedString *)recipientStatusStringForMessage:(LYRMessage *)message
+{
+    return [self existingEntryForMessage:message].recipientStatusString;
+}
+
+- (void)setRecipientStatusString:(NSAttributedString *)recipientStatusString forMessage:(LYRMessage *)message
+{
+    ATLMessageLabelCacheEntry *entry = [self entryForMessage:message];
+    if (![entry.recipientStatusString isEqualToAttributedString:recipientStatusString]) {
+        entry.footerHeight = nil;
+    }
+    entry.recipientStatusString = recipientStatusString;
+}
+
+- (NSString *)participantNameForUserID:(NSString *)userID
+{
+    return self.participantNames[userID];
+}
+
+- (void)setParticipantName:(NSString *)participantName forUserID:(NSString *)userID
+{
+    self.participantNames[userID] = [participantName copy];
+}
+
+#pragma mark - Heights
+
+- (NSNumber *)headerHeightForMessage:(LYRMessage *)message flags:(ATLConversationSectionFlags)flags participantName:(NSString *)participantName
+{
+    ATLMessageLabelCacheEntry *entry = [self existingEntryForMessage:message];
+    if (entry.headerFlags != flags || !ATLMessageLabelCacheObjectsEqual(entry.headerParticipantName, participantName)) return nil;
+    return entry.headerHeight;
+}
+
+- (void)setHeaderHeight:(CGFloat)height forMessage:(LYRMessage *)message flags:(ATLConversationSectionFlags)flags participantName:(NSString *)participantName
+{
+    ATLMessageLabelCacheEntry *entry = [self entryForMessage:message];
+    entry.headerHeight = @(height);
+    entry.headerFlags = flags;
+    entry.headerParticipantName = participantName;
+}
+
+- (NSNumber *)footerHeightForMessage:(LYRMessage *)message flags:(ATLConversationSectionFlags)flags
+{
+    ATLMessageLabelCacheEntry *entry = [self existingEntryForMessage:message];
+    if (entry.footerFlags != flags) return nil;
+    return entry.footerHeight;
+}
+
+- (void)setFooterHeight:(CGFloat)height forMessage:(LYRMessage *)message flags:(ATLConversationSectionFlags)flags
+{
+    ATLMessageLabelCacheEntry *entry = [self entryForMessage:message];
+    entry.footerHeight = @(height);
+    entry.footerFlags = flags;
+}
+
+#pragma mark - Invalidation
+
+- (void)removeLabelsForMessage:(LYRMessage *)message
+{
+    if (!message.identifier) return;
+    [self.entries removeObjectForKey:message.identifier];
+}
+
+- (void)removeParticipantNameForUserID:(NSString *)userID
+{
+    [self.participantNames removeObjectForKey:userID];
+}
+
+- (void)removeAllLabels
+{
+    [self.entries removeAllObjects];
+    [self.participantNames removeAllObjects];
+}
+
+#pragma mark - Helpers
+
+- (ATLMessageLabelCacheEntry *)existingEntryForMessage:(LYRMessage *)message
+{
+    if (!message.identifier) return nil;
+    ATLMessageLabelCacheEntry *entry = [self.entries objectForKey:message.identifier];
+    [entry invalidateIfStaleForMessage:message];
+    return entry;
+}
+
+- (ATLMessageLabelCacheEntry *)entryForMessage:(LYRMessage *)message
+{
+    if (!message.identifier) return nil;
+    ATLMessageLabelCacheEntry *entry = [self existingEntryForMessage:message];
+    if (!entry) {
+        entry = [ATLMessageLabelCacheEntry new];
+        entry.sentAt = message.sentAt;
+        entry.recipientStatusByUserID = [message.recipientStatusByUserID copy];
+        [self.entries setObject:entry forKey:message.identifier];
+    }
+    return entry;
+}
+
+@end
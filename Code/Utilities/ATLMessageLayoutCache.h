@@ -0,0 +1,109 @@
+//
+//  ATLMessageLayoutCache.h
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <UIKit/UIKit.h>
+@import LayerKit;
+
+NS_ASSUME_NONNULL_BEGIN
+/**
+ @abstract The `ATLMessageLayout` class holds the precomputed layout of a message's content,
+   along with the inputs it was computed for.
+ */
+@interface ATLMessageLayout : NSObject
+
+/**
+ @abstract The width the content was laid out in.
+ */
+@property (nonatomic, readonly) CGFloat contentWidth;
+
+/**
+ @abstract The descriptor of the font text content was laid out with.
+ */
+@property (nonatomic, readonly) UIFontDescriptor *fontDescriptor;
+
+/**
+ @abstract The data detector types the text content was scanned for.
+ */
+@property (nonatomic, readonly) NSTextCheckingType textCheckingTypes;
+
+/**
+ @abstract The size of the content; the bounding size of the text for text messages,
+   the constrained image size for image and video messages, `CGSizeZero` otherwise.
+ */
+@property (nonatomic, readonly) CGSize size;
+
+/**
+ @abstract The links, phone numbers, etc. detected in the text. Empty for non-text messages.
+ */
+@property (nonatomic, readonly) NSArray <NSTextCheckingResult *> *textCheckingResults;
+
+@end
+
+/**
+ @abstract The `ATLMessageLayoutCache` class caches message layouts keyed by
+   the message identifier, the content width, the font and the text checking types.
+ @discussion Each part of a layout is only recomputed when an input it
+   depends on changes: a new font re-measures text, but leaves the detected
+   links and the image sizes alone; new text checking types only re-run
+   data detection. Layouts can be computed ahead of time on a background
+   queue with `prepareLayoutsForMessages:contentWidth:font:textCheckingTypes:completion:`.
+   At most 1000 layouts are kept, so scrolling through a long history
+   doesn't grow the cache without bound. All methods are thread safe.
+ */
+@interface ATLMessageLayoutCache : NSObject
+
+/**
+ @abstract Returns the shared layout cache.
+ */
++ (instancetype)sharedLayoutCache;
+
+/**
+ @abstract Returns the layout of a message, computing the parts of it which are missing or stale.
+ @param message The message to lay out.
+ @param contentWidth The maximum width of the content.
+ @param font The font text is laid out with.
+ @param textCheckingTypes The data detector types text is scanned for.
+ @return The layout of the message.
+ */
+- (ATLMessageLayout *)layoutForMessage:(LYRMessage *)message contentWidth:(CGFloat)contentWidth font:(UIFont *)font textCheckingTypes:(NSTextCheckingType)textCheckingTypes;
+
+/**
+ @abstract Returns the cached layout of a message, if it is up to date for the given inputs.
+ */
+- (nullable ATLMessageLayout *)cachedLayoutForMessage:(LYRMessage *)message contentWidth:(CGFloat)contentWidth font:(UIFont *)font textCheckingTypes:(NSTextCheckingType)textCheckingTypes;
+
+/**
+ @abstract Computes the layouts of messages on a background queue.
+ @param completion Called on the main thread once all layouts are cached.
+ */
+- (void)prepareLayoutsForMessages:(NSArray <LYRMessage *> *)messages contentWidth:(CGFloat)contentWidth font:(UIFont *)font textCheckingTypes:(NSTextCheckingType)textCheckingTypes completion:(nullable void (^)(void))completion;
+
+/**
+ @abstract Removes the layout of a message, e.g. because its content changed.
+ */
+- (void)invalidateLayoutForMessage:(LYRMessage *)message;
+
+/**
+ @abstract Empties the cache.
+ */
+- (void)removeAllLayouts;
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,219 @@
+//
+//  ATLMessageLayoutCache.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ATLMessageLayoutCache.h"
+#import "ATLMessagingUtilities.h"
+
+static char const ATLMessageLayoutCacheLayoutQueueName[] = "com.layer.Atlas.ATLMessageLayoutCache.layoutQueue";
+static NSUInteger const ATLMessageLayoutCacheCountLimit = 1000;
+
+typedef NS_ENUM(NSInteger, ATLMessageLayoutContentType) {
+    ATLMessageLayoutContentTypeOther,
+    ATLMessageLayoutContentTypeText,
+    ATLMessageLayoutContentTypeMedia,
+};
+
+static ATLMessageLayoutContentType ATLMessageLayoutContentTypeForMessage(LYRMessage *message)
+{
+    NSString *MIMEType = [message.parts.firstObject MIMEType];
+    if ([MIMEType isEqualToString:ATLMIMETypeTextPlain]) {
+        return ATLMessageLayoutContentTypeText;
+    }
+    if ([MIMEType isEqualToString:ATLMIMETypeImageJPEG] || [MIMEType isEqualToString:ATLMIMETypeImagePNG] || [MIMEType isEqualToString:ATLMIMETypeImageGIF] || [MIMEType isEqualToString:ATLMIMETypeVideoMP4]) {
+        return ATLMessageLayoutContentTypeMedia;
+    }
+    return ATLMessageLayoutContentTypeOther;
+}
+
+static CGSize ATLMessageLayoutMediaSize(LYRMessage *message)
+{
+    LYRMessagePart *sizePart = ATLMessagePartForMIMEType(message, ATLMIMETypeImageSize);
+    if (sizePart) {
+        return ATLConstrainImageSizeToCellSize(ATLImageSizeForJSONData(sizePart.data));
+    }
+    LYRMessagePart *imagePart = ATLMessagePartForMIMEType(message, ATLMIMETypeImageJPEGPreview);
+    if (!imagePart) {
+        // If no preview image part found, resort to the full-resolution image.
+        imagePart = ATLMessagePartForMIMEType(message, ATLMIMETypeImageJPEG);
+    }
+    // Resort to image's size, if no dimensions metadata message parts found.
+    if ((imagePart.transferStatus == LYRContentTransferComplete) ||
+        (imagePart.transferStatus == LYRContentTransferAwaitingUpload) ||
+        (imagePart.transferStatus == LYRContentTransferUploading)) {
+        return ATLImageSizeForData(imagePart.data);
+    }
+    // We don't have the image data yet, making cell think there's
+    // an image with 3:4 aspect ration (portrait photo).
+    return ATLConstrainImageSizeToCellSize(CGSizeMake(3000, 4000));
+}
+
+static NSString *ATLMessageLayoutTextForMessage(LYRMessage *message)
+{
+    NSData *data = [message.parts.firstObject data];
+    return data ? [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding] : nil;
+}
+
+@interface ATLMessageLayout ()
+
+@property (nonatomic, readwrite) CGFloat contentWidth;
+@property (nonatomic, readwrite) UIFontDescriptor *fontDescriptor;
+@property (nonatomic, readwrite) NSTextCheckingType textCheckingTypes;
+@property (nonatomic, readwrite) CGSize size;
+@property (nonatomic, readwrite) NSArray <NSTextCheckingResult *> *textCheckingResults;
+
+@end
+
+@implementation ATLMessageLayout
+
+@end
+
+@interface ATLMessageLayoutCache ()
+
+@property (nonatomic) NSCache *layouts;
+@property (nonatomic) dispatch_queue_t layoutQueue;
+
+@end
+
+@implementation ATLMessageLayoutCache
+
++ (instancetype)sharedLayoutCache
+{
+    static ATLMessageLayoutCache *sharedLayoutCache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedLayoutCache = [[self alloc] init];
+    });
+    return sharedLayoutCache;
+}
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        _layouts = [NSCache new];
+        _layouts.countLimit = ATLMessageLayoutCacheCountLimit;
+        _layoutQueue = dispatch_queue_create(ATLMessageLayoutCacheLayoutQueueName, DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+#pragma mark - Public Methods
+
+- (ATLMessageLayout *)layoutForMessage:(LYRMessage *)message contentWidth:(CGFloat)contentWidth font:(UIFont *)font textCheckingTypes:(NSTextCheckingType)textCheckingTypes
+{
+    ATLMessageLayout *cachedLayout = message.identifier ? [self.layouts objectForKey:message.identifier] : nil;
+    ATLMessageLayoutContentType contentType = ATLMessageLayoutContentTypeForMessage(message);
+    BOOL widthMatches = cachedLayout && cachedLayout.contentWidth == contentWidth;
+    BOOL fontMatches = cachedLayout && [cachedLayout.fontDescriptor isEqual:font.fontDescriptor];
+    BOOL textCheckingTypesMatch = cachedLayout && cachedLayout.textCheckingTypes == textCheckingTypes;
+    if (widthMatches && fontMatches && textCheckingTypesMatch) {
+        return cachedLayout;
+    }
+    
+    ATLMessageLayout *layout = [ATLMessageLayout new];
+    layout.contentWidth = contentWidth;
+    layout.fontDescriptor = font.fontDescriptor;
+    layout.textCheckingTypes = textCheckingTypes;
+    layout.textCheckingResults = @[];
+    switch (contentType) {
+        case ATLMessageLayoutContentTypeText: {
+            NSString *text = ATLMessageLayoutTextForMessage(message);
+            if (widthMatches && fontMatches) {
+                layout.size = cachedLayout.size;
+            } else {
+                [self layoutText:text font:font contentWidth:contentWidth intoLayout:layout];
+            }
+            if (textCheckingTypesMatch) {
+                layout.textCheckingResults = cachedLayout.textCheckingResults;
+            } else {
+                layout.textCheckingResults = ATLTextCheckingResultsForText(text, textCheckingTypes) ?: @[];
+            }
+            break;
+        }
+        case ATLMessageLayoutContentTypeMedia:
+            // Image sizes only depend on the width.
+            layout.size = widthMatches ? cachedLayout.size : ATLMessageLayoutMediaSize(message);
+            break;
+        case ATLMessageLayoutContentTypeOther:
+            break;
+    }
+    if (message.identifier) {
+        [self.layouts setObject:layout forKey:message.identifier];
+    }
+    return layout;
+}
+
+- (ATLMessageLayout *)cachedLayoutForMessage:(LYRMessage *)message contentWidth:(CGFloat)contentWidth font:(UIFont *)font textCheckingTypes:(NSTextCheckingType)textCheckingTypes
+{
+    if (!message.identifier) {
+        return nil;
+    }
+    ATLMessageLayout *cachedLayout = [self.layouts objectForKey:message.identifier];
+    if (cachedLayout.contentWidth != contentWidth || ![cachedLayout.fontDescriptor isEqual:font.fontDescriptor] || cachedLayout.textCheckingTypes != textCheckingTypes) {
+        return nil;
+    }
+    return cachedLayout;
+}
+
+- (void)prepareLayoutsForMessages:(NSArray <LYRMessage *> *)messages contentWidth:(CGFloat)contentWidth font:(UIFont *)font textCheckingTypes:(NSTextCheckingType)textCheckingTypes completion:(void (^)(void))completion
+{
+    dispatch_async(self.layoutQueue, ^{
+        for (LYRMessage *message in messages) {
+            [self layoutForMessage:message contentWidth:contentWidth font:font textCheckingTypes:textCheckingTypes];
+        }
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), completion);
+        }
+    });
+}
+
+- (void)invalidateLayoutForMessage:(LYRMessage *)message
+{
+    if (message.identifier) {
+        [self.layouts removeObjectForKey:message.identifier];
+    }
+}
+
+- (void)removeAllLayouts
+{
+    [self.layouts removeAllObjects];
+}
+
+#pragma mark - Text Layout
+
+- (void)layoutText:(NSString *)text font:(UIFont *)font contentWidth:(CGFloat)contentWidth intoLayout:(ATLMessageLayout *)layout
+{
+    if (!text.length || !font) {
+        layout.size = CGSizeZero;
+        return;
+    }
+    // A private TextKit stack per call, so this is safe to run on any thread.
+    NSTextStorage *textStorage = [[NSTextStorage alloc] initWithString:text attributes:@{NSFontAttributeName: font}];
+    NSLayoutManager *layoutManager = [NSLayoutManager new];
+    NSTextContainer *textContainer = [[NSTextContainer alloc] initWithSize:CGSizeMake(contentWidth, CGFLOAT_MAX)];
+    textContainer.lineFragmentPadding = 0;
+    [layoutManager addTextContainer:textContainer];
+    [textStorage addLayoutManager:layoutManager];
+    
+    [layoutManager ensureLayoutForTextContainer:textContainer];
+    layout.size = [layoutManager usedRectForTextContainer:textContainer].size;
+}
+
+@end
@@ -0,0 +1,115 @@
+//
+//  ATLMessageSearchIndex.h
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <Foundation/Foundation.h>
+@import LayerKit;
+
+NS_ASSUME_NONNULL_BEGIN
+/**
+ @abstract The `ATLMessageSearchResult` class represents a conversation matching a search, along with its matching messages.
+ */
+@interface ATLMessageSearchResult : NSObject
+
+/**
+ @abstract The identifier of the matching conversation.
+ */
+@property (nonatomic, readonly) NSURL *conversationIdentifier;
+
+/**
+ @abstract The identifiers of the matching messages in the conversation, best match first.
+ */
+@property (nonatomic, readonly) NSArray <NSURL *> *messageIdentifiers;
+
+/**
+ @abstract The score of the best matching message. Whole word matches score higher than prefix matches.
+ */
+@property (nonatomic, readonly) double score;
+
+@end
+
+/**
+ @abstract The `ATLMessageSearchIndex` class is an on-device inverted index over the text of messages.
+ @discussion Text message parts are split into words, which are folded to lowercase without diacritics. Each
+   word maps to the messages containing it. Searching matches every word of the search text as a prefix, so
+   results update as the user types, and ranks whole word matches above prefix matches, then recent messages
+   above older ones.
+
+   The index is persisted in a compact binary file: the words are sorted, so a prefix is found with a binary
+   search, and the file is memory mapped rather than read, so opening a large index doesn't load it into memory.
+   Messages indexed since the file was last written are kept in memory and merged into a new file by `save`,
+   which happens automatically once enough of them accumulate and when the application enters the background.
+
+   Messages are indexed once; their text doesn't change. All methods are thread safe, and the work happens on a
+   serial background queue.
+ */
+@interface ATLMessageSearchIndex : NSObject
+
+/**
+ @abstract Creates an index persisted at a file URL, opening the existing file if there is one.
+ @param fileURL The URL of the index file. Use a different file for each authenticated user.
+ */
+- (instancetype)initWithFileURL:(NSURL *)fileURL;
+
+/**
+ @abstract The URL of the index file.
+ */
+@property (nonatomic, readonly) NSURL *fileURL;
+
+/**
+ @abstract The number of messages in the index.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfIndexedMessages;
+
+/**
+ @abstract Adds the text of messages to the index. Messages which are already indexed, or have no text, are skipped.
+ */
+- (void)indexMessages:(NSArray <LYRMessage *> *)messages;
+
+/**
+ @abstract Removes messages from the index, e.g. because they were deleted.
+ */
+- (void)removeMessagesWithIdentifiers:(NSArray <NSURL *> *)messageIdentifiers;
+
+/**
+ @abstract Removes all messages of a conversation from the index, e.g. because it was deleted.
+ */
+- (void)removeMessagesInConversationWithIdentifier:(NSURL *)conversationIdentifier;
+
+/**
+ @abstract Searches the index.
+ @param text The search text. Every word in it has to prefix a word of a message for the message to match.
+ @param limit The maximum number of conversations to return.
+ @param completion Called on the main queue with the matching conversations, best match first.
+ */
+- (void)searchForText:(NSString *)text limit:(NSUInteger)limit completion:(void (^)(NSArray <ATLMessageSearchResult *> *results))completion;
+
+/**
+ @abstract Writes the messages indexed in memory to the index file.
+ @param completion Called on the main queue once the file is written, with an error if it couldn't be.
+ */
+- (void)saveWithCompletion:(nullable void (^)(NSError *_Nullable error))completion;
+
+/**
+ @abstract Removes all messages from the index and deletes its file.
+ */
+- (void)removeAllMessages;
+
+@end
+NS_ASSUME_NONNULL_END
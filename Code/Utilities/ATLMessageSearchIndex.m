@@ -0,0 +1,643 @@
+//
+//  ATLMessageSearchIndex.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <UIKit/UIKit.h>
+#import "ATLMessageSearchIndex.h"
+#import "ATLMessagingUtilities.h"
+
+static char const ATLMessageSearchIndexQueueName[] = "com.layer.Atlas.ATLMessageSearchIndex.indexQueue";
+static uint32_t const ATLMessageSearchIndexMagic = 0x534C5441; // "ATLS"
+static uint32_t const ATLMessageSearchIndexVersion = 1;
+static NSUInteger const ATLMessageSearchIndexAutosaveThreshold = 1000;
+static NSUInteger const ATLMessageSearchIndexMaximumTokenLength = 64;
+static NSUInteger const ATLMessageSearchIndexMaximumNumberOfSearchTokens = 16;
+
+/**
+ @abstract The index file starts with a header, followed by the document records, the term records sorted by
+   their UTF-8 bytes, the posting lists of the terms as document numbers, and the UTF-8 strings the records point to.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t documentCount;
+    uint32_t termCount;
+    uint32_t postingCount;
+    uint32_t stringsLength;
+} ATLMessageSearchIndexHeader;
+
+typedef struct {
+    uint32_t messageIdentifierOffset;
+    uint32_t messageIdentifierLength;
+    uint32_t conversationIdentifierOffset;
+    uint32_t conversationIdentifierLength;
+    double sentAt;
+} ATLMessageSearchIndexDocumentRecord;
+
+typedef struct {
+    uint32_t termOffset;
+    uint32_t termLength;
+    uint32_t postingIndex;
+    uint32_t postingCount;
+} ATLMessageSearchIndexTermRecord;
+
+static int ATLMessageSearchIndexCompareBytes(const char *bytes, NSUInteger length, const char *otherBytes, NSUInteger otherLength)
+{
+    int result = memcmp(bytes, otherBytes, MIN(length, otherLength));
+    if (result != 0) return result;
+    if (length == otherLength) return 0;
+    return length < otherLength ? -1 : 1;
+}
+
+static NSArray <NSString *> *ATLMessageSearchIndexTokensForText(NSString *text)
+{
+    if (!text.length) return @[];
+    NSString *foldedText = [text.lowercaseString stringByFoldingWithOptions:NSDiacriticInsensitiveSearch locale:nil];
+    NSMutableOrderedSet *tokens = [NSMutableOrderedSet new];
+    [foldedText enumerateSubstringsInRange:NSMakeRange(0, foldedText.length) options:NSStringEnumerationByWords usingBlock:^(NSString *substring, NSRange substringRange, NSRange enclosingRange, BOOL *stop) {
+        if (!substring.length) return;
+        if (substring.length > ATLMessageSearchIndexMaximumTokenLength) {
+            NSRange range = [substring rangeOfComposedCharacterSequencesForRange:NSMakeRange(0, ATLMessageSearchIndexMaximumTokenLength)];
+            substring = [substring substringWithRange:range];
+        }
+        [tokens addObject:substring];
+    }];
+    return tokens.array;
+}
+
+static NSString *ATLMessageSearchIndexTextForMessage(LYRMessage *message)
+{
+    NSMutableArray *texts = [NSMutableArray new];
+    for (LYRMessagePart *part in message.parts) {
+        if (![part.MIMEType isEqualToString:ATLMIMETypeTextPlain] || !part.data) continue;
+        NSString *text = [[NSString alloc] initWithData:part.data encoding:NSUTF8StringEncoding];
+        if (text) [texts addObject:text];
+    }
+    return [texts componentsJoinedByString:@"\n"];
+}
+
+static uint32_t ATLMessageSearchIndexAppendBytes(NSMutableData *strings, const void *bytes, NSUInteger length)
+{
+    uint32_t offset = (uint32_t)strings.length;
+    [strings appendBytes:bytes length:length];
+    return offset;
+}
+
+@interface ATLMessageSearchResult ()
+
+@property (nonatomic, readwrite) NSURL *conversationIdentifier;
+@property (nonatomic, readwrite) NSArray <NSURL *> *messageIdentifiers;
+@property (nonatomic, readwrite) double score;
+
+@end
+
+@implementation ATLMessageSearchResult
+
+@end
+
+/**
+ @abstract A message indexed since the index file was last written.
+ */
+@interface ATLMessageSearchIndexDocument : NSObject
+
+@property (nonatomic, copy) NSString *messageIdentifier;
+@property (nonatomic, copy) NSString *conversationIdentifier;
+@property (nonatomic) NSTimeInterval sentAt;
+
+@end
+
+@implementation ATLMessageSearchIndexDocument
+
+@end
+
+@interface ATLMessageSearchIndex ()
+
+@property (nonatomic, readwrite) NSURL *fileURL;
+@property (nonatomic) dispatch_queue_t indexQueue;
+@property (nonatomic) NSData *snapshot;
+@property (nonatomic) NSUInteger snapshotDocumentCount;
+@property (nonatomic) NSMutableArray <ATLMessageSearchIndexDocument *> *documents;
+@property (nonatomic) NSMutableDictionary <NSString *, NSMutableIndexSet *> *postings;
+@property (nonatomic) NSMutableIndexSet *removedDocumentIDs;
+@property (nonatomic) NSMutableDictionary <NSString *, NSNumber *> *documentIDsByMessageIdentifier;
+@property (nonatomic) NSUInteger numberOfUnsavedChanges;
+
+@end
+
+@implementation ATLMessageSearchIndex
+
+- (instancetype)initWithFileURL:(NSURL *)fileURL
+{
+    self = [super init];
+    if (self) {
+        _fileURL = fileURL;
+        _indexQueue = dispatch_queue_create(ATLMessageSearchIndexQueueName, DISPATCH_QUEUE_SERIAL);
+        _documents = [NSMutableArray new];
+        _postings = [NSMutableDictionary new];
+        _removedDocumentIDs = [NSMutableIndexSet new];
+        dispatch_async(_indexQueue, ^{
+            [self loadSnapshot];
+        });
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(applicationDidEnterBackground:) name:UIApplicationDidEnterBackgroundNotification object:nil];
+    }
+    return self;
+}
+
+- (id)init
+{
+    @throw [NSException exceptionWithName:NSInternalInconsistencyException reason:@"Failed to call designated initializer." userInfo:nil];
+    return nil;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
+#pragma mark - Public Methods
+
+- (NSUInteger)numberOfIndexedMessages
+{
+    __block NSUInteger numberOfIndexedMessages;
+    dispatch_sync(self.indexQueue, ^{
+        numberOfIndexedMessages = self.snapshotDocumentCount + self.documents.count - self.removedDocumentIDs.count;
+    });
+    return numberOfIndexedMessages;
+}
+
+- (void)indexMessages:(NSArray<LYRMessage *> *)messages
+{
+    if (!messages.count) return;
+    dispatch_async(self.indexQueue, ^{
+        NSMutableDictionary *documentIDsByMessageIdentifier = [self loadedDocumentIDsByMessageIdentifier];
+        for (LYRMessage *message in messages) {
+            NSString *messageIdentifier = message.identifier.absoluteString;
+            NSString *conversationIdentifier = message.conversation.identifier.absoluteString;
+            if (!messageIdentifier || !conversationIdentifier) continue;
+            if (documentIDsByMessageIdentifier[messageIdentifier]) continue;
+            NSArray *tokens = ATLMessageSearchIndexTokensForText(ATLMessageSearchIndexTextForMessage(message));
+            if (!tokens.count) continue;
+
+            NSUInteger documentID = self.snapshotDocumentCount + self.documents.count;
+            ATLMessageSearchIndexDocument *document = [ATLMessageSearchIndexDocument new];
+            document.messageIdentifier = messageIdentifier;
+            document.conversationIdentifier = conversationIdentifier;
+            NSDate *date = message.sentAt ?: message.receivedAt;
+            document.sentAt = date ? date.timeIntervalSinceReferenceDate : [NSDate timeIntervalSinceReferenceDate];
+            [self.documents addObject:document];
+            documentIDsByMessageIdentifier[messageIdentifier] = @(documentID);
+            for (NSString *token in tokens) {
+                NSMutableIndexSet *documentIDs = self.postings[token];
+                if (!documentIDs) {
+                    documentIDs = [NSMutableIndexSet new];
+                    self.postings[token] = documentIDs;
+                }
+                [documentIDs addIndex:documentID];
+            }
+            self.numberOfUnsavedChanges++;
+        }
+        [self saveIfNeeded];
+    });
+}
+
+- (void)removeMessagesWithIdentifiers:(NSArray<NSURL *> *)messageIdentifiers
+{
+    if (!messageIdentifiers.count) return;
+    dispatch_async(self.indexQueue, ^{
+        NSMutableDictionary *documentIDsByMessageIdentifier = [self loadedDocumentIDsByMessageIdentifier];
+        for (NSURL *messageIdentifier in messageIdentifiers) {
+            NSNumber *documentID = documentIDsByMessageIdentifier[messageIdentifier.absoluteString];
+            if (!documentID) continue;
+            [self.removedDocumentIDs addIndex:documentID.unsignedIntegerValue];
+            [documentIDsByMessageIdentifier removeObjectForKey:messageIdentifier.absoluteString];
+            self.numberOfUnsavedChanges++;
+        }
+        [self saveIfNeeded];
+    });
+}
+
+- (void)removeMessagesInConversationWithIdentifier:(NSURL *)conversationIdentifier
+{
+    NSString *identifier = conversationIdentifier.absoluteString;
+    if (!identifier) return;
+    dispatch_async(self.indexQueue, ^{
+        NSMutableDictionary *documentIDsByMessageIdentifier = [self loadedDocumentIDsByMessageIdentifier];
+        NSUInteger documentCount = self.snapshotDocumentCount + self.documents.count;
+        for (NSUInteger documentID = 0; documentID < documentCount; documentID++) {
+            if ([self.removedDocumentIDs containsIndex:documentID]) continue;
+            if (![[self conversationIdentifierForDocumentID:documentID] isEqualToString:identifier]) continue;
+            [self.removedDocumentIDs addIndex:documentID];
+            [documentIDsByMessageIdentifier removeObjectForKey:[self messageIdentifierForDocumentID:documentID]];
+            self.numberOfUnsavedChanges++;
+        }
+        [self saveIfNeeded];
+    });
+}
+
+- (void)searchForText:(NSString *)text limit:(NSUInteger)limit completion:(void (^)(NSArray<ATLMessageSearchResult *> *))completion
+{
+    NSString *searchText = [text copy];
+    dispatch_async(self.indexQueue, ^{
+        NSArray *results = [self resultsForText:searchText limit:limit];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completion(results);
+        });
+    });
+}
+
+- (void)saveWithCompletion:(void (^)(NSError *))completion
+{
+    dispatch_async(self.indexQueue, ^{
+        NSError *error;
+        BOOL success = [self writeSnapshot:&error];
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(success ? nil : error);
+            });
+        }
+    });
+}
+
+- (void)removeAllMessages
+{
+    dispatch_async(self.indexQueue, ^{
+        [self resetUnsavedChanges];
+        self.snapshot = nil;
+        self.snapshotDocumentCount = 0;
+        [[NSFileManager defaultManager] removeItemAtURL:self.fileURL error:nil];
+    });
+}
+
+#pragma mark - Notification Handlers
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification
+{
+    [self saveWithCompletion:nil];
+}
+
+#pragma mark - Searching (must be called on the index queue)
+
+- (NSArray *)resultsForText:(NSString *)text limit:(NSUInteger)limit
+{
+    NSArray *tokens = ATLMessageSearchIndexTokensForText(text);
+    if (tokens.count > ATLMessageSearchIndexMaximumNumberOfSearchTokens) {
+        tokens = [tokens subarrayWithRange:NSMakeRange(0, ATLMessageSearchIndexMaximumNumberOfSearchTokens)];
+    }
+    NSUInteger documentCount = self.snapshotDocumentCount + self.documents.count;
+    if (!tokens.count || documentCount == 0 || limit == 0) return @[];
+
+    // A message matches once every token has matched one of its terms, in order; each token counts once, whole words more.
+    float *scores = calloc(documentCount, sizeof(float));
+    uint8_t *matchCounts = calloc(documentCount, sizeof(uint8_t));
+    [tokens enumerateObjectsUsingBlock:^(NSString *token, NSUInteger tokenIndex, BOOL *stop) {
+        [self enumerateDocumentIDsForToken:token usingBlock:^(NSUInteger documentID, BOOL exact) {
+            if (matchCounts[documentID] != tokenIndex) return;
+            matchCounts[documentID] = (uint8_t)(tokenIndex + 1);
+            scores[documentID] += exact ? 2.0f : 1.0f;
+        }];
+    }];
+
+    NSMutableDictionary <NSString *, NSMutableArray <NSNumber *> *> *documentIDsByConversation = [NSMutableDictionary new];
+    for (NSUInteger documentID = 0; documentID < documentCount; documentID++) {
+        if (matchCounts[documentID] != tokens.count || [self.removedDocumentIDs containsIndex:documentID]) continue;
+        NSString *conversationIdentifier = [self conversationIdentifierForDocumentID:documentID];
+        NSMutableArray *documentIDs = documentIDsByConversation[conversationIdentifier];
+        if (!documentIDs) {
+            documentIDs = [NSMutableArray new];
+            documentIDsByConversation[conversationIdentifier] = documentIDs;
+        }
+        [documentIDs addObject:@(documentID)];
+    }
+
+    NSComparator documentComparator = ^NSComparisonResult(NSNumber *documentID, NSNumber *otherDocumentID) {
+        float score = scores[documentID.unsignedIntegerValue];
+        float otherScore = scores[otherDocumentID.unsignedIntegerValue];
+        if (score != otherScore) return score > otherScore ? NSOrderedAscending : NSOrderedDescending;
+        NSTimeInterval sentAt = [self sentAtForDocumentID:documentID.unsignedIntegerValue];
+        NSTimeInterval otherSentAt = [self sentAtForDocumentID:otherDocumentID.unsignedIntegerValue];
+        if (sentAt == otherSentAt) return NSOrderedSame;
+        return sentAt > otherSentAt ? NSOrderedAscending : NSOrderedDescending;
+    };
+    NSMutableArray *bestDocumentIDs = [NSMutableArray arrayWithCapacity:documentIDsByConversation.count];
+    NSMutableDictionary *resultsByBestDocumentID = [NSMutableDictionary dictionaryWithCapacity:documentIDsByConversation.count];
+    [documentIDsByConversation enumerateKeysAndObjectsUsingBlock:^(NSString *conversationIdentifier, NSMutableArray *documentIDs, BOOL *stop) {
+        [documentIDs sortUsingComparator:documentComparator];
+        NSMutableArray *messageIdentifiers = [NSMutableArray arrayWithCapacity:documentIDs.count];
+        for (NSNumber *documentID in documentIDs) {
+            NSURL *messageIdentifier = [NSURL URLWithString:[self messageIdentifierForDocumentID:documentID.unsignedIntegerValue]];
+            if (messageIdentifier) [messageIdentifiers addObject:messageIdentifier];
+        }
+        ATLMessageSearchResult *result = [ATLMessageSearchResult new];
+        result.conversationIdentifier = [NSURL URLWithString:conversationIdentifier];
+        result.messageIdentifiers = messageIdentifiers;
+        result.score = scores[[documentIDs.firstObject unsignedIntegerValue]];
+        if (!result.conversationIdentifier) return;
+        [bestDocumentIDs addObject:documentIDs.firstObject];
+        resultsByBestDocumentID[documentIDs.firstObject] = result;
+    }];
+    [bestDocumentIDs sortUsingComparator:documentComparator];
+    free(scores);
+    free(matchCounts);
+
+    NSUInteger numberOfResults = MIN(limit, bestDocumentIDs.count);
+    NSMutableArray *results = [NSMutableArray arrayWithCapacity:numberOfResults];
+    for (NSUInteger index = 0; index < numberOfResults; index++) {
+        [results addObject:resultsByBestDocumentID[bestDocumentIDs[index]]];
+    }
+    return results;
+}
+
+- (void)enumerateDocumentIDsForToken:(NSString *)token usingBlock:(void (^)(NSUInteger documentID, BOOL exact))block
+{
+    const char *tokenBytes = token.UTF8String;
+    NSUInteger tokenLength = strlen(tokenBytes);
+    const ATLMessageSearchIndexHeader *header = self.snapshot.bytes;
+    const ATLMessageSearchIndexTermRecord *terms = [self snapshotTermRecords];
+    const uint32_t *postings = [self snapshotPostings];
+    const char *strings = [self snapshotStrings];
+    NSUInteger termCount = header ? header->termCount : 0;
+
+    // Terms sharing a prefix are contiguous and start with the prefix itself, so whole word matches are enumerated first.
+    NSUInteger lowerBound = 0;
+    NSUInteger upperBound = termCount;
+    while (lowerBound < upperBound) {
+        NSUInteger middle = lowerBound + (upperBound - lowerBound) / 2;
+        if (ATLMessageSearchIndexCompareBytes(strings + terms[middle].termOffset, terms[middle].termLength, tokenBytes, tokenLength) < 0) {
+            lowerBound = middle + 1;
+        } else {
+            upperBound = middle;
+        }
+    }
+    NSUInteger firstPrefixTerm = lowerBound;
+    if (lowerBound < termCount && terms[lowerBound].termLength == tokenLength && memcmp(strings + terms[lowerBound].termOffset, tokenBytes, tokenLength) == 0) {
+        for (uint32_t index = 0; index < terms[lowerBound].postingCount; index++) {
+            block(postings[terms[lowerBound].postingIndex + index], YES);
+        }
+        firstPrefixTerm++;
+    }
+    [self.postings[token] enumerateIndexesUsingBlock:^(NSUInteger documentID, BOOL *stop) {
+        block(documentID, YES);
+    }];
+
+    for (NSUInteger termIndex = firstPrefixTerm; termIndex < termCount; termIndex++) {
+        const ATLMessageSearchIndexTermRecord *term = &terms[termIndex];
+        if (term->termLength < tokenLength || memcmp(strings + term->termOffset, tokenBytes, tokenLength) != 0) break;
+        for (uint32_t index = 0; index < term->postingCount; index++) {
+            block(postings[term->postingIndex + index], NO);
+        }
+    }
+    [self.postings enumerateKeysAndObjectsUsingBlock:^(NSString *term, NSMutableIndexSet *documentIDs, BOOL *stop) {
+        if (term.length <= token.length || ![term hasPrefix:token]) return;
+        [documentIDs enumerateIndexesUsingBlock:^(NSUInteger documentID, BOOL *stop) {
+            block(documentID, NO);
+        }];
+    }];
+}
+
+#pragma mark - Documents (must be called on the index queue)
+
+- (NSMutableDictionary *)loadedDocumentIDsByMessageIdentifier
+{
+    // Only built when the index is modified; searching doesn't need it.
+    if (!self.documentIDsByMessageIdentifier) {
+        NSUInteger documentCount = self.snapshotDocumentCount + self.documents.count;
+        NSMutableDictionary *documentIDsByMessageIdentifier = [NSMutableDictionary dictionaryWithCapacity:documentCount];
+        for (NSUInteger documentID = 0; documentID < documentCount; documentID++) {
+            if ([self.removedDocumentIDs containsIndex:documentID]) continue;
+            documentIDsByMessageIdentifier[[self messageIdentifierForDocumentID:documentID]] = @(documentID);
+        }
+        self.documentIDsByMessageIdentifier = documentIDsByMessageIdentifier;
+    }
+    return self.documentIDsByMessageIdentifier;
+}
+
+- (NSString *)messageIdentifierForDocumentID:(NSUInteger)documentID
+{
+    if (documentID >= self.snapshotDocumentCount) {
+        return self.documents[documentID - self.snapshotDocumentCount].messageIdentifier;
+    }
+    const ATLMessageSearchIndexDocumentRecord *record = &[self snapshotDocumentRecords][documentID];
+    return [[NSString alloc] initWithBytes:[self snapshotStrings] + record->messageIdentifierOffset length:record->messageIdentifierLength encoding:NSUTF8StringEncoding];
+}
+
+- (NSString *)conversationIdentifierForDocumentID:(NSUInteger)documentID
+{
+    if (documentID >= self.snapshotDocumentCount) {
+        return self.documents[documentID - self.snapshotDocumentCount].conversationIdentifier;
+    }
+    const ATLMessageSearchIndexDocumentRecord *record = &[self snapshotDocumentRecords][documentID];
+    return [[NSString alloc] initWithBytes:[self snapshotStrings] + record->conversationIdentifierOffset length:record->conversationIdentifierLength encoding:NSUTF8StringEncoding];
+}
+
+- (NSTimeInterval)sentAtForDocumentID:(NSUInteger)documentID
+{
+    if (documentID >= self.snapshotDocumentCount) {
+        return self.documents[documentID - self.snapshotDocumentCount].sentAt;
+    }
+    return [self snapshotDocumentRecords][documentID].sentAt;
+}
+
+#pragma mark - Index File (must be called on the index queue)
+
+- (void)loadSnapshot
+{
+    self.snapshot = nil;
+    self.snapshotDocumentCount = 0;
+    NSData *snapshot = [NSData dataWithContentsOfURL:self.fileURL options:NSDataReadingMappedAlways error:nil];
+    if (snapshot.length < sizeof(ATLMessageSearchIndexHeader)) return;
+    const ATLMessageSearchIndexHeader *header = snapshot.bytes;
+    if (header->magic != ATLMessageSearchIndexMagic || header->version != ATLMessageSearchIndexVersion) return;
+    uint64_t expectedLength = sizeof(ATLMessageSearchIndexHeader);
+    expectedLength += (uint64_t)header->documentCount * sizeof(ATLMessageSearchIndexDocumentRecord);
+    expectedLength += (uint64_t)header->termCount * sizeof(ATLMessageSearchIndexTermRecord);
+    expectedLength += (uint64_t)header->postingCount * sizeof(uint32_t);
+    expectedLength += header->stringsLength;
+    if (snapshot.length != expectedLength) {
+        NSLog(@"Ignoring corrupted message search index at %@", self.fileURL);
+        return;
+    }
+    self.snapshot = snapshot;
+    self.snapshotDocumentCount = header->documentCount;
+}
+
+- (const ATLMessageSearchIndexDocumentRecord *)snapshotDocumentRecords
+{
+    if (!self.snapshot) return NULL;
+    return (const ATLMessageSearchIndexDocumentRecord *)((const char *)self.snapshot.bytes + sizeof(ATLMessageSearchIndexHeader));
+}
+
+- (const ATLMessageSearchIndexTermRecord *)snapshotTermRecords
+{
+    if (!self.snapshot) return NULL;
+    const ATLMessageSearchIndexHeader *header = self.snapshot.bytes;
+    return (const ATLMessageSearchIndexTermRecord *)([self snapshotDocumentRecords] + header->documentCount);
+}
+
+- (const uint32_t *)snapshotPostings
+{
+    if (!self.snapshot) return NULL;
+    const ATLMessageSearchIndexHeader *header = self.snapshot.bytes;
+    return (const uint32_t *)([self snapshotTermRecords] + header->termCount);
+}
+
+- (const char *)snapshotStrings
+{
+    if (!self.snapshot) return NULL;
+    const ATLMessageSearchIndexHeader *header = self.snapshot.bytes;
+    return (const char *)([self snapshotPostings] + header->postingCount);
+}
+
+- (void)saveIfNeeded
+{
+    if (self.numberOfUnsavedChanges < ATLMessageSearchIndexAutosaveThreshold) return;
+    NSError *error;
+    if (![self writeSnapshot:&error]) {
+        NSLog(@"Failed to write message search index with error: %@", error);
+    }
+}
+
+- (BOOL)writeSnapshot:(NSError **)error
+{
+    if (self.numberOfUnsavedChanges == 0) return YES;
+
+    // Removed messages are dropped, so the remaining ones are renumbered consecutively, in the same order.
+    NSUInteger documentCount = self.snapshotDocumentCount + self.documents.count;
+    uint32_t *newDocumentIDs = malloc(MAX(documentCount, 1) * sizeof(uint32_t));
+    NSMutableData *documentRecords = [NSMutableData new];
+    NSMutableData *strings = [NSMutableData new];
+    NSMutableDictionary <NSString *, NSNumber *> *conversationIdentifierOffsets = [NSMutableDictionary new];
+    uint32_t newDocumentCount = 0;
+    for (NSUInteger documentID = 0; documentID < documentCount; documentID++) {
+        if ([self.removedDocumentIDs containsIndex:documentID]) {
+            newDocumentIDs[documentID] = UINT32_MAX;
+            continue;
+        }
+        newDocumentIDs[documentID] = newDocumentCount++;
+        ATLMessageSearchIndexDocumentRecord record;
+        NSData *messageIdentifier = [[self messageIdentifierForDocumentID:documentID] dataUsingEncoding:NSUTF8StringEncoding];
+        record.messageIdentifierOffset = ATLMessageSearchIndexAppendBytes(strings, messageIdentifier.bytes, messageIdentifier.length);
+        record.messageIdentifierLength = (uint32_t)messageIdentifier.length;
+        NSString *conversationIdentifier = [self conversationIdentifierForDocumentID:documentID];
+        NSNumber *conversationIdentifierOffset = conversationIdentifierOffsets[conversationIdentifier];
+        NSUInteger conversationIdentifierLength = [conversationIdentifier lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+        if (!conversationIdentifierOffset) {
+            conversationIdentifierOffset = @(ATLMessageSearchIndexAppendBytes(strings, conversationIdentifier.UTF8String, conversationIdentifierLength));
+            conversationIdentifierOffsets[conversationIdentifier] = conversationIdentifierOffset;
+        }
+        record.conversationIdentifierOffset = conversationIdentifierOffset.unsignedIntValue;
+        record.conversationIdentifierLength = (uint32_t)conversationIdentifierLength;
+        record.sentAt = [self sentAtForDocumentID:documentID];
+        [documentRecords appendBytes:&record length:sizeof(record)];
+    }
+
+    // Merge the sorted terms of the file with the sorted terms indexed since.
+    NSArray *deltaTerms = [self.postings.allKeys sortedArrayUsingComparator:^NSComparisonResult(NSString *term, NSString *otherTerm) {
+        const char *termBytes = term.UTF8String;
+        const char *otherTermBytes = otherTerm.UTF8String;
+        int comparison = ATLMessageSearchIndexCompareBytes(termBytes, strlen(termBytes), otherTermBytes, strlen(otherTermBytes));
+        return comparison == 0 ? NSOrderedSame : (comparison < 0 ? NSOrderedAscending : NSOrderedDescending);
+    }];
+    const ATLMessageSearchIndexHeader *header = self.snapshot.bytes;
+    const ATLMessageSearchIndexTermRecord *snapshotTerms = [self snapshotTermRecords];
+    const uint32_t *snapshotPostings = [self snapshotPostings];
+    const char *snapshotStrings = [self snapshotStrings];
+    NSUInteger snapshotTermCount = header ? header->termCount : 0;
+    NSMutableData *termRecords = [NSMutableData new];
+    NSMutableData *postings = [NSMutableData new];
+    NSUInteger snapshotTermIndex = 0;
+    NSUInteger deltaTermIndex = 0;
+    while (snapshotTermIndex < snapshotTermCount || deltaTermIndex < deltaTerms.count) {
+        const ATLMessageSearchIndexTermRecord *snapshotTerm = snapshotTermIndex < snapshotTermCount ? &snapshotTerms[snapshotTermIndex] : NULL;
+        NSString *deltaTerm = deltaTermIndex < deltaTerms.count ? deltaTerms[deltaTermIndex] : nil;
+        const char *deltaTermBytes = deltaTerm.UTF8String;
+        NSUInteger deltaTermLength = deltaTermBytes ? strlen(deltaTermBytes) : 0;
+        int comparison;
+        if (!snapshotTerm) {
+            comparison = 1;
+        } else if (!deltaTerm) {
+            comparison = -1;
+        } else {
+            comparison = ATLMessageSearchIndexCompareBytes(snapshotStrings + snapshotTerm->termOffset, snapshotTerm->termLength, deltaTermBytes, deltaTermLength);
+        }
+
+        uint32_t postingIndex = (uint32_t)(postings.length / sizeof(uint32_t));
+        if (comparison <= 0) {
+            for (uint32_t index = 0; index < snapshotTerm->postingCount; index++) {
+                uint32_t newDocumentID = newDocumentIDs[snapshotPostings[snapshotTerm->postingIndex + index]];
+                if (newDocumentID != UINT32_MAX) [postings appendBytes:&newDocumentID length:sizeof(newDocumentID)];
+            }
+        }
+        if (comparison >= 0) {
+            [self.postings[deltaTerm] enumerateIndexesUsingBlock:^(NSUInteger documentID, BOOL *stop) {
+                uint32_t newDocumentID = newDocumentIDs[documentID];
+                if (newDocumentID != UINT32_MAX) [postings appendBytes:&newDocumentID length:sizeof(newDocumentID)];
+            }];
+        }
+        uint32_t postingCount = (uint32_t)(postings.length / sizeof(uint32_t)) - postingIndex;
+        if (postingCount > 0) {
+            ATLMessageSearchIndexTermRecord record;
+            if (comparison <= 0) {
+                record.termOffset = ATLMessageSearchIndexAppendBytes(strings, snapshotStrings + snapshotTerm->termOffset, snapshotTerm->termLength);
+                record.termLength = snapshotTerm->termLength;
+            } else {
+                record.termOffset = ATLMessageSearchIndexAppendBytes(strings, deltaTermBytes, deltaTermLength);
+                record.termLength = (uint32_t)deltaTermLength;
+            }
+            record.postingIndex = postingIndex;
+            record.postingCount = postingCount;
+            [termRecords appendBytes:&record length:sizeof(record)];
+        }
+        if (comparison <= 0) snapshotTermIndex++;
+        if (comparison >= 0) deltaTermIndex++;
+    }
+    free(newDocumentIDs);
+
+    ATLMessageSearchIndexHeader newHeader;
+    newHeader.magic = ATLMessageSearchIndexMagic;
+    newHeader.version = ATLMessageSearchIndexVersion;
+    newHeader.documentCount = newDocumentCount;
+    newHeader.termCount = (uint32_t)(termRecords.length / sizeof(ATLMessageSearchIndexTermRecord));
+    newHeader.postingCount = (uint32_t)(postings.length / sizeof(uint32_t));
+    newHeader.stringsLength = (uint32_t)strings.length;
+    NSMutableData *fileData = [NSMutableData dataWithBytes:&newHeader length:sizeof(newHeader)];
+    [fileData appendData:documentRecords];
+    [fileData appendData:termRecords];
+    [fileData appendData:postings];
+    [fileData appendData:strings];
+
+    // Written atomically, so the file mapped until now stays valid until it's replaced below.
+    [[NSFileManager defaultManager] createDirectoryAtURL:[self.fileURL URLByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:nil];
+    if (![fileData writeToURL:self.fileURL options:NSDataWritingAtomic error:error]) {
+        return NO;
+    }
+    [self resetUnsavedChanges];
+    [self loadSnapshot];
+    return YES;
+}
+
+- (void)resetUnsavedChanges
+{
+    [self.documents removeAllObjects];
+    [self.postings removeAllObjects];
+    [self.removedDocumentIDs removeAllIndexes];
+    self.documentIDsByMessageIdentifier = nil;
+    self.numberOfUnsavedChanges = 0;
+}
+
+@end
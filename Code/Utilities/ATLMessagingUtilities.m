@@ -21,6 +21,7 @@
 #import "ATLMessagingUtilities.h"
 #import "ATLErrors.h"
 #import <AssetsLibrary/AssetsLibrary.h>
+#import <ImageIO/ImageIO.h>
 #import "ATLMessageCollectionViewCell.h"
 
 NSString *const ATLMIMETypeTextPlain = @"text/plain";
@@ -106,8 +107,23 @@ UIImage *ATLAdjustOrientationForImage(UIImage *originalImage)
 
 CGSize ATLImageSizeForData(NSData *data)
 {
-    UIImage *image = [UIImage imageWithData:data];
-    return ATLImageSize(image);
+    // Read the dimensions from the image header instead of decoding the whole image.
+    CGSize pixelSize = CGSizeZero;
+    CGImageSourceRef source = data ? CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL) : NULL;
+    if (source) {
+        CFDictionaryRef properties = CGImageSourceCopyPropertiesAtIndex(source, 0, NULL);
+        if (properties) {
+            NSDictionary *imageProperties = (__bridge NSDictionary *)properties;
+            pixelSize = CGSizeMake([imageProperties[(NSString *)kCGImagePropertyPixelWidth] floatValue], [imageProperties[(NSString *)kCGImagePropertyPixelHeight] floatValue]);
+            // EXIF orientations 5 through 8 are rotated by 90 degrees.
+            if ([imageProperties[(NSString *)kCGImagePropertyOrientation] integerValue] >= 5) {
+                pixelSize = CGSizeMake(pixelSize.height, pixelSize.width);
+            }
+            CFRelease(properties);
+        }
+        CFRelease(source);
+    }
+    return ATLConstrainImageSizeToCellSize(pixelSize);
 }
 
 CGSize ATLImageSizeForJSONData(NSData *data)
@@ -331,14 +347,37 @@ UIImage *ATLPinPhotoForSnapshot(MKMapSnapshot *snapshot, CLLocationCoordinate2D
     return finalImage;
 }
 
+/**
+ @abstract Returns a data detector for a set of types, creating it only the first time those types are asked for.
+ @discussion Compiling a detector is far more expensive than running it. Detectors are immutable, so a single
+ one per set of types can be shared between threads.
+ */
+static NSDataDetector *ATLDataDetectorForTypes(NSTextCheckingType linkTypes)
+{
+    static NSMutableDictionary <NSNumber *, NSDataDetector *> *dataDetectors;
+    static dispatch_queue_t dataDetectorQueue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        dataDetectors = [NSMutableDictionary new];
+        dataDetectorQueue = dispatch_queue_create("com.layer.Atlas.ATLMessagingUtilities.dataDetectorQueue", DISPATCH_QUEUE_SERIAL);
+    });
+    __block NSDataDetector *detector;
+    dispatch_sync(dataDetectorQueue, ^{
+        detector = dataDetectors[@(linkTypes)];
+        if (!detector) {
+            detector = [NSDataDetector dataDetectorWithTypes:linkTypes error:nil];
+            dataDetectors[@(linkTypes)] = detector;
+        }
+    });
+    return detector;
+}
+
 NSArray *ATLTextCheckingResultsForText(NSString *text, NSTextCheckingType linkTypes)
 {
     if (!text) return nil;
     
-    NSError *error;
-    NSDataDetector *detector = [NSDataDetector dataDetectorWithTypes:linkTypes
-                                                               error:&error];
-    if (error) return nil;
+    NSDataDetector *detector = ATLDataDetectorForTypes(linkTypes);
+    if (!detector) return nil;
     return [detector matchesInString:text options:kNilOptions range:NSMakeRange(0, text.length)];
 }
 
@@ -24,14 +24,36 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  @abstract Processes GIFs by finding frame count and duration and returns an auto-looping GIF
  @param data The NSData instance that should be returned as a looping GIF
- @return Returns a UIImage instance that has a looping GIF.  Can be used with any UIImageView
+ @param maximumPixelSize The maximum width or height of the decoded frames, in pixels.
+ @param scale The scale of the image, usually the main screen's, read on the main thread.
+ @return Returns an `ATLAnimatedImage` instance that decodes its frames on demand. Plays in an `ATLAnimatedImageView`, any other UIImageView shows the first frame.
  */
-UIImage *__nullable ATLAnimatedImageWithAnimatedGIFData(NSData *data);
+UIImage *__nullable ATLAnimatedImageWithAnimatedGIFData(NSData *data, CGFloat maximumPixelSize, CGFloat scale);
 
 /**
  @abstract Processes GIFs by finding frame count and duration and returns an auto-looping GIF
  @param url The NSURL instance that should be returned as a looping GIF
- @return Returns a UIImage instance that has a looping GIF.  Can be used with any UIImageView
+ @param maximumPixelSize The maximum width or height of the decoded frames, in pixels.
+ @param scale The scale of the image, usually the main screen's, read on the main thread.
+ @return Returns an `ATLAnimatedImage` instance that decodes its frames on demand. Plays in an `ATLAnimatedImageView`, any other UIImageView shows the first frame.
  */
- UIImage *__nullable ATLAnimatedImageWithAnimatedGIFURL(NSURL *url);
+ UIImage *__nullable ATLAnimatedImageWithAnimatedGIFURL(NSURL *url, CGFloat maximumPixelSize, CGFloat scale);
+
+/**
+ @abstract Downsamples the image file with Image I/O and decodes it into a bitmap, without ever decoding the full resolution image.
+ @param url The file URL of the encoded image.
+ @param pixelSize The size in pixels the image should fit in. Pass `CGSizeZero` to fit the maximum cell size.
+ @param scale The scale of the resulting image, usually the main screen's, read on the main thread.
+ @return Returns a UIImage instance backed by a decoded bitmap. Safe to call off the main thread.
+ */
+UIImage *__nullable ATLDecodedThumbnailWithContentsOfURL(NSURL *url, CGSize pixelSize, CGFloat scale);
+
+/**
+ @abstract Downsamples the encoded image data with Image I/O and decodes it into a bitmap, without ever decoding the full resolution image.
+ @param data The encoded image data.
+ @param pixelSize The size in pixels the image should fit in. Pass `CGSizeZero` to fit the maximum cell size.
+ @param scale The scale of the resulting image, usually the main screen's, read on the main thread.
+ @return Returns a UIImage instance backed by a decoded bitmap. Safe to call off the main thread.
+ */
+UIImage *__nullable ATLDecodedThumbnailWithData(NSData *data, CGSize pixelSize, CGFloat scale);
 NS_ASSUME_NONNULL_END
@@ -8,6 +8,8 @@
 
 
 #import "ATLUIImageHelper.h"
+#import "ATLMessagingUtilities.h"
+#import "ATLAnimatedImage.h"
 #import <ImageIO/ImageIO.h>
 
 #if __has_feature(objc_arc)
@@ -20,122 +22,81 @@
 
 #pragma mark - Private Methods
 
-static int ATLDelayCentisecondsForImageAtIndex(CGImageSourceRef const source, size_t const index)
+static UIImage *ATLAnimatedImageWithAnimatedGIFReleasingImageSource(CGImageSourceRef CF_RELEASES_ARGUMENT source, CGFloat maximumPixelSize, CGFloat scale)
 {
-    int delayCentiseconds = 1;
-    CFDictionaryRef const properties = CGImageSourceCopyPropertiesAtIndex(source, index, NULL);
-    if (properties) {
-        CFDictionaryRef const gifProperties = CFDictionaryGetValue(properties, kCGImagePropertyGIFDictionary);
-        if (gifProperties) {
-            NSNumber *gifFrameDuration = fromCF CFDictionaryGetValue(gifProperties, kCGImagePropertyGIFUnclampedDelayTime);
-            if (gifFrameDuration == NULL || [gifFrameDuration doubleValue] == 0) {
-                gifFrameDuration = fromCF CFDictionaryGetValue(gifProperties, kCGImagePropertyGIFDelayTime);
-            }
-            if ([gifFrameDuration doubleValue] > 0) {
-                // Even though the GIF stores the delay as an integer number of centiseconds, ImageIO “helpfully” converts that to seconds for us.
-                delayCentiseconds = (int)lrint([gifFrameDuration doubleValue] * 100);
-            }
-        }
-        CFRelease(properties);
+    if (!source) {
+        return nil;
     }
-    return delayCentiseconds;
+    UIImage *const image = [[ATLAnimatedImage alloc] initWithImageSource:source maximumPixelSize:maximumPixelSize scale:scale memoryLimit:ATLAnimatedImageDefaultMemoryLimit];
+    CFRelease(source);
+    return image;
 }
 
-static void ATLCreateImagesAndDelays(CGImageSourceRef source, size_t count, CGImageRef imagesOut[count], int delayCentisecondsOut[count])
+static CGImageRef ATLCreateDecodedImage(CGImageRef const image)
 {
-    for (size_t i = 0; i < count; ++i) {
-        imagesOut[i] = CGImageSourceCreateImageAtIndex(source, i, NULL);
-        delayCentisecondsOut[i] = ATLDelayCentisecondsForImageAtIndex(source, i);
+    size_t const width = CGImageGetWidth(image);
+    size_t const height = CGImageGetHeight(image);
+    CGImageAlphaInfo const alphaInfo = CGImageGetAlphaInfo(image);
+    BOOL const opaque = (alphaInfo == kCGImageAlphaNone || alphaInfo == kCGImageAlphaNoneSkipFirst || alphaInfo == kCGImageAlphaNoneSkipLast);
+    // Native 32-bit BGRA is what Core Animation can display without any conversion.
+    CGBitmapInfo const bitmapInfo = kCGBitmapByteOrder32Host | (opaque ? kCGImageAlphaNoneSkipFirst : kCGImageAlphaPremultipliedFirst);
+    CGColorSpaceRef const colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef const context = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace, bitmapInfo);
+    CGColorSpaceRelease(colorSpace);
+    if (!context) {
+        return CGImageRetain(image);
     }
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), image);
+    CGImageRef const decodedImage = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+    return decodedImage;
 }
 
-static int ATLSum(size_t const count, int const *const values)
+static UIImage *ATLDecodedThumbnailWithReleasingImageSource(CGImageSourceRef CF_RELEASES_ARGUMENT source, CGSize pixelSize, CGFloat scale)
 {
-    int theSum = 0;
-    for (size_t i = 0; i < count; ++i) {
-        theSum += values[i];
+    if (!source) {
+        return nil;
     }
-    return theSum;
-}
-
-static int ATLPairGCD(int duration, int gcd)
-{
-    if (duration < gcd) {
-        return ATLPairGCD(gcd, duration);
+    if (CGSizeEqualToSize(pixelSize, CGSizeZero)) {
+        pixelSize = CGSizeMake(ATLMaxCellWidth() * scale, ATLMaxCellHeight() * scale);
     }
-    while (true) {
-        int const r = duration % gcd;
-        if (r == 0) {
-            return gcd;
-        }
-        duration = gcd;
-        gcd = r;
+    NSDictionary *const thumbnailOptions = @{ (NSString *)kCGImageSourceCreateThumbnailFromImageAlways : @YES,
+                                              (NSString *)kCGImageSourceCreateThumbnailWithTransform : @YES,
+                                              (NSString *)kCGImageSourceShouldCacheImmediately : @YES,
+                                              (NSString *)kCGImageSourceThumbnailMaxPixelSize : @(ceil(MAX(pixelSize.width, pixelSize.height))) };
+    CGImageRef const thumbnail = CGImageSourceCreateThumbnailAtIndex(source, 0, (__bridge CFDictionaryRef)thumbnailOptions);
+    CFRelease(source);
+    if (!thumbnail) {
+        return nil;
     }
+    CGImageRef const decodedThumbnail = ATLCreateDecodedImage(thumbnail);
+    CGImageRelease(thumbnail);
+    UIImage *const image = [UIImage imageWithCGImage:decodedThumbnail scale:scale orientation:UIImageOrientationUp];
+    CGImageRelease(decodedThumbnail);
+    return image;
 }
 
-static int ATLVectorGCD(size_t const count, int const *const values)
-{
-    int gcd = values[0];
-    for (size_t i = 1; i < count; ++i) {
-        // Note that after I process the first few elements of the vector, `gcd` will probably be smaller than any remaining element.  By passing the smaller value as the second argument to `pairGCD`, I avoid making it swap the arguments.
-        gcd = ATLPairGCD(values[i], gcd);
-    }
-    return gcd;
-}
+#pragma mark - Public Helper Methods
 
-static NSArray *ATLFrameArray(size_t const count, CGImageRef const images[count], int const delayCentiseconds[count], int const totalDurationCentiseconds)
+UIImage *ATLAnimatedImageWithAnimatedGIFData(NSData *data, CGFloat maximumPixelSize, CGFloat scale)
 {
-    int const gcd = ATLVectorGCD(count, delayCentiseconds);
-    size_t const frameCount = totalDurationCentiseconds / gcd;
-    UIImage *frames[frameCount];
-    for (size_t i = 0, f = 0; i < count; ++i) {
-        UIImage *const frame = [UIImage imageWithCGImage:images[i]];
-        for (size_t j = delayCentiseconds[i] / gcd; j > 0; --j) {
-            frames[f++] = frame;
-        }
-    }
-    return [NSArray arrayWithObjects:frames count:frameCount];
+    return ATLAnimatedImageWithAnimatedGIFReleasingImageSource(CGImageSourceCreateWithData(toCF data, NULL), maximumPixelSize, scale);
 }
 
-static void ATLReleaseImages(size_t const count, CGImageRef const images[count])
+UIImage *ATLAnimatedImageWithAnimatedGIFURL(NSURL *url, CGFloat maximumPixelSize, CGFloat scale)
 {
-    for (size_t i = 0; i < count; ++i) {
-        CGImageRelease(images[i]);
-    }
+    return ATLAnimatedImageWithAnimatedGIFReleasingImageSource(CGImageSourceCreateWithURL(toCF url, NULL), maximumPixelSize, scale);
 }
 
-static UIImage *ATLAnimatedImageWithAnimatedGIFImageSource(CGImageSourceRef const source)
+UIImage *ATLDecodedThumbnailWithContentsOfURL(NSURL *url, CGSize pixelSize, CGFloat scale)
 {
-    size_t const count = CGImageSourceGetCount(source);
-    CGImageRef images[count];
-    int delayCentiseconds[count]; // in centiseconds
-    ATLCreateImagesAndDelays(source, count, images, delayCentiseconds);
-    int const totalDurationCentiseconds = ATLSum(count, delayCentiseconds);
-    NSArray *const frames = ATLFrameArray(count, images, delayCentiseconds, totalDurationCentiseconds);
-    UIImage *const animation = [UIImage animatedImageWithImages:frames duration:(NSTimeInterval)totalDurationCentiseconds / 100.0];
-    ATLReleaseImages(count, images);
-    return animation;
+    return ATLDecodedThumbnailWithReleasingImageSource(CGImageSourceCreateWithURL(toCF url, NULL), pixelSize, scale);
 }
 
-static UIImage *ATLAnimatedImageWithAnimatedGIFReleasingImageSource(CGImageSourceRef CF_RELEASES_ARGUMENT source)
+UIImage *ATLDecodedThumbnailWithData(NSData *data, CGSize pixelSize, CGFloat scale)
 {
-    if (source) {
-        UIImage *const image = ATLAnimatedImageWithAnimatedGIFImageSource(source);
-        CFRelease(source);
-        return image;
-    } else {
+    if (!data) {
         return nil;
     }
-}
-
-#pragma mark - Public Helper Methods
-
-UIImage *ATLAnimatedImageWithAnimatedGIFData(NSData *data)
-{
-    return ATLAnimatedImageWithAnimatedGIFReleasingImageSource(CGImageSourceCreateWithData(toCF data, NULL));
-}
-
-UIImage *ATLAnimatedImageWithAnimatedGIFURL(NSURL *url)
-{
-    return ATLAnimatedImageWithAnimatedGIFReleasingImageSource(CGImageSourceCreateWithURL(toCF url, NULL));
+    return ATLDecodedThumbnailWithReleasingImageSource(CGImageSourceCreateWithData(toCF data, NULL), pixelSize, scale);
 }
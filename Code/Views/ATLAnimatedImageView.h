@@ -0,0 +1,39 @@
+//
+//  ATLAnimatedImageView.h
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <UIKit/UIKit.h>
+#import "ATLAnimatedImage.h"
+
+/**
+ @abstract The `ATLAnimatedImageView` class is an image view which plays
+   `ATLAnimatedImage` instances assigned to its `image` property.
+ @discussion Frames are advanced by a `CADisplayLink` while the view is in a
+   window. When the next frame hasn't been decoded in time, the current frame
+   stays on screen a little longer instead of the animation skipping ahead.
+   Any other image is displayed like a regular `UIImageView` would.
+ */
+@interface ATLAnimatedImageView : UIImageView
+
+/**
+ @abstract The animated image being played, if the image is an `ATLAnimatedImage`.
+ */
+@property (nonatomic, readonly, nullable) ATLAnimatedImage *animatedImage;
+
+@end
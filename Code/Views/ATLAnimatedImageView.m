@@ -0,0 +1,112 @@
+//
+//  ATLAnimatedImageView.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ATLAnimatedImageView.h"
+
+@interface ATLAnimatedImageView ()
+
+@property (nonatomic, readwrite) ATLAnimatedImage *animatedImage;
+@property (nonatomic) CADisplayLink *displayLink;
+@property (nonatomic) NSUInteger currentFrameIndex;
+@property (nonatomic) NSTimeInterval accumulatedTime;
+@property (nonatomic) CFTimeInterval lastTimestamp;
+
+@end
+
+@implementation ATLAnimatedImageView
+
+- (void)dealloc
+{
+    [_displayLink invalidate];
+}
+
+- (void)setImage:(UIImage *)image
+{
+    if (image == self.image) {
+        return;
+    }
+    [super setImage:image];
+    self.currentFrameIndex = 0;
+    self.accumulatedTime = 0;
+    self.lastTimestamp = 0;
+    if ([image isKindOfClass:[ATLAnimatedImage class]] && ((ATLAnimatedImage *)image).frameCount > 1) {
+        self.animatedImage = (ATLAnimatedImage *)image;
+    } else {
+        self.animatedImage = nil;
+    }
+    [self updateDisplayLink];
+}
+
+- (void)didMoveToWindow
+{
+    [super didMoveToWindow];
+    [self updateDisplayLink];
+}
+
+- (void)setHidden:(BOOL)hidden
+{
+    [super setHidden:hidden];
+    [self updateDisplayLink];
+}
+
+#pragma mark - Display Link
+
+- (void)updateDisplayLink
+{
+    // The display link retains its target, so it only exists while there's something on screen to animate.
+    BOOL shouldAnimate = self.animatedImage && self.window && !self.hidden;
+    if (shouldAnimate && !self.displayLink) {
+        // Time spent off screen doesn't count towards the current frame.
+        self.lastTimestamp = 0;
+        // Starts decoding the frames following the current one, so the next one is ready when it's due.
+        [self.animatedImage frameAtIndex:self.currentFrameIndex];
+        self.displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(displayLinkDidFire:)];
+        [self.displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+    } else if (!shouldAnimate && self.displayLink) {
+        [self.displayLink invalidate];
+        self.displayLink = nil;
+    }
+}
+
+- (void)displayLinkDidFire:(CADisplayLink *)displayLink
+{
+    ATLAnimatedImage *animatedImage = self.animatedImage;
+    // Timestamps rather than the nominal duration, so dropped display frames don't slow the animation down.
+    if (self.lastTimestamp > 0) {
+        self.accumulatedTime += displayLink.timestamp - self.lastTimestamp;
+    }
+    self.lastTimestamp = displayLink.timestamp;
+    NSTimeInterval frameDuration = [animatedImage durationOfFrameAtIndex:self.currentFrameIndex];
+    if (self.accumulatedTime < frameDuration) {
+        return;
+    }
+    // Only asking for a frame when one is due keeps the ring of upcoming frames topped up without touching it on every tick.
+    NSUInteger nextFrameIndex = (self.currentFrameIndex + 1) % animatedImage.frameCount;
+    UIImage *nextFrame = [animatedImage frameAtIndex:nextFrameIndex];
+    if (!nextFrame) {
+        // Not decoded yet; hold the current frame until it is.
+        return;
+    }
+    self.accumulatedTime = MIN(self.accumulatedTime - frameDuration, [animatedImage durationOfFrameAtIndex:nextFrameIndex]);
+    self.currentFrameIndex = nextFrameIndex;
+    self.layer.contents = (__bridge id)nextFrame.CGImage;
+}
+
+@end
@@ -68,5 +68,15 @@ extern NSString *const ATLConversationViewHeaderIdentifier;
  */
 + (CGFloat)headerHeightWithDateString:(NSAttributedString *)dateString participantName:(NSString *)participantName inView:(UIView *)view;
 
+/**
+ @abstract Measures date strings and participant names on a background queue, so that headers displaying them
+ can later be sized without measuring text on the main thread.
+ @param dateStrings The date strings that will be displayed.
+ @param participantNames The participant names that will be displayed.
+ @param view The superview for the headers.
+ @param completion Called on the main thread once everything is measured.
+ */
++ (void)prepareHeightsForDateStrings:(NSArray <NSAttributedString *> *)dateStrings participantNames:(NSArray <NSString *> *)participantNames inView:(UIView *)view completion:(nullable void (^)(void))completion;
+
 @end
 NS_ASSUME_NONNULL_END
@@ -21,6 +21,38 @@
 #import "ATLConstants.h"
 #import "ATLMessagingUtilities.h"
 
+/**
+ @abstract Keys the label height cache by text and font. `NSArray` hashes by element count, which would put every key in the same bucket.
+ */
+@interface ATLLabelHeightCacheKey : NSObject <NSCopying>
+
+@property (nonatomic, copy) NSAttributedString *text;
+@property (nonatomic) UIFont *font;
+
+@end
+
+@implementation ATLLabelHeightCacheKey
+
+- (NSUInteger)hash
+{
+    return self.text.hash ^ (self.font.fontName.hash * 31) ^ (NSUInteger)(self.font.pointSize * 1000);
+}
+
+- (BOOL)isEqual:(id)object
+{
+    if (object == self) return YES;
+    if (![object isKindOfClass:[ATLLabelHeightCacheKey class]]) return NO;
+    ATLLabelHeightCacheKey *key = object;
+    return [self.font isEqual:key.font] && [self.text isEqualToAttributedString:key.text];
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    return self;
+}
+
+@end
+
 @interface ATLConversationCollectionViewHeader ()
 
 @property (nonatomic) UILabel *dateLabel;
@@ -38,6 +70,7 @@ CGFloat const ATLConversationViewHeaderTopPadding = 10;
 CGFloat const ATLConversationViewHeaderDateBottomPadding = 8;
 CGFloat const ATLConversationViewHeaderParticipantNameBottomPadding = 3;
 CGFloat const ATLConversationViewHeaderEmptyHeight = 1;
+static char const ATLConversationViewHeaderMeasuringQueueName[] = "com.layer.Atlas.ATLConversationCollectionViewHeader.measuringQueue";
 
 + (ATLConversationCollectionViewHeader *)sharedHeader
 {
@@ -49,6 +82,27 @@ CGFloat const ATLConversationViewHeaderEmptyHeight = 1;
     return _sharedHeader;
 }
 
++ (NSCache *)sharedLabelHeightCache
+{
+    static NSCache *sharedLabelHeightCache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedLabelHeightCache = [NSCache new];
+        sharedLabelHeightCache.countLimit = 500;
+    });
+    return sharedLabelHeightCache;
+}
+
++ (dispatch_queue_t)measuringQueue
+{
+    static dispatch_queue_t measuringQueue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        measuringQueue = dispatch_queue_create(ATLConversationViewHeaderMeasuringQueueName, DISPATCH_QUEUE_SERIAL);
+    });
+    return measuringQueue;
+}
+
 + (void)initialize
 {
     ATLConversationCollectionViewHeader *proxy = [self appearance];
@@ -130,30 +184,74 @@ CGFloat const ATLConversationViewHeaderEmptyHeight = 1;
 {
     if (!dateString && !participantName) return ATLConversationViewHeaderEmptyHeight;
     
-    ATLConversationCollectionViewHeader *header = [self sharedHeader];
-    // Temporarily adding the view to the hierarchy so that UIAppearance property values will be set based on containment.
-    [view addSubview:header];
-    [header removeFromSuperview];
-    
+    ATLConversationCollectionViewHeader *header = [self headerResolvingAppearanceInView:view];
     CGFloat height = 0;
     height += ATLConversationViewHeaderTopPadding;
-    NSString *string = dateString.string;
     
-    if (string.length) {
-        [header updateWithAttributedStringForDate:dateString];
-        CGSize dateSize = [header.dateLabel sizeThatFits:CGSizeMake(CGFLOAT_MAX, CGFLOAT_MAX)];
-        height += dateSize.height + ATLConversationViewHeaderDateBottomPadding;
+    if (dateString.string.length) {
+        height += [self heightForLabelText:dateString font:header.dateLabel.font] + ATLConversationViewHeaderDateBottomPadding;
     }
     
     if (participantName.length) {
-        [header updateWithParticipantName:participantName];
-        CGSize participantSize = [header.participantLabel sizeThatFits:CGSizeMake(CGFLOAT_MAX, CGFLOAT_MAX)];
-        height += participantSize.height + ATLConversationViewHeaderParticipantNameBottomPadding;
+        NSAttributedString *participantString = [[NSAttributedString alloc] initWithString:participantName];
+        height += [self heightForLabelText:participantString font:header.participantLabel.font] + ATLConversationViewHeaderParticipantNameBottomPadding;
     }
     
     return height;
 }
 
++ (void)prepareHeightsForDateStrings:(NSArray <NSAttributedString *> *)dateStrings participantNames:(NSArray <NSString *> *)participantNames inView:(UIView *)view completion:(void (^)(void))completion
+{
+    ATLConversationCollectionViewHeader *header = [self headerResolvingAppearanceInView:view];
+    UIFont *dateLabelFont = header.dateLabel.font;
+    UIFont *participantLabelFont = header.participantLabel.font;
+    dispatch_async([self measuringQueue], ^{
+        for (NSAttributedString *dateString in dateStrings) {
+            [self heightForLabelText:dateString font:dateLabelFont];
+        }
+        for (NSString *participantName in participantNames) {
+            [self heightForLabelText:[[NSAttributedString alloc] initWithString:participantName] font:participantLabelFont];
+        }
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), completion);
+        }
+    });
+}
+
++ (ATLConversationCollectionViewHeader *)headerResolvingAppearanceInView:(UIView *)view
+{
+    ATLConversationCollectionViewHeader *header = [self sharedHeader];
+    // Temporarily adding the view to the hierarchy so that UIAppearance property values will be set based on containment.
+    [view addSubview:header];
+    [header removeFromSuperview];
+    return header;
+}
+
+/**
+ @abstract Measures a single line label, like `sizeThatFits:` would. Safe to call from any thread; heights are cached by text and font.
+ */
++ (CGFloat)heightForLabelText:(NSAttributedString *)text font:(UIFont *)font
+{
+    if (!text.length || !font) return 0;
+    ATLLabelHeightCacheKey *key = [ATLLabelHeightCacheKey new];
+    key.text = text;
+    key.font = font;
+    NSNumber *cachedHeight = [[self sharedLabelHeightCache] objectForKey:key];
+    if (cachedHeight) {
+        return cachedHeight.doubleValue;
+    }
+    // Like a label, fall back to its font wherever the text doesn't specify one.
+    NSMutableAttributedString *textWithFont = [text mutableCopy];
+    [textWithFont enumerateAttribute:NSFontAttributeName inRange:NSMakeRange(0, textWithFont.length) options:0 usingBlock:^(UIFont *attributeFont, NSRange range, BOOL *stop) {
+        if (attributeFont) return;
+        [textWithFont addAttribute:NSFontAttributeName value:font range:range];
+    }];
+    CGRect rect = [textWithFont boundingRectWithSize:CGSizeMake(CGFLOAT_MAX, CGFLOAT_MAX) options:NSStringDrawingUsesLineFragmentOrigin context:nil];
+    CGFloat height = ceil(CGRectGetHeight(rect));
+    [[self sharedLabelHeightCache] setObject:@(height) forKey:key];
+    return height;
+}
+
 - (void)configureDateLabelConstraints
 {
     [self addConstraint:[NSLayoutConstraint constraintWithItem:self.dateLabel attribute:NSLayoutAttributeTop relatedBy:NSLayoutRelationEqual toItem:self attribute:NSLayoutAttributeTop multiplier:1.0 constant:ATLConversationViewHeaderTopPadding]];
@@ -0,0 +1,60 @@
+//
+//  ATLConversationCollectionViewLayout.h
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+/**
+ @abstract An invalidation context which re-measures only the given sections of an `ATLConversationCollectionViewLayout`.
+ */
+@interface ATLConversationCollectionViewLayoutInvalidationContext : UICollectionViewLayoutInvalidationContext
+
+/**
+ @abstract The sections whose header, items or footer changed size.
+ */
+@property (nonatomic, copy, nullable) NSIndexSet *invalidatedSections;
+
+@end
+
+/**
+ @abstract The `ATLConversationCollectionViewLayout` class stacks the sections of a conversation
+ vertically, each one made of a header, its items and a footer, all spanning the width of the
+ collection view.
+ @discussion Sizes are provided by the collection view delegate through the
+ `UICollectionViewDelegateFlowLayout` methods `collectionView:layout:sizeForItemAtIndexPath:`,
+ `collectionView:layout:referenceSizeForHeaderInSection:` and `collectionView:layout:referenceSizeForFooterInSection:`.
+
+ The layout keeps a table of cumulative section offsets, so finding the elements in a rect is a
+ binary search. Batch updates only measure the inserted, moved and reloaded sections and their
+ direct neighbours, whose headers and footers depend on them; every other section keeps its
+ measurements. When sections change above the visible area, the content offset is adjusted so
+ the messages on screen stay put. Keeping a collection view scrolled to the bottom when messages are
+ added below is left to its owner.
+ */
+@interface ATLConversationCollectionViewLayout : UICollectionViewLayout
+
+/**
+ @abstract Re-measures only the given sections on the next layout pass.
+ @param sections The indexes of the sections that changed size. When called from within `performBatchUpdates:completion:`, the indexes refer to the sections after the updates.
+ */
+- (void)invalidateLayoutForSections:(NSIndexSet *)sections;
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,473 @@
+//
+//  ATLConversationCollectionViewLayout.m
+//  Atlas
+//
+//  Created by Layer on 10/17/26.
+//  Copyright (c) 2026 Layer, Inc. All rights reserved.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#import "ATLConversationCollectionViewLayout.h"
+
+static CGSize const ATLConversationCollectionViewLayoutDefaultItemSize = {50, 50};
+
+@implementation ATLConversationCollectionViewLayoutInvalidationContext
+
+@end
+
+/**
+ @abstract The measurements of a single section. Item frames are relative to the top of the section.
+ */
+@interface ATLConversationCollectionViewLayoutSection : NSObject
+
+@property (nonatomic) CGFloat offset;
+@property (nonatomic) CGFloat headerHeight;
+@property (nonatomic) CGFloat footerHeight;
+@property (nonatomic) NSArray <NSValue *> *itemFrames;
+@property (nonatomic) CGFloat itemsHeight;
+@property (nonatomic) BOOL needsMeasure;
+
+@end
+
+@implementation ATLConversationCollectionViewLayoutSection
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        _itemFrames = @[];
+        _needsMeasure = YES;
+    }
+    return self;
+}
+
+- (CGFloat)height
+{
+    return self.headerHeight + self.itemsHeight + self.footerHeight;
+}
+
+- (CGFloat)maxY
+{
+    return self.offset + self.height;
+}
+
+@end
+
+@interface ATLConversationCollectionViewLayout ()
+
+@property (nonatomic) NSMutableArray <ATLConversationCollectionViewLayoutSection *> *sections;
+@property (nonatomic) CGFloat measuredWidth;
+@property (nonatomic) BOOL needsFullRebuild;
+@property (nonatomic) BOOL awaitingCollectionViewUpdates;
+@property (nonatomic) BOOL deferredForCollectionViewUpdates;
+@property (nonatomic) NSMutableIndexSet *pendingInvalidatedSections;
+@property (nonatomic) BOOL hasTargetContentOffset;
+@property (nonatomic) CGPoint targetContentOffset;
+
+@end
+
+@implementation ATLConversationCollectionViewLayout
+
+- (id)init
+{
+    self = [super init];
+    if (self) {
+        [self lyr_commonInit];
+    }
+    return self;
+}
+
+- (id)initWithCoder:(NSCoder *)aDecoder
+{
+    self = [super initWithCoder:aDecoder];
+    if (self) {
+        [self lyr_commonInit];
+    }
+    return self;
+}
+
+- (void)lyr_commonInit
+{
+    _sections = [NSMutableArray new];
+    _pendingInvalidatedSections = [NSMutableIndexSet new];
+    _needsFullRebuild = YES;
+}
+
++ (Class)invalidationContextClass
+{
+    return [ATLConversationCollectionViewLayoutInvalidationContext class];
+}
+
+#pragma mark - Invalidation
+
+- (void)invalidateLayoutForSections:(NSIndexSet *)sections
+{
+    if (sections.count == 0) return;
+    ATLConversationCollectionViewLayoutInvalidationContext *context = [ATLConversationCollectionViewLayoutInvalidationContext new];
+    context.invalidatedSections = sections;
+    [self invalidateLayoutWithContext:context];
+}
+
+- (void)invalidateLayoutWithContext:(UICollectionViewLayoutInvalidationContext *)context
+{
+    if (context.invalidateEverything) {
+        self.needsFullRebuild = YES;
+    } else if (context.invalidateDataSourceCounts) {
+        // Batch updates invalidate the counts first and describe the changes in `prepareForCollectionViewUpdates:`.
+        self.awaitingCollectionViewUpdates = YES;
+    }
+    if ([context isKindOfClass:[ATLConversationCollectionViewLayoutInvalidationContext class]]) {
+        NSIndexSet *invalidatedSections = [(ATLConversationCollectionViewLayoutInvalidationContext *)context invalidatedSections];
+        if (invalidatedSections) {
+            [self.pendingInvalidatedSections addIndexes:invalidatedSections];
+        }
+    }
+    [super invalidateLayoutWithContext:context];
+}
+
+- (BOOL)shouldInvalidateLayoutForBoundsChange:(CGRect)newBounds
+{
+    return CGRectGetWidth(newBounds) != self.measuredWidth;
+}
+
+#pragma mark - Layout Preparation
+
+- (void)prepareLayout
+{
+    [super prepareLayout];
+    CGFloat width = CGRectGetWidth(self.collectionView.bounds);
+    if (width != self.measuredWidth) {
+        self.measuredWidth = width;
+        self.needsFullRebuild = YES;
+    }
+    if (self.needsFullRebuild) {
+        [self rebuildAllSections];
+        return;
+    }
+    if (self.awaitingCollectionViewUpdates) {
+        // The records are spliced, and invalidated sections measured, in `prepareForCollectionViewUpdates:`. If a second pass comes first, no updates are on their way.
+        if (self.deferredForCollectionViewUpdates) {
+            [self rebuildAllSections];
+        } else {
+            self.deferredForCollectionViewUpdates = YES;
+        }
+        return;
+    }
+    [self measureInvalidatedSections];
+}
+
+- (void)prepareForCollectionViewUpdates:(NSArray<UICollectionViewUpdateItem *> *)updateItems
+{
+    [super prepareForCollectionViewUpdates:updateItems];
+    BOOL awaitingCollectionViewUpdates = self.awaitingCollectionViewUpdates;
+    self.awaitingCollectionViewUpdates = NO;
+    self.deferredForCollectionViewUpdates = NO;
+    if (self.needsFullRebuild || !awaitingCollectionViewUpdates) {
+        return;
+    }
+    
+    // Remember which message sits at the top of the screen, so it can stay put once the changes above it are applied.
+    UICollectionView *collectionView = self.collectionView;
+    CGFloat visibleMinY = collectionView.contentOffset.y + collectionView.contentInset.top;
+    ATLConversationCollectionViewLayoutSection *anchorSection = [self anchorSectionForOffset:visibleMinY];
+    CGFloat anchorOffset = anchorSection.offset + anchorSection.headerHeight;
+    
+    NSMutableIndexSet *removedSections = [NSMutableIndexSet new];
+    NSMutableIndexSet *insertedSections = [NSMutableIndexSet new];
+    NSMutableIndexSet *changedSections = [NSMutableIndexSet new];
+    for (UICollectionViewUpdateItem *updateItem in updateItems) {
+        NSIndexPath *before = updateItem.indexPathBeforeUpdate;
+        NSIndexPath *after = updateItem.indexPathAfterUpdate;
+        BOOL sectionUpdate = (before ?: after).item == NSNotFound;
+        if (!sectionUpdate) {
+            // Item updates keep the section in place; it only needs to be measured again.
+            if (after) [changedSections addIndex:after.section];
+            continue;
+        }
+        switch (updateItem.updateAction) {
+            case UICollectionUpdateActionInsert:
+                [insertedSections addIndex:after.section];
+                break;
+            case UICollectionUpdateActionDelete:
+                [removedSections addIndex:before.section];
+                break;
+            case UICollectionUpdateActionReload:
+            case UICollectionUpdateActionMove:
+                [removedSections addIndex:before.section];
+                [insertedSections addIndex:after.section];
+                break;
+            default:
+                break;
+        }
+    }
+    
+    // Headers and footers depend on the neighbouring messages, so the sections around a removal are measured again.
+    NSUInteger sectionCount = self.sections.count;
+    [removedSections enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        if (idx >= sectionCount) return;
+        if (idx > 0) self.sections[idx - 1].needsMeasure = YES;
+        if (idx + 1 < sectionCount) self.sections[idx + 1].needsMeasure = YES;
+    }];
+    if (removedSections.lastIndex != NSNotFound && removedSections.lastIndex >= sectionCount) {
+        [self rebuildAllSections];
+        return;
+    }
+    [self.sections removeObjectsAtIndexes:removedSections];
+    
+    NSMutableArray *newSections = [NSMutableArray arrayWithCapacity:insertedSections.count];
+    for (NSUInteger index = 0; index < insertedSections.count; index++) {
+        [newSections addObject:[ATLConversationCollectionViewLayoutSection new]];
+    }
+    if (insertedSections.lastIndex != NSNotFound && insertedSections.lastIndex >= self.sections.count + insertedSections.count) {
+        [self rebuildAllSections];
+        return;
+    }
+    [self.sections insertObjects:newSections atIndexes:insertedSections];
+    if (self.sections.count != (NSUInteger)[collectionView numberOfSections]) {
+        [self rebuildAllSections];
+        return;
+    }
+    
+    sectionCount = self.sections.count;
+    [insertedSections enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        if (idx > 0) self.sections[idx - 1].needsMeasure = YES;
+        if (idx + 1 < sectionCount) self.sections[idx + 1].needsMeasure = YES;
+    }];
+    [changedSections enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        if (idx < sectionCount) self.sections[idx].needsMeasure = YES;
+    }];
+    [self measureInvalidatedSections];
+    
+    if (anchorSection) {
+        NSUInteger newAnchorIndex = [self.sections indexOfObjectIdenticalTo:anchorSection];
+        if (newAnchorIndex != NSNotFound) {
+            CGFloat delta = anchorSection.offset + anchorSection.headerHeight - anchorOffset;
+            if (delta != 0) {
+                CGFloat minimumOffset = -collectionView.contentInset.top;
+                CGFloat maximumOffset = MAX(minimumOffset, self.collectionViewContentSize.height - (CGRectGetHeight(collectionView.frame) - collectionView.contentInset.bottom));
+                CGFloat targetOffset = MIN(MAX(collectionView.contentOffset.y + delta, minimumOffset), maximumOffset);
+                self.targetContentOffset = CGPointMake(collectionView.contentOffset.x, targetOffset);
+                self.hasTargetContentOffset = YES;
+            }
+        }
+    }
+}
+
+- (void)finalizeCollectionViewUpdates
+{
+    [super finalizeCollectionViewUpdates];
+    self.hasTargetContentOffset = NO;
+}
+
+- (CGPoint)targetContentOffsetForProposedContentOffset:(CGPoint)proposedContentOffset
+{
+    if (self.hasTargetContentOffset) {
+        return self.targetContentOffset;
+    }
+    return [super targetContentOffsetForProposedContentOffset:proposedContentOffset];
+}
+
+#pragma mark - Measuring
+
+- (void)rebuildAllSections
+{
+    self.needsFullRebuild = NO;
+    self.awaitingCollectionViewUpdates = NO;
+    self.deferredForCollectionViewUpdates = NO;
+    [self.pendingInvalidatedSections removeAllIndexes];
+    NSInteger numberOfSections = [self.collectionView numberOfSections];
+    NSMutableArray *sections = [NSMutableArray arrayWithCapacity:numberOfSections];
+    CGFloat offset = 0;
+    for (NSInteger section = 0; section < numberOfSections; section++) {
+        ATLConversationCollectionViewLayoutSection *layoutSection = [ATLConversationCollectionViewLayoutSection new];
+        [self measureSection:layoutSection atIndex:section];
+        layoutSection.offset = offset;
+        offset = layoutSection.maxY;
+        [sections addObject:layoutSection];
+    }
+    self.sections = sections;
+}
+
+- (void)measureInvalidatedSections
+{
+    NSUInteger sectionCount = self.sections.count;
+    [self.pendingInvalidatedSections enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+        if (idx < sectionCount) self.sections[idx].needsMeasure = YES;
+    }];
+    [self.pendingInvalidatedSections removeAllIndexes];
+    
+    // Only sections flagged for measuring ask the delegate for sizes; the others only get their offset shifted.
+    NSUInteger firstChangedIndex = NSNotFound;
+    for (NSUInteger index = 0; index < sectionCount; index++) {
+        ATLConversationCollectionViewLayoutSection *layoutSection = self.sections[index];
+        if (!layoutSection.needsMeasure) continue;
+        [self measureSection:layoutSection atIndex:index];
+        if (firstChangedIndex == NSNotFound) firstChangedIndex = index;
+    }
+    if (firstChangedIndex == NSNotFound) return;
+    CGFloat offset = firstChangedIndex > 0 ? self.sections[firstChangedIndex - 1].maxY : 0;
+    for (NSUInteger index = firstChangedIndex; index < sectionCount; index++) {
+        ATLConversationCollectionViewLayoutSection *layoutSection = self.sections[index];
+        layoutSection.offset = offset;
+        offset = layoutSection.maxY;
+    }
+}
+
+- (void)measureSection:(ATLConversationCollectionViewLayoutSection *)layoutSection atIndex:(NSInteger)section
+{
+    UICollectionView *collectionView = self.collectionView;
+    id<UICollectionViewDelegateFlowLayout> delegate = (id<UICollectionViewDelegateFlowLayout>)collectionView.delegate;
+    CGFloat width = self.measuredWidth;
+    
+    CGFloat headerHeight = 0;
+    if ([delegate respondsToSelector:@selector(collectionView:layout:referenceSizeForHeaderInSection:)]) {
+        headerHeight = [delegate collectionView:collectionView layout:self referenceSizeForHeaderInSection:section].height;
+    }
+    CGFloat footerHeight = 0;
+    if ([delegate respondsToSelector:@selector(collectionView:layout:referenceSizeForFooterInSection:)]) {
+        footerHeight = [delegate collectionView:collectionView layout:self referenceSizeForFooterInSection:section].height;
+    }
+    
+    NSInteger numberOfItems = [collectionView numberOfItemsInSection:section];
+    NSMutableArray *itemFrames = [NSMutableArray arrayWithCapacity:numberOfItems];
+    CGFloat itemOffset = headerHeight;
+    BOOL delegateProvidesItemSizes = [delegate respondsToSelector:@selector(collectionView:layout:sizeForItemAtIndexPath:)];
+    for (NSInteger item = 0; item < numberOfItems; item++) {
+        CGSize size = ATLConversationCollectionViewLayoutDefaultItemSize;
+        if (delegateProvidesItemSizes) {
+            size = [delegate collectionView:collectionView layout:self sizeForItemAtIndexPath:[NSIndexPath indexPathForItem:item inSection:section]];
+        }
+        CGFloat itemWidth = MIN(size.width, width);
+        CGRect frame = CGRectMake(floor((width - itemWidth) / 2), itemOffset, itemWidth, size.height);
+        [itemFrames addObject:[NSValue valueWithCGRect:frame]];
+        itemOffset += size.height;
+    }
+    
+    layoutSection.headerHeight = headerHeight;
+    layoutSection.footerHeight = footerHeight;
+    layoutSection.itemFrames = itemFrames;
+    layoutSection.itemsHeight = itemOffset - headerHeight;
+    layoutSection.needsMeasure = NO;
+}
+
+#pragma mark - Layout Attributes
+
+- (CGSize)collectionViewContentSize
+{
+    // After a reload the content size may be asked for before the next layout pass.
+    if (self.needsFullRebuild) {
+        [self rebuildAllSections];
+    }
+    ATLConversationCollectionViewLayoutSection *lastSection = self.sections.lastObject;
+    return CGSizeMake(self.measuredWidth, lastSection ? lastSection.maxY : 0);
+}
+
+- (NSArray<UICollectionViewLayoutAttributes *> *)layoutAttributesForElementsInRect:(CGRect)rect
+{
+    NSMutableArray *layoutAttributes = [NSMutableArray new];
+    NSUInteger firstIndex = [self indexOfFirstSectionEndingAfterOffset:CGRectGetMinY(rect)];
+    if (firstIndex == NSNotFound) return layoutAttributes;
+    NSUInteger sectionCount = self.sections.count;
+    for (NSUInteger index = firstIndex; index < sectionCount; index++) {
+        ATLConversationCollectionViewLayoutSection *layoutSection = self.sections[index];
+        if (layoutSection.offset >= CGRectGetMaxY(rect)) break;
+        if (layoutSection.headerHeight > 0) {
+            UICollectionViewLayoutAttributes *attributes = [self headerAttributesForSection:layoutSection atIndex:index];
+            if (CGRectIntersectsRect(attributes.frame, rect)) [layoutAttributes addObject:attributes];
+        }
+        for (NSUInteger item = 0; item < layoutSection.itemFrames.count; item++) {
+            UICollectionViewLayoutAttributes *attributes = [self itemAttributesForSection:layoutSection atIndexPath:[NSIndexPath indexPathForItem:item inSection:index]];
+            if (CGRectIntersectsRect(attributes.frame, rect)) [layoutAttributes addObject:attributes];
+        }
+        if (layoutSection.footerHeight > 0) {
+            UICollectionViewLayoutAttributes *attributes = [self footerAttributesForSection:layoutSection atIndex:index];
+            if (CGRectIntersectsRect(attributes.frame, rect)) [layoutAttributes addObject:attributes];
+        }
+    }
+    return layoutAttributes;
+}
+
+- (UICollectionViewLayoutAttributes *)layoutAttributesForItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    if ((NSUInteger)indexPath.section >= self.sections.count) return nil;
+    ATLConversationCollectionViewLayoutSection *layoutSection = self.sections[indexPath.section];
+    if ((NSUInteger)indexPath.item >= layoutSection.itemFrames.count) return nil;
+    return [self itemAttributesForSection:layoutSection atIndexPath:indexPath];
+}
+
+- (UICollectionViewLayoutAttributes *)layoutAttributesForSupplementaryViewOfKind:(NSString *)elementKind atIndexPath:(NSIndexPath *)indexPath
+{
+    if ((NSUInteger)indexPath.section >= self.sections.count) return nil;
+    ATLConversationCollectionViewLayoutSection *layoutSection = self.sections[indexPath.section];
+    if ([elementKind isEqualToString:UICollectionElementKindSectionHeader]) {
+        return [self headerAttributesForSection:layoutSection atIndex:indexPath.section];
+    }
+    if ([elementKind isEqualToString:UICollectionElementKindSectionFooter]) {
+        return [self footerAttributesForSection:layoutSection atIndex:indexPath.section];
+    }
+    return nil;
+}
+
+- (UICollectionViewLayoutAttributes *)headerAttributesForSection:(ATLConversationCollectionViewLayoutSection *)layoutSection atIndex:(NSUInteger)index
+{
+    UICollectionViewLayoutAttributes *attributes = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:UICollectionElementKindSectionHeader withIndexPath:[NSIndexPath indexPathForItem:0 inSection:index]];
+    attributes.frame = CGRectMake(0, layoutSection.offset, self.measuredWidth, layoutSection.headerHeight);
+    return attributes;
+}
+
+- (UICollectionViewLayoutAttributes *)footerAttributesForSection:(ATLConversationCollectionViewLayoutSection *)layoutSection atIndex:(NSUInteger)index
+{
+    UICollectionViewLayoutAttributes *attributes = [UICollectionViewLayoutAttributes layoutAttributesForSupplementaryViewOfKind:UICollectionElementKindSectionFooter withIndexPath:[NSIndexPath indexPathForItem:0 inSection:index]];
+    attributes.frame = CGRectMake(0, layoutSection.maxY - layoutSection.footerHeight, self.measuredWidth, layoutSection.footerHeight);
+    return attributes;
+}
+
+- (UICollectionViewLayoutAttributes *)itemAttributesForSection:(ATLConversationCollectionViewLayoutSection *)layoutSection atIndexPath:(NSIndexPath *)indexPath
+{
+    UICollectionViewLayoutAttributes *attributes = [UICollectionViewLayoutAttributes layoutAttributesForCellWithIndexPath:indexPath];
+    attributes.frame = CGRectOffset([layoutSection.itemFrames[indexPath.item] CGRectValue], 0, layoutSection.offset);
+    return attributes;
+}
+
+#pragma mark - Offset Lookup
+
+- (NSUInteger)indexOfFirstSectionEndingAfterOffset:(CGFloat)offset
+{
+    NSUInteger lowerBound = 0;
+    NSUInteger upperBound = self.sections.count;
+    while (lowerBound < upperBound) {
+        NSUInteger middle = lowerBound + (upperBound - lowerBound) / 2;
+        if (self.sections[middle].maxY <= offset) {
+            lowerBound = middle + 1;
+        } else {
+            upperBound = middle;
+        }
+    }
+    return lowerBound < self.sections.count ? lowerBound : NSNotFound;
+}
+
+- (ATLConversationCollectionViewLayoutSection *)anchorSectionForOffset:(CGFloat)offset
+{
+    NSUInteger sectionCount = self.sections.count;
+    if (sectionCount == 0) return nil;
+    NSUInteger index = [self indexOfFirstSectionEndingAfterOffset:MAX(offset, 0)];
+    if (index == NSNotFound) index = sectionCount - 1;
+    // Sections without items, such as the more messages header, can't serve as an anchor since history gets inserted below them.
+    while (index + 1 < sectionCount && self.sections[index].itemFrames.count == 0) {
+        index++;
+    }
+    return self.sections[index];
+}
+
+@end
@@ -53,6 +53,13 @@ extern NSString *const ATLUserDidTapPhoneNumberNotification;
  */
 - (void)updateWithAttributedText:(NSAttributedString *)text;
 
+/**
+ @abstract Tells the bubble view to display a given string, along with the links and phone numbers already detected in it.
+ @discussion Taps are hit-tested against the given results, so the text isn't scanned again on every tap.
+ @param textCheckingResults The results of scanning the text for `textCheckingTypes`. Pass `nil` to scan the text when it is tapped.
+ */
+- (void)updateWithAttributedText:(NSAttributedString *)text textCheckingResults:(nullable NSArray <NSTextCheckingResult *> *)textCheckingResults;
+
 /**
  @abstract Tells the bubble view to display a given image.
  */
@@ -21,6 +21,7 @@
 #import "ATLMessageBubbleView.h"
 #import "ATLMessagingUtilities.h"
 #import "ATLPlayView.h"
+#import "ATLAnimatedImageView.h"
 
 CGFloat const ATLMessageBubbleLabelVerticalPadding = 8.0f;
 CGFloat const ATLMessageBubbleLabelHorizontalPadding = 13.0f;
@@ -50,6 +51,7 @@ typedef NS_ENUM(NSInteger, ATLBubbleViewContentType) {
 @property (nonatomic) UIPanGestureRecognizer *panGestureRecognizer;
 @property (nonatomic) UILongPressGestureRecognizer *longPressGestureRecognizer;
 @property (nonatomic) NSURL *tappedURL;
+@property (nonatomic) NSArray <NSTextCheckingResult *> *textCheckingResults;
 @property (nonatomic) NSLayoutConstraint *imageWidthConstraint;
 @property (nonatomic) MKMapSnapshotter *snapshotter;
 @property (nonatomic) ATLProgressView *progressView;
@@ -86,7 +88,7 @@ typedef NS_ENUM(NSInteger, ATLBubbleViewContentType) {
         
         _textCheckingTypes = NSTextCheckingTypeLink | NSTextCheckingTypePhoneNumber;
         
-        _bubbleImageView = [[UIImageView alloc] init];
+        _bubbleImageView = [[ATLAnimatedImageView alloc] init];
         _bubbleImageView.translatesAutoresizingMaskIntoConstraints = NO;
         _bubbleImageView.contentMode = UIViewContentModeScaleAspectFill;
         [self addSubview:_bubbleImageView];
@@ -138,14 +140,21 @@ typedef NS_ENUM(NSInteger, ATLBubbleViewContentType) {
 - (void)prepareForReuse
 {
     self.bubbleImageView.image = nil;
+    self.textCheckingResults = nil;
     [self applyImageWidthConstraint:NO];
     self.playView.hidden = YES;
     [self setBubbleViewContentType:ATLBubbleViewContentTypeText];
 }
 
 - (void)updateWithAttributedText:(NSAttributedString *)text
+{
+    [self updateWithAttributedText:text textCheckingResults:nil];
+}
+
+- (void)updateWithAttributedText:(NSAttributedString *)text textCheckingResults:(NSArray<NSTextCheckingResult *> *)textCheckingResults
 {
     self.bubbleViewLabel.attributedText = text;
+    self.textCheckingResults = textCheckingResults;
     [self applyImageWidthConstraint:NO];
     [self setBubbleViewContentType:ATLBubbleViewContentTypeText];
 }
@@ -416,7 +425,7 @@ typedef NS_ENUM(NSInteger, ATLBubbleViewContentType) {
     NSUInteger characterIndex = [layoutManager characterIndexForPoint:tapLocation
                                                       inTextContainer:textContainer
                              fractionOfDistanceBetweenInsertionPoints:NULL];
-    NSArray *results = ATLTextCheckingResultsForText(self.bubbleViewLabel.attributedText.string, self.textCheckingTypes);
+    NSArray *results = self.textCheckingResults ?: ATLTextCheckingResultsForText(self.bubbleViewLabel.attributedText.string, self.textCheckingTypes);
     for (NSTextCheckingResult *result in results) {
         if (NSLocationInRange(characterIndex, result.range)) {
             if (result.resultType == NSTextCheckingTypeLink && self.textCheckingTypes & NSTextCheckingTypeLink) {
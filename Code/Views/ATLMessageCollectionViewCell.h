@@ -69,5 +69,20 @@ extern NSString *const ATLVideoAccessibilityLabel;
  */
 + (CGFloat)cellHeightForMessage:(LYRMessage *)message inView:(UIView *)view;
 
+/**
+ @abstract Computes the layouts of messages on a background queue, so sizing their cells later on is a cache lookup.
+ @param messages The `LYRMessage` objects that will be displayed in cells of the receiving class.
+ @param view The view where the cells will be displayed.
+ @param completion Called on the main thread once all layouts are computed.
+ */
++ (void)prepareLayoutsForMessages:(NSArray <LYRMessage *> *)messages inView:(UIView *)view completion:(nullable void (^)(void))completion;
+
+/**
+ @abstract Tells the cell whether it is on screen, so the image it is decoding jumps ahead of the images of off screen cells.
+ @discussion `ATLConversationViewController` calls this as cells are displayed and end being displayed.
+ @param visible `YES` if the cell is on screen.
+ */
+- (void)updateImageLoadingPriorityForVisibility:(BOOL)visible;
+
 @end
 NS_ASSUME_NONNULL_END
@@ -21,6 +21,9 @@
 #import "ATLMessageCollectionViewCell.h"
 #import "ATLMessagingUtilities.h"
 #import "ATLUIImageHelper.h"
+#import "ATLImageCache.h"
+#import "ATLImagePipeline.h"
+#import "ATLMessageLayoutCache.h"
 #import "ATLIncomingMessageCollectionViewCell.h"
 #import "ATLOutgoingMessageCollectionViewCell.h"
 
@@ -30,17 +33,28 @@
 NSString *const ATLGIFAccessibilityLabel = @"Message: GIF";
 NSString *const ATLImageAccessibilityLabel = @"Message: Image";
 NSString *const ATLVideoAccessibilityLabel = @"Message: Video";
-static char const ATLMessageCollectionViewCellImageProcessingConcurrentQueue[] = "com.layer.Atlas.ATLMessageCollectionViewCell.imageProcessingConcurrentQueue";
 
 CGFloat const ATLMessageCellMinimumHeight = 10.0f;
 NSInteger const kATLSharedCellTag = 1000;
 
+static CGSize ATLPixelSizeForPointSize(CGSize pointSize, CGFloat scale)
+{
+    return CGSizeMake(ceil(pointSize.width * scale), ceil(pointSize.height * scale));
+}
+
+static CGFloat ATLMaximumGIFPixelSize(CGFloat scale)
+{
+    // A bubble never shows a GIF larger than the maximum cell size, so there's no point in decoding bigger frames.
+    return ceil(MAX(ATLMaxCellWidth(), ATLMaxCellHeight()) * scale);
+}
+
 @interface ATLMessageCollectionViewCell () <LYRProgressDelegate>
 
 @property (nonatomic) BOOL messageSentState;
 @property (nonatomic) LYRProgress *progress;
 @property (nonatomic) NSUInteger lastProgressFractionCompleted;
-@property (nonatomic) dispatch_queue_t imageProcessingConcurrentQueue;
+@property (nonatomic) ATLImageRequest *imageRequest;
+@property (nonatomic, getter=isDisplayed) BOOL displayed;
 
 @end
 
@@ -58,16 +72,6 @@ NSInteger const kATLSharedCellTag = 1000;
     return _sharedCell;
 }
 
-+ (NSCache *)sharedHeightCache
-{
-    static NSCache *sharedHeightCache;
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        sharedHeightCache = [NSCache new];
-    });
-    return sharedHeightCache;
-}
-
 - (id)initWithFrame:(CGRect)frame
 {
     self = [super initWithFrame:frame];
@@ -93,7 +97,6 @@ NSInteger const kATLSharedCellTag = 1000;
     _messageTextColor = [UIColor blackColor];
     _messageLinkTextColor = [UIColor whiteColor];
     _messageTextCheckingTypes = NSTextCheckingTypeLink | NSTextCheckingTypePhoneNumber;
-    _imageProcessingConcurrentQueue = dispatch_queue_create(ATLMessageCollectionViewCellImageProcessingConcurrentQueue, DISPATCH_QUEUE_CONCURRENT);
     [self.bubbleView updateProgressIndicatorWithProgress:0.0 visible:NO animated:NO];
 }
 
@@ -103,10 +106,32 @@ NSInteger const kATLSharedCellTag = 1000;
     // Remove self from any previously assigned LYRProgress instance.
     self.progress.delegate = nil;
     self.lastProgressFractionCompleted = 0;
+    // Drop the decode of the previous message, if it hasn't finished yet.
+    [self.imageRequest cancel];
+    self.imageRequest = nil;
+}
+
+- (void)updateImageLoadingPriorityForVisibility:(BOOL)visible
+{
+    self.displayed = visible;
+    self.imageRequest.priority = [self imageRequestPriority];
+}
+
+- (ATLImageRequestPriority)imageRequestPriority
+{
+    return self.isDisplayed ? ATLImageRequestPriorityHigh : ATLImageRequestPriorityNormal;
+}
+
+- (void)requestImageWithDecodeBlock:(UIImage *(^)(ATLImageRequest *request))decodeBlock completion:(void (^)(UIImage *image))completion
+{
+    [self.imageRequest cancel];
+    self.imageRequest = [[ATLImagePipeline sharedImagePipeline] requestImageWithPriority:[self imageRequestPriority] decodeBlock:decodeBlock completion:completion];
 }
 
 - (void)presentMessage:(LYRMessage *)message
 {
+    [self.imageRequest cancel];
+    self.imageRequest = nil;
     self.message = message;
     LYRMessagePart *messagePart = message.parts.firstObject;
     [self updateBubbleWidth:[[self class] cellSizeForMessage:self.message inView:nil].width];
@@ -130,7 +155,10 @@ NSInteger const kATLSharedCellTag = 1000;
 {
     LYRMessagePart *messagePart = self.message.parts.firstObject;
     NSString *text = [[NSString alloc] initWithData:messagePart.data encoding:NSUTF8StringEncoding];
-    [self.bubbleView updateWithAttributedText:[self attributedStringForText:text]];
+    // Links are detected on a background queue as messages arrive, see `prepareLayoutsForMessages:inView:completion:`.
+    // Looked up with the same font and types as sizing, so the cached layout is found instead of being measured again.
+    NSArray *textCheckingResults = [[self class] layoutForMessage:self.message inView:nil].textCheckingResults;
+    [self.bubbleView updateWithAttributedText:[self attributedStringForText:text textCheckingResults:textCheckingResults] textCheckingResults:textCheckingResults];
     [self.bubbleView updateProgressIndicatorWithProgress:0.0 visible:NO animated:NO];
     self.accessibilityLabel = [NSString stringWithFormat:@"Message: %@", text];
 }
@@ -150,56 +178,54 @@ NSInteger const kATLSharedCellTag = 1000;
         [self.bubbleView updateProgressIndicatorWithProgress:1.0 visible:NO animated:YES];
     }
     
-    __block UIImage *displayingImage;
-    __block LYRMessagePart *previewImagePart = ATLMessagePartForMIMEType(self.message, ATLMIMETypeImageJPEGPreview);
+    // Fall-back to programatically requesting for a content download of single message part messages (Android compatibillity).
+    if ([[self.message valueForKeyPath:@"parts.MIMEType"] isEqual:@[ATLMIMETypeImageJPEG]]) {
+        if (fullResImagePart && (fullResImagePart.transferStatus == LYRContentTransferReadyForDownload)) {
+            NSError *error;
+            LYRProgress *progress = [fullResImagePart downloadContent:&error];
+            if (!progress) {
+                NSLog(@"failed to request for a content download from the UI with error=%@", error);
+            }
+            [self.bubbleView updateProgressIndicatorWithProgress:0.0 visible:NO animated:NO];
+        } else if (fullResImagePart && (fullResImagePart.transferStatus == LYRContentTransferDownloading)) {
+            [self updateCellWithProgress:fullResImagePart.progress];
+        }
+    }
+    
+    LYRMessagePart *previewImagePart = ATLMessagePartForMIMEType(self.message, ATLMIMETypeImageJPEGPreview);
     if (!previewImagePart) {
         previewImagePart = fullResImagePart;  // If no preview image part found, resort to the full-resolution image.
     }
     
-    __weak typeof(self) weakSelf = self;
-    __block LYRMessage *previousMessage = weakSelf.message;
+    // Consult the decoded image cache before dispatching any decode work. The screen scale is read here, UIKit isn't available to the decode block.
+    CGFloat scale = [UIScreen mainScreen].scale;
+    CGSize requestedSize = [self constrainedImageSizeForMessage:self.message];
+    CGSize requestedPixelSize = ATLPixelSizeForPointSize(requestedSize, scale);
+    UIImage *cachedImage = [[ATLImageCache sharedImageCache] imageForMessagePart:previewImagePart pixelSize:requestedPixelSize];
+    if (cachedImage) {
+        [self.bubbleView updateWithImage:cachedImage width:CGSizeEqualToSize(requestedSize, CGSizeZero) ? cachedImage.size.width : requestedSize.width];
+        return;
+    }
     
-    dispatch_async(self.imageProcessingConcurrentQueue, ^{
-        
-        if (previewImagePart.fileURL) {
-            displayingImage = [UIImage imageWithContentsOfFile:previewImagePart.fileURL.path];
-        } else {
-            displayingImage = [UIImage imageWithData:previewImagePart.data];
-        }
-        
-        CGSize size = CGSizeZero;
-        LYRMessagePart *sizePart = ATLMessagePartForMIMEType(self.message, ATLMIMETypeImageSize);
-        if (sizePart) {
-            size = ATLImageSizeForJSONData(sizePart.data);
-            size = ATLConstrainImageSizeToCellSize(size);
-        }
+    __weak typeof(self) weakSelf = self;
+    __block CGSize size = requestedSize;
+    [self requestImageWithDecodeBlock:^UIImage *(ATLImageRequest *request) {
         if (CGSizeEqualToSize(size, CGSizeZero)) {
             size = ATLImageSizeForData(fullResImagePart.data); // Resort to image's size, if no dimensions metadata message parts found.
         }
         
-        // Fall-back to programatically requesting for a content download of single message part messages (Android compatibillity).
-        if ([[weakSelf.message valueForKeyPath:@"parts.MIMEType"] isEqual:@[ATLMIMETypeImageJPEG]]) {
-            if (fullResImagePart && (fullResImagePart.transferStatus == LYRContentTransferReadyForDownload)) {
-                NSError *error;
-                LYRProgress *progress = [fullResImagePart downloadContent:&error];
-                if (!progress) {
-                    NSLog(@"failed to request for a content download from the UI with error=%@", error);
-                }
-                [weakSelf.bubbleView updateProgressIndicatorWithProgress:0.0 visible:NO animated:NO];
-            } else if (fullResImagePart && (fullResImagePart.transferStatus == LYRContentTransferDownloading)) {
-                [self updateCellWithProgress:fullResImagePart.progress];
-            } else {
-                [weakSelf.bubbleView updateProgressIndicatorWithProgress:1.0 visible:NO animated:YES];
-            }
+        // Downsample straight to the bubble's pixel size and force-decode it off the main thread, and keep the result around.
+        UIImage *displayingImage;
+        if (previewImagePart.fileURL) {
+            displayingImage = ATLDecodedThumbnailWithContentsOfURL(previewImagePart.fileURL, ATLPixelSizeForPointSize(size, scale), scale);
+        } else {
+            displayingImage = ATLDecodedThumbnailWithData(previewImagePart.data, ATLPixelSizeForPointSize(size, scale), scale);
         }
-        
-        dispatch_async(dispatch_get_main_queue(), ^{
-            if (weakSelf.message != previousMessage) {
-                return;
-            }
-            [weakSelf.bubbleView updateWithImage:displayingImage width:size.width];
-        });
-    });
+        [[ATLImageCache sharedImageCache] setImage:displayingImage forMessagePart:previewImagePart pixelSize:requestedPixelSize];
+        return displayingImage;
+    } completion:^(UIImage *displayingImage) {
+        [weakSelf.bubbleView updateWithImage:displayingImage width:size.width];
+    }];
 }
 
 - (void)configureBubbleViewForVideoContent
@@ -211,21 +237,31 @@ NSInteger const kATLSharedCellTag = 1000;
         [self updateCellWithProgress:fullResVideoPart.progress];
     }
     
-    UIImage *displayingImage;
+    CGFloat scale = [UIScreen mainScreen].scale;
+    CGSize size = [self constrainedImageSizeForMessage:self.message];
+    CGSize pixelSize = ATLPixelSizeForPointSize(size, scale);
     LYRMessagePart *previewImagePart = ATLMessagePartForMIMEType(self.message, ATLMIMETypeImageJPEGPreview);
-    if (previewImagePart.fileURL) {
-        displayingImage = [UIImage imageWithContentsOfFile:previewImagePart.fileURL.path];
-    } else {
-        displayingImage = [UIImage imageWithData:previewImagePart.data];
+    UIImage *cachedImage = [[ATLImageCache sharedImageCache] imageForMessagePart:previewImagePart pixelSize:pixelSize];
+    if (cachedImage || !previewImagePart) {
+        [self.bubbleView updateWithVideoThumbnail:cachedImage width:size.width];
+        return;
     }
     
-    CGSize size = CGSizeZero;
-    LYRMessagePart *sizePart = ATLMessagePartForMIMEType(self.message, ATLMIMETypeImageSize);
-    if (sizePart) {
-        CGSize fullSize = ATLImageSizeForJSONData(sizePart.data);
-        size = ATLConstrainImageSizeToCellSize(fullSize);
-    }
-    [self.bubbleView updateWithVideoThumbnail:displayingImage width:size.width];
+    // Show the play button right away, the thumbnail follows once it's decoded.
+    [self.bubbleView updateWithVideoThumbnail:nil width:size.width];
+    __weak typeof(self) weakSelf = self;
+    [self requestImageWithDecodeBlock:^UIImage *(ATLImageRequest *request) {
+        UIImage *displayingImage;
+        if (previewImagePart.fileURL) {
+            displayingImage = ATLDecodedThumbnailWithContentsOfURL(previewImagePart.fileURL, pixelSize, scale);
+        } else {
+            displayingImage = ATLDecodedThumbnailWithData(previewImagePart.data, pixelSize, scale);
+        }
+        [[ATLImageCache sharedImageCache] setImage:displayingImage forMessagePart:previewImagePart pixelSize:pixelSize];
+        return displayingImage;
+    } completion:^(UIImage *displayingImage) {
+        [weakSelf.bubbleView updateWithVideoThumbnail:displayingImage width:size.width];
+    }];
 }
 
 - (void)configureBubbleViewForGIFContent
@@ -246,65 +282,62 @@ NSInteger const kATLSharedCellTag = 1000;
         [self.bubbleView updateProgressIndicatorWithProgress:1.0 visible:NO animated:YES];
     }
     
-    __block UIImage *displayingImage;
     LYRMessagePart *previewImagePart = ATLMessagePartForMIMEType(self.message, ATLMIMETypeImageGIFPreview);
     
     if (!previewImagePart) {
         // If no preview image part found, resort to the full-resolution image.
         previewImagePart = fullResImagePart;
     }
+    
+    __block CGSize size = CGSizeZero;
+    LYRMessagePart *sizePart = ATLMessagePartForMIMEType(self.message, ATLMIMETypeImageSize);
+    if (sizePart) {
+        size = ATLImageSizeForJSONData(sizePart.data);
+        size = ATLConstrainImageSizeToCellSize(size);
+    }
+    CGFloat scale = [UIScreen mainScreen].scale;
+    CGFloat maximumPixelSize = ATLMaximumGIFPixelSize(scale);
     __weak typeof(self) weakSelf = self;
-    __block LYRMessage *previousMessage = weakSelf.message;
-
-    dispatch_async(self.imageProcessingConcurrentQueue, ^{
-        if (previewImagePart.fileURL) {
-            displayingImage = ATLAnimatedImageWithAnimatedGIFURL(previewImagePart.fileURL);
-        } else if (previewImagePart.data) {
-            displayingImage = ATLAnimatedImageWithAnimatedGIFData(previewImagePart.data);
-        }
-        
-        CGSize size = CGSizeZero;
-        LYRMessagePart *sizePart = ATLMessagePartForMIMEType(weakSelf.message, ATLMIMETypeImageSize);
-        if (sizePart) {
-            size = ATLImageSizeForJSONData(sizePart.data);
-            size = ATLConstrainImageSizeToCellSize(size);
-        }
+    [self requestImageWithDecodeBlock:^UIImage *(ATLImageRequest *request) {
         if (CGSizeEqualToSize(size, CGSizeZero)) {
             // Resort to image's size, if no dimensions metadata message parts found.
             size = ATLImageSizeForData(fullResImagePart.data);
         }
-        
-        dispatch_async(dispatch_get_main_queue(), ^{
-            // For GIFs we only download full resolution parts when rendered in the UI
-            // Low res GIFs are autodownloaded but blurry
-            if ([fullResImagePart.MIMEType isEqualToString:ATLMIMETypeImageGIF]) {
-                if (fullResImagePart.transferStatus == LYRContentTransferReadyForDownload) {
-                    NSError *error;
-                    LYRProgress *progress = [fullResImagePart downloadContent:&error];
-                    if (!progress) {
-                        NSLog(@"failed to request for a content download from the UI with error=%@", error);
-                    }
-                    [weakSelf.bubbleView updateProgressIndicatorWithProgress:0.0 visible:NO animated:NO];
-                    [weakSelf.bubbleView updateWithImage:displayingImage width:size.width];
-                } else if (fullResImagePart.transferStatus == LYRContentTransferDownloading) {
-                    LYRProgress *progress = fullResImagePart.progress;
-                    [progress setDelegate:weakSelf];
-                    weakSelf.progress = progress;
-                    [weakSelf.bubbleView updateProgressIndicatorWithProgress:progress.fractionCompleted visible:YES animated:NO];
-                    [weakSelf.bubbleView updateWithImage:displayingImage width:size.width];
-                } else {
-                    displayingImage = ATLAnimatedImageWithAnimatedGIFData(fullResImagePart.data);
-                    dispatch_async(dispatch_get_main_queue(), ^{
-                        if (weakSelf.message != previousMessage) {
-                            return;
-                        }
-                        [weakSelf.bubbleView updateProgressIndicatorWithProgress:1.0 visible:NO animated:YES];
-                        [weakSelf.bubbleView updateWithImage:displayingImage width:size.width];
-                    });
-                }
+        if (previewImagePart.fileURL) {
+            return ATLAnimatedImageWithAnimatedGIFURL(previewImagePart.fileURL, maximumPixelSize, scale);
+        } else if (previewImagePart.data) {
+            return ATLAnimatedImageWithAnimatedGIFData(previewImagePart.data, maximumPixelSize, scale);
+        }
+        return nil;
+    } completion:^(UIImage *displayingImage) {
+        // For GIFs we only download full resolution parts when rendered in the UI
+        // Low res GIFs are autodownloaded but blurry
+        if (![fullResImagePart.MIMEType isEqualToString:ATLMIMETypeImageGIF]) {
+            return;
+        }
+        if (fullResImagePart.transferStatus == LYRContentTransferReadyForDownload) {
+            NSError *error;
+            LYRProgress *progress = [fullResImagePart downloadContent:&error];
+            if (!progress) {
+                NSLog(@"failed to request for a content download from the UI with error=%@", error);
             }
-        });
-    });
+            [weakSelf.bubbleView updateProgressIndicatorWithProgress:0.0 visible:NO animated:NO];
+            [weakSelf.bubbleView updateWithImage:displayingImage width:size.width];
+        } else if (fullResImagePart.transferStatus == LYRContentTransferDownloading) {
+            LYRProgress *progress = fullResImagePart.progress;
+            [progress setDelegate:weakSelf];
+            weakSelf.progress = progress;
+            [weakSelf.bubbleView updateProgressIndicatorWithProgress:progress.fractionCompleted visible:YES animated:NO];
+            [weakSelf.bubbleView updateWithImage:displayingImage width:size.width];
+        } else {
+            [weakSelf requestImageWithDecodeBlock:^UIImage *(ATLImageRequest *request) {
+                return ATLAnimatedImageWithAnimatedGIFData(fullResImagePart.data, maximumPixelSize, scale);
+            } completion:^(UIImage *fullResImage) {
+                [weakSelf.bubbleView updateProgressIndicatorWithProgress:1.0 visible:NO animated:YES];
+                [weakSelf.bubbleView updateWithImage:fullResImage width:size.width];
+            }];
+        }
+    }];
 }
 
 - (void)configureBubbleViewForLocationContent
@@ -372,12 +405,23 @@ NSInteger const kATLSharedCellTag = 1000;
 
 #pragma mark - Helpers
 
-- (NSAttributedString *)attributedStringForText:(NSString *)text
+/**
+ @abstract Returns the bubble size from the message's image dimensions metadata part, or `CGSizeZero` if the message doesn't have one.
+ */
+- (CGSize)constrainedImageSizeForMessage:(LYRMessage *)message
+{
+    LYRMessagePart *sizePart = ATLMessagePartForMIMEType(message, ATLMIMETypeImageSize);
+    if (!sizePart) {
+        return CGSizeZero;
+    }
+    return ATLConstrainImageSizeToCellSize(ATLImageSizeForJSONData(sizePart.data));
+}
+
+- (NSAttributedString *)attributedStringForText:(NSString *)text textCheckingResults:(NSArray *)textCheckingResults
 {
     NSDictionary *attributes = @{NSFontAttributeName : self.messageTextFont, NSForegroundColorAttributeName : self.messageTextColor};
     NSMutableAttributedString *attributedString = [[NSMutableAttributedString alloc] initWithString:text attributes:attributes];
-    NSArray *linkResults = ATLTextCheckingResultsForText(text, self.messageTextCheckingTypes);
-    for (NSTextCheckingResult *result in linkResults) {
+    for (NSTextCheckingResult *result in textCheckingResults) {
         NSDictionary *linkAttributes = @{NSForegroundColorAttributeName : self.messageLinkTextColor,
                                          NSUnderlineStyleAttributeName : @(NSUnderlineStyleSingle)};
         [attributedString addAttributes:linkAttributes range:result.range];
@@ -405,16 +449,14 @@ NSInteger const kATLSharedCellTag = 1000;
 
 + (CGSize)cellSizeForMessage:(LYRMessage *)message inView:(UIView *)view
 {
-    if ([[self sharedHeightCache] objectForKey:message.identifier]) {
-        return [[[self sharedHeightCache] objectForKey:message.identifier] CGSizeValue];
-    }
-    
     LYRMessagePart *part = message.parts.firstObject;
     CGSize size = CGSizeZero;
     if ([part.MIMEType isEqualToString:ATLMIMETypeTextPlain]) {
-        size = [[self class] cellSizeForTextMessage:message inView:view];
+        size = [[self layoutForMessage:message inView:view] size];
+        size.width += ATLMessageBubbleLabelHorizontalPadding * 2 + ATLMessageBubbleLabelWidthMargin;
+        size.height += ATLMessageBubbleLabelVerticalPadding * 2;
     } else if ([part.MIMEType isEqualToString:ATLMIMETypeImageJPEG] || [part.MIMEType isEqualToString:ATLMIMETypeImagePNG] || [part.MIMEType isEqualToString:ATLMIMETypeImageGIF]|| [part.MIMEType isEqualToString:ATLMIMETypeVideoMP4]) {
-        size = [[self class] cellSizeForImageMessage:message];
+        size = [[self layoutForMessage:message inView:view] size];
     } else if ([part.MIMEType isEqualToString:ATLMIMETypeLocation]) {
         size.width = ATLMessageBubbleMapWidth;
         size.height = ATLMessageBubbleMapHeight;
@@ -422,56 +464,36 @@ NSInteger const kATLSharedCellTag = 1000;
     return size;
 }
 
-+ (CGSize)cellSizeForTextMessage:(LYRMessage *)message inView:(id)view
++ (ATLMessageLayout *)layoutForMessage:(LYRMessage *)message inView:(UIView *)view
+{
+    ATLMessageCollectionViewCell *cell = [self sharedCellInView:view];
+    return [[ATLMessageLayoutCache sharedLayoutCache] layoutForMessage:message contentWidth:ATLMaxCellWidth() font:[self messageTextFontForSharedCell:cell] textCheckingTypes:cell.messageTextCheckingTypes];
+}
+
++ (void)prepareLayoutsForMessages:(NSArray <LYRMessage *> *)messages inView:(UIView *)view completion:(void (^)(void))completion
+{
+    // UIAppearance can only be resolved on the main thread, the layout itself happens in the background.
+    ATLMessageCollectionViewCell *cell = [self sharedCellInView:view];
+    [[ATLMessageLayoutCache sharedLayoutCache] prepareLayoutsForMessages:messages contentWidth:ATLMaxCellWidth() font:[self messageTextFontForSharedCell:cell] textCheckingTypes:cell.messageTextCheckingTypes completion:completion];
+}
+
++ (ATLMessageCollectionViewCell *)sharedCellInView:(UIView *)view
 {
     //  Adding  the view to the hierarchy so that UIAppearance property values will be set based on containment.
     ATLMessageCollectionViewCell *cell = [self sharedCell];
-    if (![view viewWithTag:kATLSharedCellTag]) {
+    if (view && ![view viewWithTag:kATLSharedCellTag]) {
         [view addSubview:cell];
     }
-    
-    LYRMessagePart *part = message.parts.firstObject;
-    NSString *text = [[NSString alloc] initWithData:part.data encoding:NSUTF8StringEncoding];
-    UIFont *font = [[[self class] appearance] messageTextFont];
-    if (!font) {
-        font = cell.messageTextFont;
-    }
-    CGSize size = ATLTextPlainSize(text, font);
-    size.width += ATLMessageBubbleLabelHorizontalPadding * 2 + ATLMessageBubbleLabelWidthMargin;
-    size.height += ATLMessageBubbleLabelVerticalPadding * 2;
-    if (![[self sharedHeightCache] objectForKey:message.identifier]) {
-        [[self sharedHeightCache] setObject:[NSValue valueWithCGSize:size] forKey:message.identifier];
-    }
-    return size;
+    return cell;
 }
 
-+ (CGSize)cellSizeForImageMessage:(LYRMessage *)message
++ (UIFont *)messageTextFontForSharedCell:(ATLMessageCollectionViewCell *)cell
 {
-    CGSize size = CGSizeZero;
-    LYRMessagePart *sizePart = ATLMessagePartForMIMEType(message, ATLMIMETypeImageSize);
-    if (sizePart) {
-        size = ATLImageSizeForJSONData(sizePart.data);
-        size = ATLConstrainImageSizeToCellSize(size);
-        return size;
-    }
-    if (CGSizeEqualToSize(size, CGSizeZero)) {
-        LYRMessagePart *imagePart = ATLMessagePartForMIMEType(message, ATLMIMETypeImageJPEGPreview);
-        if (!imagePart) {
-            // If no preview image part found, resort to the full-resolution image.
-            imagePart = ATLMessagePartForMIMEType(message, ATLMIMETypeImageJPEG);
-        }
-        // Resort to image's size, if no dimensions metadata message parts found.
-        if ((imagePart.transferStatus == LYRContentTransferComplete) ||
-            (imagePart.transferStatus == LYRContentTransferAwaitingUpload) ||
-            (imagePart.transferStatus == LYRContentTransferUploading)) {
-            size = ATLImageSizeForData(imagePart.data);
-        } else {
-            // We don't have the image data yet, making cell think there's
-            // an image with 3:4 aspect ration (portrait photo).
-            size = ATLConstrainImageSizeToCellSize(CGSizeMake(3000, 4000));
-        }
+    UIFont *font = [[[self class] appearance] messageTextFont];
+    if (!font) {
+        font = cell.messageTextFont;
     }
-    return size;
+    return font;
 }
 
 @end